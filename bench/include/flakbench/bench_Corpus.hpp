@@ -0,0 +1,140 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [bench_Corpus.hpp - bench_Corpus.cpp]
+//
+// Description: Writes a synthetic asset tree for the benchmarks. The tree
+//              mixes the kinds of files a game ships: many tiny text configs,
+//              mid-size textures, media that does not compress and a few
+//              huge files. The same seed and scale give the same bytes on
+//              every platform.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <filesystem> - C++ Standard Library
+//  - <string>     - C++ Standard Library
+//  - <vector>     - C++ Standard Library
+//  - <cstdint>    - C++ Standard Library
+//
+// Notes:
+//  - Every group lives in its own top level directory (configs, textures,
+//    media, huge), the group statistics are read back from there.
+//  - A stamp file next to the corpus directory records the seed and scale,
+//    an existing corpus is reused when they match.
+//  - Media files use extensions of compressed formats (.ogg, .png, .mp4) so
+//    the packer stores them, huge files alternate texture-like and random
+//    1 MiB blocks.
+//
+// ===========================================================================
+#ifndef FLAK_BENCH_CORPUS_HPP
+#define FLAK_BENCH_CORPUS_HPP
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+namespace flakpak::bench {
+	// Shape of the generated corpus, counts and sizes are multiplied by scale
+	struct BENCH_CORPUS_SPEC {
+		uint64_t seed { 0x464C4B42454E4348 };		// Seed of every generated byte
+		double scale { 1.0 };						// Multiplies the file counts and the huge file size
+		size_t tinyCount { 2000 };					// Text configs...
+		uint64_t tinyMinSize { 128 };				// ...between these sizes
+		uint64_t tinyMaxSize { 4 << 10 };
+		size_t textureCount { 64 };					// Compressible binary textures...
+		uint64_t textureMinSize { 256 << 10 };
+		uint64_t textureMaxSize { 4 << 20 };
+		size_t mediaCount { 32 };					// Incompressible audio/image/video...
+		uint64_t mediaMinSize { 1 << 20 };
+		uint64_t mediaMaxSize { 8 << 20 };
+		size_t hugeCount { 2 };						// Files above the streaming threshold (64 MiB)
+		uint64_t hugeSize { 96ULL << 20 };
+
+	}; // BENCH_CORPUS_SPEC
+
+	// Files and bytes of one corpus group
+	struct BENCH_CORPUS_GROUP {
+		std::string name;
+		size_t fileCount { 0 };
+		uint64_t byteCount { 0 };
+
+	}; // BENCH_CORPUS_GROUP
+
+	class CorpusGenerator {
+	public:
+		CorpusGenerator() = default;
+		~CorpusGenerator() = default;
+
+		// Writes the corpus into in_dir, or reuses it if it was generated with the same spec
+		//    @param in_dir			 - Corpus directory, created if missing
+		//	  @param in_spec			 - Seed, scale and group shapes
+		//	  @param out_groups		 - Statistics of every group, in generation order
+		//
+		//	  @return bool			 - false if a file could not be written
+		static bool Generate(const std::filesystem::path& in_dir, const BENCH_CORPUS_SPEC& in_spec, std::vector<BENCH_CORPUS_GROUP>& out_groups);
+
+		// Files and bytes of every group of an existing corpus
+		static std::vector<BENCH_CORPUS_GROUP> Describe(const std::filesystem::path& in_dir);
+
+		// In-memory sample made like the corpus files, for codec measurements
+		//    @param in_seed			 - Seed of the sample
+		//	  @param in_size			 - Size of the sample in bytes
+		//	  @param in_compressible	 - Texture-like bytes if true, random bytes otherwise
+		//	  @param out_data		 - Receives the sample
+		static void FillSample(uint64_t in_seed, uint64_t in_size, bool in_compressible, std::vector<uint8_t>& out_data);
+
+	private:
+		// Deterministic generator, std distributions differ between standard libraries
+		class Random {
+		public:
+			explicit Random(uint64_t in_seed) : m_state(in_seed) {}
+
+			uint64_t Next();
+			// Uniform value in [in_min, in_max]
+			uint64_t Range(uint64_t in_min, uint64_t in_max);
+
+		private:
+			uint64_t m_state;
+
+		}; // class Random
+
+		static bool WriteFile(const std::filesystem::path& in_path, const std::vector<uint8_t>& in_data);
+		static std::string GetStamp(const BENCH_CORPUS_SPEC& in_spec);
+
+		static void FillConfig(Random& io_random, uint64_t in_size, std::vector<uint8_t>& out_data);
+		static void FillTexture(Random& io_random, uint64_t in_size, std::vector<uint8_t>& out_data);
+		static void FillNoise(Random& io_random, uint64_t in_size, std::vector<uint8_t>& out_data);
+
+	}; // class CorpusGenerator
+
+} // namespace flakpak::bench
+
+#endif // !FLAK_BENCH_CORPUS_HPP
@@ -0,0 +1,78 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [bench_Modes.hpp - bench_Modes.cpp]
+//
+// Description: Packing modes timed by the benchmarks, one per FLKPacker
+//              Pack* function, with the FLK_PACK_OPTIONS they pack with.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKPacker.hpp>	- Packing options
+//
+//  - <string>     - C++ Standard Library
+//  - <vector>     - C++ Standard Library
+//
+// Notes:
+//  - The Pack* functions write version 1 archives, capped at 256 entries.
+//    The modes use the same options on version 2 and are packed through
+//    FLKPacker::PackDirectory, so the corpus size is not limited.
+//
+// ===========================================================================
+#ifndef FLAK_BENCH_MODES_HPP
+#define FLAK_BENCH_MODES_HPP
+
+#include <flakpak/flak_FLKPacker.hpp>
+
+#include <string>
+#include <vector>
+
+
+namespace flakpak::bench {
+	// One of the FLKPacker packing modes, at one compression level
+	struct BENCH_PACK_MODE {
+		std::string name;						// Name of the matching FLKPacker::Pack* function
+		int level { 0 };						// Compression level, 0 for the uncompressed modes
+		bool compress { false };
+		bool encrypt { false };
+		FLK_PACK_OPTIONS options;				// Options given to FLKPacker::PackDirectory
+
+	}; // BENCH_PACK_MODE
+
+	// Modes selected by name, compressed modes are listed once per level
+	//    @param in_selected		 - plain, compressed, encrypted and/or compressed-encrypted (empty = all)
+	//	  @param in_levels		 - zstd levels of the compressed modes
+	//	  @param in_jobCount		 - Worker threads of the packer (0 = all cores)
+	//
+	//	  @return std::vector	 - Modes in the order they are run
+	std::vector<BENCH_PACK_MODE> BuildPackModes(const std::vector<std::string>& in_selected, const std::vector<int>& in_levels, size_t in_jobCount);
+
+} // namespace flakpak::bench
+
+#endif // !FLAK_BENCH_MODES_HPP
@@ -0,0 +1,130 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [bench_Report.hpp - bench_Report.cpp]
+//
+// Description: Helpers shared by the benchmarks. JsonWriter builds the
+//              result document and RunIsolated() measures one run of a
+//              workload: wall time, CPU time and peak resident set size.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakbench/bench_Corpus.hpp>	- Corpus description
+//
+//  - <functional> - C++ Standard Library
+//  - <string>     - C++ Standard Library
+//  - <vector>     - C++ Standard Library
+//  - <cstdint>    - C++ Standard Library
+//
+//  - <sys/resource.h>, <sys/wait.h> - POSIX process accounting (fork/wait4)
+//  - <psapi.h>                      - Windows process memory counters
+//
+// Notes:
+//  - On POSIX systems every run is forked, the peak RSS of the child is the
+//    peak of that run alone. Windows runs in process, the peak is the one of
+//    the whole benchmark so far (BENCH_RUN::isolated is false).
+//  - The standard output of the workload is discarded (the packer prints
+//    every file), the benchmark reports on the standard error.
+//
+// ===========================================================================
+#ifndef FLAK_BENCH_REPORT_HPP
+#define FLAK_BENCH_REPORT_HPP
+
+#include <flakbench/bench_Corpus.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+namespace flakpak::bench {
+	// Measurements of one run of a workload
+	struct BENCH_RUN {
+		bool success { false };
+		double seconds { 0.0 };			// Wall time of the workload
+		double cpuSeconds { 0.0 };		// User + system time of the workload (0 when not isolated)
+		uint64_t peakRssKiB { 0 };		// Peak resident set size
+		bool isolated { false };		// Measured in a child process of its own
+
+	}; // BENCH_RUN
+
+	// Minimal streaming JSON writer, commas and indentation are handled here
+	class JsonWriter final {
+	public:
+		JsonWriter() = default;
+		~JsonWriter() = default;
+
+		JsonWriter& BeginObject(const char* in_key = nullptr);
+		JsonWriter& EndObject();
+		JsonWriter& BeginArray(const char* in_key = nullptr);
+		JsonWriter& EndArray();
+
+		JsonWriter& Value(const char* in_key, const std::string& in_value);
+		JsonWriter& Value(const char* in_key, const char* in_value);
+		JsonWriter& Value(const char* in_key, double in_value);
+		JsonWriter& Value(const char* in_key, uint64_t in_value);
+		JsonWriter& Value(const char* in_key, int64_t in_value);
+		JsonWriter& Value(const char* in_key, int in_value);
+		JsonWriter& Value(const char* in_key, bool in_value);
+
+		[[nodiscard]] const std::string& GetText() const;
+
+	private:
+		// Writes the separator, the indentation and the key (inside objects)
+		void BeginValue(const char* in_key);
+		static std::string Escape(const std::string& in_text);
+
+		std::string m_text;
+		std::vector<bool> m_hasItems;		// One level per open object or array
+
+	}; // class JsonWriter final
+
+	// Runs in_workload and measures it
+	//    @param in_workload		 - Returns false when the run failed
+	//
+	//	  @return BENCH_RUN		 - Measurements, success is false if the workload failed or crashed
+	BENCH_RUN RunIsolated(const std::function<bool()>& in_workload);
+
+	// Host, compiler and library versions, written at the start of every report
+	void WriteEnvironment(JsonWriter& io_writer);
+	// Seed, scale and group statistics of the corpus the benchmark ran on
+	void WriteCorpus(JsonWriter& io_writer, const BENCH_CORPUS_SPEC& in_spec, const std::vector<BENCH_CORPUS_GROUP>& in_groups);
+
+	// Writes the report to in_path, or to the standard output if in_path is empty
+	bool SaveReport(const JsonWriter& in_writer, const std::string& in_path);
+
+	// Median of a list of samples (0 if empty), in_samples is reordered
+	double Median(std::vector<double>& io_samples);
+	// Value below which in_percentile percent of the samples fall (0 if empty), in_samples is reordered
+	double Percentile(std::vector<double>& io_samples, double in_percentile);
+
+} // namespace flakpak::bench
+
+#endif // !FLAK_BENCH_REPORT_HPP
@@ -0,0 +1,160 @@
+#include <flakpak/flak_FLKPacker.hpp>
+
+#include <flakbench/bench_Corpus.hpp>
+#include <flakbench/bench_Modes.hpp>
+#include <flakbench/bench_Report.hpp>
+
+#include <CLI11/CLI11.hpp>
+
+// STD C++ Libraries
+#include <iostream>
+#include <filesystem>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+
+namespace fs = std::filesystem;
+namespace bench = flakpak::bench;
+
+int main(int argc, char* argv[]) {
+    CLI::App app{ "flakpak pack benchmark" };
+
+    fs::path workDir = "flakbench";
+    std::string reportPath;
+    bench::BENCH_CORPUS_SPEC spec;
+    std::vector<std::string> selectedModes;
+    std::vector<int> levels = { 1, 3, 9, 19 };
+    size_t jobCount = 0;
+    size_t repeatCount = 3;
+    bool keepArchives = false;
+
+    app.add_option("-w,--work-dir", workDir,
+        "Directory holding the generated corpus and the archives")->default_val(workDir.string());
+
+    app.add_option("-o,--output", reportPath,
+        "Write the JSON report to this file (default: standard output)");
+
+    app.add_option("--scale", spec.scale,
+        "Multiplies the number of files and the size of the huge files of the corpus")
+        ->default_val(spec.scale)->check(CLI::Range(0.001, 100.0));
+
+    app.add_option("--seed", spec.seed,
+        "Seed of the corpus, the same seed and scale always give the same files")->default_val(spec.seed);
+
+    app.add_option("-m,--mode", selectedModes,
+        "Modes to run (plain, compressed, encrypted, compressed-encrypted), can be repeated (default: all)")
+        ->check(CLI::IsMember({ "plain", "compressed", "encrypted", "compressed-encrypted" }));
+
+    app.add_option("-l,--levels", levels,
+        "zstd levels of the compressed modes")->check(CLI::Range(1, 22));
+
+    app.add_option("-j,--jobs", jobCount,
+        "Worker threads of the packer (0 = all cores)")->default_val(jobCount);
+
+    app.add_option("-r,--repeat", repeatCount,
+        "Runs per mode, the median time is reported")->default_val(repeatCount)->check(CLI::Range(1, 100));
+
+    app.add_flag("--keep-archives", keepArchives,
+        "Keep the last archive of every mode in the work directory");
+
+    CLI11_PARSE(app, argc, argv);
+
+    std::error_code ec;
+    fs::create_directories(workDir, ec);
+
+    fs::path corpusDir = workDir / "corpus";
+    std::cerr << "Generating corpus in " << corpusDir.string() << "\n";
+    std::vector<bench::BENCH_CORPUS_GROUP> groups;
+    if (!bench::CorpusGenerator::Generate(corpusDir, spec, groups)) {
+        std::cerr << "Corpus generation failed!\n";
+        return 1;
+    }
+
+    size_t corpusFiles = 0;
+    uint64_t corpusBytes = 0;
+    for (const auto& group : groups) {
+        corpusFiles += group.fileCount;
+        corpusBytes += group.byteCount;
+    }
+
+    bench::JsonWriter report;
+    report.BeginObject().Value("benchmark", "pack");
+    bench::WriteEnvironment(report);
+    bench::WriteCorpus(report, spec, groups);
+
+    report.Value("jobs", static_cast<uint64_t>(jobCount))
+        .Value("repeat", static_cast<uint64_t>(repeatCount))
+        .BeginArray("results");
+
+    bool allSucceeded = true;
+    for (const bench::BENCH_PACK_MODE& mode : bench::BuildPackModes(selectedModes, levels, jobCount)) {
+        std::string archiveName = mode.name + (mode.compress ? "_l" + std::to_string(mode.level) : "") + ".flk";
+        fs::path archivePath = workDir / archiveName;
+
+        std::vector<double> seconds;
+        std::vector<double> cpuSeconds;
+        uint64_t peakRssKiB = 0;
+        uint64_t archiveBytes = 0;
+        bool success = true;
+        bool isolated = true;
+        for (size_t run = 0; run < repeatCount && success; run++) {
+            bench::BENCH_RUN result = bench::RunIsolated([&]() {
+                return flakpak::FLKPacker::PackDirectory(corpusDir, archivePath, mode.options);
+            });
+
+            success = result.success;
+            isolated = result.isolated;
+            seconds.push_back(result.seconds);
+            cpuSeconds.push_back(result.cpuSeconds);
+            peakRssKiB = std::max(peakRssKiB, result.peakRssKiB);
+            archiveBytes = fs::file_size(archivePath, ec);
+        }
+        if (!keepArchives) {
+            fs::remove(archivePath, ec);
+        }
+
+        double medianSeconds = bench::Median(seconds);
+        double bestSeconds = *std::min_element(seconds.begin(), seconds.end());
+        double megabytesPerSecond = medianSeconds > 0.0 ? corpusBytes / 1e6 / medianSeconds : 0.0;
+        double filesPerSecond = medianSeconds > 0.0 ? corpusFiles / medianSeconds : 0.0;
+        allSucceeded = allSucceeded && success;
+
+        std::cerr << mode.name;
+        if (mode.compress) {
+            std::cerr << " level " << mode.level;
+        }
+        if (success) {
+            std::cerr << ": " << megabytesPerSecond << " MB/s, " << filesPerSecond << " files/s, "
+                << (peakRssKiB >> 10) << " MiB peak RSS\n";
+        }
+        else {
+            std::cerr << ": FAILED\n";
+        }
+
+        report.BeginObject()
+            .Value("mode", mode.name)
+            .Value("level", mode.level)
+            .Value("compress", mode.compress)
+            .Value("encrypt", mode.encrypt)
+            .Value("success", success)
+            .Value("seconds", medianSeconds)
+            .Value("bestSeconds", bestSeconds)
+            .Value("cpuSeconds", bench::Median(cpuSeconds))
+            .Value("inputBytes", corpusBytes)
+            .Value("archiveBytes", archiveBytes)
+            .Value("ratio", corpusBytes > 0 ? static_cast<double>(archiveBytes) / corpusBytes : 0.0)
+            .Value("mbPerSecond", megabytesPerSecond)
+            .Value("filesPerSecond", filesPerSecond)
+            .Value("peakRssKiB", peakRssKiB)
+            .Value("rssIsolated", isolated)
+            .EndObject();
+    }
+
+    report.EndArray().EndObject();
+    if (!bench::SaveReport(report, reportPath)) {
+        return 1;
+    }
+
+    return allSucceeded ? 0 : 1;
+}
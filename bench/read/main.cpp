@@ -0,0 +1,706 @@
+#include <flakpak/flak_FLKPacker.hpp>
+#include <flakpak/flak_FLKReader.hpp>
+#include <flakpak/flak_PasswordHandler.hpp>
+#include <flakpak/flak_PathCompressor.hpp>
+#include <flakpak/zstd_Compressor.hpp>
+#include <flakpak/xccp20_Encryptor.hpp>
+#include <flakpak/xccp20_KeySession.hpp>
+
+#include <flakbench/bench_Corpus.hpp>
+#include <flakbench/bench_Modes.hpp>
+#include <flakbench/bench_Report.hpp>
+
+#include <CLI11/CLI11.hpp>
+
+// STD C++ Libraries
+#include <iostream>
+#include <filesystem>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <span>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+namespace fs = std::filesystem;
+namespace bench = flakpak::bench;
+namespace io = flakpak::io;
+using Clock = std::chrono::steady_clock;
+
+#ifdef _WIN32
+static constexpr bool COLD_CACHE_SUPPORTED = false;
+#else
+static constexpr bool COLD_CACHE_SUPPORTED = true;
+#endif
+
+static constexpr size_t STREAM_WINDOW_SIZE = 1 << 20;    // Staging buffer of the concurrent readers
+
+// Entries are grouped by size, latencies are reported per group
+struct SizeClass {
+    const char* name;
+    uint64_t maxSize;
+
+}; // SizeClass
+
+static constexpr SizeClass SIZE_CLASSES[] = {
+    { "<=4KiB", 4 << 10 },
+    { "<=64KiB", 64 << 10 },
+    { "<=1MiB", 1 << 20 },
+    { "<=16MiB", 16 << 20 },
+    { ">16MiB", std::numeric_limits<uint64_t>::max() },
+};
+
+struct ReadOptions {
+    size_t minSamples { 32 };       // Warm reads per size class, entries are read again when the class has fewer
+    size_t coldSamples { 16 };      // Cold reads per size class, the page cache is dropped before each one
+    size_t openRepeat { 5 };        // Timed opens per cache state
+    std::vector<size_t> threads;    // Concurrent reader counts
+    double duration { 1.0 };        // Seconds of reading per reader count
+
+}; // ReadOptions
+
+static double Since(Clock::time_point in_start) {
+    return std::chrono::duration<double>(Clock::now() - in_start).count();
+}
+
+static double MegabytesPerSecond(uint64_t in_bytes, double in_seconds) {
+    return in_seconds > 0.0 ? in_bytes / 1e6 / in_seconds : 0.0;
+}
+
+// Writes the distribution of a list of timings, in_unitScale converts seconds to in_unit
+static void WriteLatency(bench::JsonWriter& io_report, const char* in_key, std::vector<double>& io_seconds,
+    const char* in_unit, double in_unitScale, uint64_t in_bytes = 0) {
+    double total = 0.0;
+    double slowest = 0.0;
+    for (double sample : io_seconds) {
+        total += sample;
+        slowest = std::max(slowest, sample);
+    }
+    double mean = io_seconds.empty() ? 0.0 : total / io_seconds.size();
+
+    io_report.BeginObject(in_key)
+        .Value("samples", static_cast<uint64_t>(io_seconds.size()))
+        .Value("unit", in_unit)
+        .Value("mean", mean * in_unitScale)
+        .Value("p50", bench::Percentile(io_seconds, 50.0) * in_unitScale)
+        .Value("p99", bench::Percentile(io_seconds, 99.0) * in_unitScale)
+        .Value("max", slowest * in_unitScale);
+    if (in_bytes != 0) {
+        io_report.Value("mbPerSecond", MegabytesPerSecond(in_bytes, total));
+    }
+    io_report.EndObject();
+}
+
+// Drops the pages of an archive from the page cache. The mapping of an open
+// reader (if any) is zapped first, mapped pages would stay cached otherwise.
+static bool EvictFromCache(const fs::path& in_path, const uint8_t* in_mapping, uint64_t in_mappingSize) {
+#ifdef _WIN32
+    return false;
+#else
+    if (in_mapping != nullptr) {
+        ::madvise(const_cast<uint8_t*>(in_mapping), static_cast<size_t>(in_mappingSize), MADV_DONTNEED);
+    }
+
+    int fd = ::open(in_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool evicted = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(fd);
+    return evicted;
+#endif
+}
+
+// Fraction of the mapping still in the page cache, shows whether eviction worked (tmpfs cannot evict)
+static double GetResidentFraction(const uint8_t* in_mapping, uint64_t in_mappingSize) {
+#ifdef _WIN32
+    return 1.0;
+#else
+    size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> pages((static_cast<size_t>(in_mappingSize) + pageSize - 1) / pageSize);
+    if (pages.empty() || ::mincore(const_cast<uint8_t*>(in_mapping), static_cast<size_t>(in_mappingSize), pages.data()) != 0) {
+        return 1.0;
+    }
+
+    size_t resident = std::count_if(pages.begin(), pages.end(), [](unsigned char in_page) { return (in_page & 1) != 0; });
+    return static_cast<double>(resident) / pages.size();
+#endif
+}
+
+// Flushes a freshly written archive, dirty pages cannot be evicted
+static void SyncFile(const fs::path& in_path) {
+#ifndef _WIN32
+    int fd = ::open(in_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#else
+    (void)in_path;
+#endif
+}
+
+// Streams a whole entry through a small staging window, the way a consumer
+// uploads assets, so memory stays bounded whatever the number of readers
+static bool StreamEntry(const io::FLKArchiveReader& in_reader, size_t in_index,
+    io::FrameReader& io_frameReader, io::SolidBlockCache& io_solidCache, std::vector<uint8_t>& io_window) {
+    size_t position = 0;
+    flakpak::FLKDataSink sink = [&io_window, &position](const uint8_t* in_data, size_t in_size) {
+        while (in_size > 0) {
+            size_t count = std::min(in_size, io_window.size() - position);
+            std::memcpy(io_window.data() + position, in_data, count);
+            position = (position + count) % io_window.size();
+            in_data += count;
+            in_size -= count;
+        }
+        return true;
+    };
+
+    const flakpak::data_types::FLKEntryRecord& entry = in_reader.GetEntry(in_index);
+    const flakpak::data_types::FLKEntryInfo& info = in_reader.GetEntryInfo(in_index);
+    io::FLK_PACKED_ENTRY packed = in_reader.GetPackedEntry(in_index);
+    if (entry.baseSize == 0) {
+        return true;
+    }
+
+    if (info.solidBlock != flakpak::FLK_NOT_SOLID) {
+        const flakpak::data_types::FLKSolidBlock& block = in_reader.GetSolidBlock(info.solidBlock);
+        const uint8_t* data = nullptr;
+        return io_solidCache.ReadEntry(info.solidBlock, block, packed.archiveData + block.offset,
+            info.solidOffset, entry.baseSize, packed.session, data) &&
+            sink(data, static_cast<size_t>(entry.baseSize));
+    }
+
+    return io_frameReader.ReadRange(packed, 0, entry.baseSize, sink);
+}
+
+// Cost of expanding PathCompressor substitutions, paid for every entry when
+// a version 1 archive with compressed paths is opened
+static void MeasurePathExpansion(const fs::path& in_corpusDir, bench::JsonWriter& io_report) {
+    std::vector<std::string> compressedPaths;
+    uint64_t plainBytes = 0;
+    uint64_t compressedBytes = 0;
+    for (const auto& item : fs::recursive_directory_iterator(in_corpusDir)) {
+        if (item.is_regular_file()) {
+            std::string path = fs::relative(item.path(), in_corpusDir).generic_string();
+            compressedPaths.push_back(flakpak::pathcom::PathCompressor::CompressPath(path));
+            plainBytes += path.size();
+            compressedBytes += compressedPaths.back().size();
+        }
+    }
+
+    std::vector<double> samples;
+    samples.reserve(compressedPaths.size());
+    for (const std::string& path : compressedPaths) {
+        auto start = Clock::now();
+        std::string expanded = flakpak::pathcom::PathCompressor::DecompressPath(path);
+        samples.push_back(Since(start));
+    }
+
+    io_report.BeginObject("pathExpansion")
+        .Value("paths", static_cast<uint64_t>(compressedPaths.size()))
+        .Value("plainBytes", plainBytes)
+        .Value("compressedBytes", compressedBytes);
+    WriteLatency(io_report, "expand", samples, "ns", 1e9);
+    io_report.EndObject();
+}
+
+// Open time of an archive with a warm page cache, then with the archive evicted before every open
+static bool MeasureOpen(const fs::path& in_archive, const ReadOptions& in_options, bench::JsonWriter& io_report) {
+    std::vector<double> samples[2];
+    for (bool cold : { false, true }) {
+        if (cold && !COLD_CACHE_SUPPORTED) {
+            continue;
+        }
+
+        for (size_t run = 0; run <= in_options.openRepeat; run++) {
+            if (cold) {
+                EvictFromCache(in_archive, nullptr, 0);
+            }
+
+            io::FLKArchiveReader reader;
+            auto start = Clock::now();
+            if (!reader.Open(in_archive, flakpak::encryption::GetPassword())) {
+                return false;
+            }
+            double seconds = Since(start);
+
+            // The first warm open only fills the page cache
+            if (cold || run > 0) {
+                samples[cold].push_back(seconds);
+            }
+        }
+    }
+
+    io_report.BeginObject("open");
+    WriteLatency(io_report, "warm", samples[0], "us", 1e6);
+    if (COLD_CACHE_SUPPORTED) {
+        WriteLatency(io_report, "cold", samples[1], "us", 1e6);
+    }
+    io_report.EndObject();
+    return true;
+}
+
+// FindEntry() latency for stored paths, missing paths and paths using '\' separators
+static bool MeasureLookup(const io::FLKArchiveReader& in_reader, std::mt19937_64& io_random, bench::JsonWriter& io_report) {
+    std::vector<std::string> hits;
+    for (size_t i = 0; i < in_reader.GetEntryCount(); i++) {
+        hits.push_back(in_reader.GetEntryPath(i));
+    }
+    std::shuffle(hits.begin(), hits.end(), io_random);
+
+    std::vector<std::string> misses;
+    std::vector<std::string> backslashed;
+    for (const std::string& path : hits) {
+        misses.push_back(path + ".missing");
+        backslashed.push_back(path);
+        std::replace(backslashed.back().begin(), backslashed.back().end(), '/', '\\');
+    }
+
+    bool correct = true;
+    auto measure = [&](const char* in_key, const std::vector<std::string>& in_paths, bool in_found) {
+        std::vector<double> samples;
+        samples.reserve(in_paths.size());
+        for (const std::string& path : in_paths) {
+            auto start = Clock::now();
+            size_t index = in_reader.FindEntry(path);
+            samples.push_back(Since(start));
+            correct = correct && (index != flakpak::FLK_ENTRY_NOT_FOUND) == in_found;
+        }
+
+        // Reading the clock costs about as much as a lookup, one timed loop gives the real mean
+        size_t found = 0;
+        auto start = Clock::now();
+        for (const std::string& path : in_paths) {
+            found += in_reader.FindEntry(path) != flakpak::FLK_ENTRY_NOT_FOUND;
+        }
+        double loopSeconds = Since(start);
+        correct = correct && found == (in_found ? in_paths.size() : 0);
+
+        io_report.BeginObject(in_key)
+            .Value("loopMeanNs", in_paths.empty() ? 0.0 : loopSeconds * 1e9 / in_paths.size());
+        WriteLatency(io_report, "timed", samples, "ns", 1e9);
+        io_report.EndObject();
+    };
+
+    io_report.BeginObject("lookup");
+    measure("hit", hits, true);
+    measure("miss", misses, false);
+    measure("backslash", backslashed, true);
+    io_report.EndObject();
+
+    if (!correct) {
+        std::cerr << "Path lookups returned wrong entries!\n";
+    }
+    return correct;
+}
+
+// ReadEntryInto() latency per size class, warm then with the archive evicted before every read
+static bool MeasureEntries(io::FLKArchiveReader& io_reader, const ReadOptions& in_options, std::mt19937_64& io_random, bench::JsonWriter& io_report) {
+    std::vector<std::vector<size_t>> classes(std::size(SIZE_CLASSES));
+    uint64_t largestSize = 0;
+    for (size_t i = 0; i < io_reader.GetEntryCount(); i++) {
+        uint64_t size = io_reader.GetEntrySize(i);
+        largestSize = std::max(largestSize, size);
+        for (size_t c = 0; c < std::size(SIZE_CLASSES); c++) {
+            if (size <= SIZE_CLASSES[c].maxSize) {
+                classes[c].push_back(i);
+                break;
+            }
+        }
+    }
+
+    // One untimed pass puts the archive in the page cache and warms the decoders
+    std::vector<uint8_t> buffer(static_cast<size_t>(largestSize));
+    for (size_t i = 0; i < io_reader.GetEntryCount(); i++) {
+        if (!io_reader.ReadEntryInto(i, buffer)) {
+            return false;
+        }
+    }
+
+    const uint8_t* mapping = io_reader.GetPackedEntry(0).archiveData;
+    uint64_t mappingSize = fs::file_size(io_reader.GetPath());
+
+    bool success = true;
+    io_report.BeginArray("entries");
+    for (size_t c = 0; c < classes.size(); c++) {
+        std::vector<size_t>& entries = classes[c];
+        if (entries.empty()) {
+            continue;
+        }
+        std::shuffle(entries.begin(), entries.end(), io_random);
+
+        uint64_t classBytes = 0;
+        for (size_t index : entries) {
+            classBytes += io_reader.GetEntrySize(index);
+        }
+
+        io_report.BeginObject()
+            .Value("sizeClass", SIZE_CLASSES[c].name)
+            .Value("entries", static_cast<uint64_t>(entries.size()))
+            .Value("meanEntryBytes", classBytes / entries.size());
+
+        // Reads in_count entries of the class, in_cold drops the page cache before each read
+        std::vector<double> samples;
+        uint64_t bytesRead = 0;
+        double resident = 0.0;
+        auto timeReads = [&](size_t in_count, bool in_cold) {
+            samples.clear();
+            bytesRead = 0;
+            resident = 0.0;
+            for (size_t s = 0; s < in_count; s++) {
+                size_t index = entries[s % entries.size()];
+                if (in_cold) {
+                    EvictFromCache(io_reader.GetPath(), mapping, mappingSize);
+                    resident += GetResidentFraction(mapping, mappingSize) / in_count;
+                }
+
+                auto start = Clock::now();
+                if (!io_reader.ReadEntryInto(index, buffer)) {
+                    return false;
+                }
+                samples.push_back(Since(start));
+                bytesRead += io_reader.GetEntrySize(index);
+            }
+            return true;
+        };
+
+        success = timeReads(std::max(entries.size(), in_options.minSamples), false);
+        WriteLatency(io_report, "warm", samples, "us", 1e6, bytesRead);
+
+        if (success && COLD_CACHE_SUPPORTED && in_options.coldSamples > 0) {
+            success = timeReads(std::min(entries.size(), in_options.coldSamples), true);
+            WriteLatency(io_report, "cold", samples, "us", 1e6, bytesRead);
+            io_report.Value("residentAfterEvict", resident);
+        }
+
+        io_report.EndObject();
+        if (!success) {
+            break;
+        }
+    }
+    io_report.EndArray();
+
+    return success;
+}
+
+// Aggregate throughput of several threads reading the same archive with a warm page cache
+static bool MeasureConcurrency(const io::FLKArchiveReader& in_reader, const ReadOptions& in_options, std::mt19937_64& io_random, bench::JsonWriter& io_report) {
+    std::vector<size_t> order(in_reader.GetEntryCount());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), io_random);
+
+    double baseline = 0.0;
+    io_report.BeginArray("concurrency");
+    for (size_t threadCount : in_options.threads) {
+        std::atomic<size_t> nextEntry { 0 };
+        std::atomic<uint64_t> totalBytes { 0 };
+        std::atomic<uint64_t> totalEntries { 0 };
+        std::atomic<bool> failed { false };
+        Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(in_options.duration));
+
+        // Readers share the archive tables, each one keeps its own decoders (see FLKExtractor)
+        auto worker = [&]() {
+            io::FrameReader frameReader;
+            io::SolidBlockCache solidCache;
+            std::vector<uint8_t> window(STREAM_WINDOW_SIZE);
+            uint64_t bytes = 0;
+            uint64_t entries = 0;
+
+            while (!failed.load(std::memory_order_relaxed) && Clock::now() < deadline) {
+                size_t index = order[nextEntry.fetch_add(1, std::memory_order_relaxed) % order.size()];
+                if (!StreamEntry(in_reader, index, frameReader, solidCache, window)) {
+                    failed = true;
+                    break;
+                }
+                bytes += in_reader.GetEntrySize(index);
+                entries++;
+            }
+            totalBytes += bytes;
+            totalEntries += entries;
+        };
+
+        auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < threadCount; t++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        double seconds = Since(start);
+
+        if (failed) {
+            io_report.EndArray();
+            return false;
+        }
+
+        double megabytesPerSecond = MegabytesPerSecond(totalBytes, seconds);
+        if (baseline == 0.0) {
+            baseline = megabytesPerSecond;
+        }
+
+        io_report.BeginObject()
+            .Value("threads", static_cast<uint64_t>(threadCount))
+            .Value("seconds", seconds)
+            .Value("entries", totalEntries.load())
+            .Value("bytes", totalBytes.load())
+            .Value("mbPerSecond", megabytesPerSecond)
+            .Value("entriesPerSecond", totalEntries / seconds)
+            .Value("scaling", baseline > 0.0 ? megabytesPerSecond / baseline : 0.0)
+            .EndObject();
+    }
+    io_report.EndArray();
+
+    return true;
+}
+
+// Decode paths of ZstdCompressor and XChaCha20Poly1305Encryptor on in-memory blobs, without any archive around them
+static bool MeasureCodecs(const ReadOptions& in_options, int in_level, uint64_t in_seed, bench::JsonWriter& io_report) {
+    using namespace flakpak::encryption::xccp20;
+
+    // One key session for every blob, Argon2id runs once
+    XChaCha20Poly1305KeySession session;
+    if (!session.Create(flakpak::encryption::GetPassword(), XChaCha20Poly1305KeySession::GetDefaultParams())) {
+        return false;
+    }
+
+    flakpak::compression::zstd::ZstdCompressor compressor;
+    XChaCha20Poly1305Encryptor encryptor;
+    XChaCha20Poly1305StreamDecryptor streamDecryptor;
+
+    io_report.BeginArray("codecs");
+    for (size_t c = 0; c + 1 < std::size(SIZE_CLASSES); c++) {
+        uint64_t size = SIZE_CLASSES[c].maxSize;
+        std::vector<uint8_t> plain;
+        bench::CorpusGenerator::FillSample(in_seed + c, size, true, plain);
+        std::vector<uint8_t> output(plain.size());
+        size_t sampleCount = std::clamp<size_t>(static_cast<size_t>((256ULL << 20) / size), in_options.minSamples, 1000);
+        uint64_t sampleBytes = size * sampleCount;
+
+        // zstd frame decompressed into caller memory
+        flakpak::data_types::FLK_COMPRESSION_RESULT compressed = compressor.CompressData(plain.data(), plain.size(), in_level);
+        std::vector<double> zstdSamples;
+        for (size_t s = 0; s <= sampleCount; s++) {
+            size_t outSize = 0;
+            auto start = Clock::now();
+            bool success = compressor.DecompressData(compressed.data, output, outSize);
+            double seconds = Since(start);
+            if (!success || outSize != plain.size() || (s == 0 && output != plain)) {
+                return false;
+            }
+            if (s > 0) {
+                zstdSamples.push_back(seconds);
+            }
+        }
+
+        // One-shot XChaCha20-Poly1305 blob decrypted where it lies, the ciphertext is restored untimed
+        flakpak::data_types::FLK_ENCRYPTION_RESULT encrypted = encryptor.EncryptData(plain, session);
+        std::vector<uint8_t> scratch(encrypted.data.size());
+        std::vector<double> inPlaceSamples;
+        for (size_t s = 0; s <= sampleCount; s++) {
+            std::memcpy(scratch.data(), encrypted.data.data(), scratch.size());
+            std::span<uint8_t> decrypted;
+            auto start = Clock::now();
+            bool success = encryptor.DecryptInPlace(scratch, session, decrypted);
+            double seconds = Since(start);
+            if (!success || decrypted.size() != plain.size()) {
+                return false;
+            }
+            if (s > 0) {
+                inPlaceSamples.push_back(seconds);
+            }
+        }
+
+        // Chunked secretstream blob, the layout of the entries of encrypted archives
+        std::vector<uint8_t> blob;
+        flakpak::FLKDataSink append = [&blob](const uint8_t* in_data, size_t in_size) {
+            blob.insert(blob.end(), in_data, in_data + in_size);
+            return true;
+        };
+        XChaCha20Poly1305StreamEncryptor streamEncryptor;
+        if (!streamEncryptor.Begin(session, append) || !streamEncryptor.Push(plain.data(), plain.size(), append) || !streamEncryptor.End(append)) {
+            return false;
+        }
+        std::vector<double> streamSamples;
+        for (size_t s = 0; s <= sampleCount; s++) {
+            size_t outSize = 0;
+            auto start = Clock::now();
+            bool success = streamDecryptor.DecryptInto(session, blob, output, outSize);
+            double seconds = Since(start);
+            if (!success || outSize != plain.size() || (s == 0 && output != plain)) {
+                return false;
+            }
+            if (s > 0) {
+                streamSamples.push_back(seconds);
+            }
+        }
+
+        io_report.BeginObject()
+            .Value("bytes", size)
+            .Value("compressedBytes", static_cast<uint64_t>(compressed.data.size()));
+        WriteLatency(io_report, "zstdDecompress", zstdSamples, "us", 1e6, sampleBytes);
+        WriteLatency(io_report, "xchachaDecryptInPlace", inPlaceSamples, "us", 1e6, sampleBytes);
+        WriteLatency(io_report, "xchachaStreamDecrypt", streamSamples, "us", 1e6, sampleBytes);
+        io_report.EndObject();
+    }
+    io_report.EndArray();
+
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    CLI::App app{ "flakpak read benchmark" };
+
+    fs::path workDir = "flakbench";
+    std::string reportPath;
+    bench::BENCH_CORPUS_SPEC spec;
+    std::vector<std::string> selectedModes;
+    ReadOptions options;
+    int level = 3;
+    size_t jobCount = 0;
+    bool keepArchives = false;
+
+    for (size_t threads = 1; threads < std::thread::hardware_concurrency(); threads *= 2) {
+        options.threads.push_back(threads);
+    }
+    options.threads.push_back(std::max<size_t>(std::thread::hardware_concurrency(), 1));
+
+    app.add_option("-w,--work-dir", workDir,
+        "Directory holding the generated corpus and the archives")->default_val(workDir.string());
+
+    app.add_option("-o,--output", reportPath,
+        "Write the JSON report to this file (default: standard output)");
+
+    app.add_option("--scale", spec.scale,
+        "Multiplies the number of files and the size of the huge files of the corpus")
+        ->default_val(spec.scale)->check(CLI::Range(0.001, 100.0));
+
+    app.add_option("--seed", spec.seed,
+        "Seed of the corpus, the same seed and scale always give the same files")->default_val(spec.seed);
+
+    app.add_option("-m,--mode", selectedModes,
+        "Archives to read (plain, compressed, encrypted, compressed-encrypted), can be repeated (default: all)")
+        ->check(CLI::IsMember({ "plain", "compressed", "encrypted", "compressed-encrypted" }));
+
+    app.add_option("-l,--level", level,
+        "zstd level of the compressed archives")->default_val(level)->check(CLI::Range(1, 22));
+
+    app.add_option("-j,--jobs", jobCount,
+        "Worker threads of the packer building the archives (0 = all cores)")->default_val(jobCount);
+
+    app.add_option("-t,--threads", options.threads,
+        "Concurrent reader counts (default: powers of two up to the hardware threads)")->check(CLI::Range(1, 1024));
+
+    app.add_option("-d,--duration", options.duration,
+        "Seconds of reading per concurrent reader count")->default_val(options.duration)->check(CLI::Range(0.1, 600.0));
+
+    app.add_option("-s,--samples", options.minSamples,
+        "Minimum warm reads per size class")->default_val(options.minSamples)->check(CLI::Range(1, 100000));
+
+    app.add_option("--cold-samples", options.coldSamples,
+        "Cold reads per size class, 0 skips them")->default_val(options.coldSamples);
+
+    app.add_option("--open-repeat", options.openRepeat,
+        "Timed opens per cache state")->default_val(options.openRepeat)->check(CLI::Range(1, 1000));
+
+    app.add_flag("--keep-archives", keepArchives,
+        "Keep the archives in the work directory and reuse them on the next run");
+
+    CLI11_PARSE(app, argc, argv);
+
+    std::error_code ec;
+    fs::create_directories(workDir, ec);
+
+    fs::path corpusDir = workDir / "corpus";
+    std::cerr << "Generating corpus in " << corpusDir.string() << "\n";
+    std::vector<bench::BENCH_CORPUS_GROUP> groups;
+    if (!bench::CorpusGenerator::Generate(corpusDir, spec, groups)) {
+        std::cerr << "Corpus generation failed!\n";
+        return 1;
+    }
+
+    bench::JsonWriter report;
+    report.BeginObject().Value("benchmark", "read");
+    bench::WriteEnvironment(report);
+    bench::WriteCorpus(report, spec, groups);
+    report.Value("level", level)
+        .Value("coldCache", COLD_CACHE_SUPPORTED);
+
+    std::mt19937_64 random(spec.seed);
+    MeasurePathExpansion(corpusDir, report);
+
+    std::cerr << "Measuring codecs\n";
+    if (!MeasureCodecs(options, level, spec.seed, report)) {
+        std::cerr << "Codec measurement failed!\n";
+        return 1;
+    }
+
+    bool allSucceeded = true;
+    report.BeginArray("archives");
+    for (const bench::BENCH_PACK_MODE& mode : bench::BuildPackModes(selectedModes, { level }, jobCount)) {
+        fs::path archivePath = workDir / ("read_" + mode.name + ".flk");
+        bool reused = keepArchives && fs::exists(archivePath, ec);
+        if (!reused) {
+            std::cerr << "Packing " << mode.name << "\n";
+            bench::BENCH_RUN packed = bench::RunIsolated([&]() {
+                return flakpak::FLKPacker::PackDirectory(corpusDir, archivePath, mode.options);
+            });
+            if (!packed.success) {
+                std::cerr << mode.name << ": packing failed!\n";
+                allSucceeded = false;
+                continue;
+            }
+            SyncFile(archivePath);
+        }
+
+        std::cerr << "Reading " << mode.name << "\n";
+        report.BeginObject()
+            .Value("mode", mode.name)
+            .Value("compress", mode.compress)
+            .Value("encrypt", mode.encrypt)
+            .Value("archiveBytes", static_cast<uint64_t>(fs::file_size(archivePath, ec)));
+
+        io::FLKArchiveReader reader;
+        bool success = MeasureOpen(archivePath, options, report) &&
+            reader.Open(archivePath, flakpak::encryption::GetPassword());
+        if (success) {
+            report.Value("entries", static_cast<uint64_t>(reader.GetEntryCount()));
+            success = MeasureLookup(reader, random, report) &&
+                MeasureEntries(reader, options, random, report) &&
+                MeasureConcurrency(reader, options, random, report);
+        }
+        reader.Close();
+
+        report.Value("success", success).EndObject();
+        if (!success) {
+            std::cerr << mode.name << ": reading failed!\n";
+            allSucceeded = false;
+        }
+
+        if (!keepArchives) {
+            fs::remove(archivePath, ec);
+        }
+    }
+    report.EndArray().EndObject();
+
+    if (!bench::SaveReport(report, reportPath)) {
+        return 1;
+    }
+
+    return allSucceeded ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+#include <flakbench/bench_Corpus.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+
+namespace flakpak::bench {
+	static constexpr uint64_t BENCH_HUGE_BLOCK_SIZE = 1 << 20;		// Huge files switch between texture and noise every block
+	static constexpr uint32_t BENCH_TEXTURE_WIDTH = 1024;			// Pixels per texture row (RGBA8)
+	static constexpr size_t BENCH_CONFIG_DIRECTORIES = 16;
+
+	static constexpr const char* BENCH_CONFIG_WORDS[] = {
+		"enabled", "speed", "damage", "health", "texture", "model", "sound", "volume",
+		"spawn", "radius", "color", "shader", "weight", "friction", "lod", "distance",
+		"player", "enemy", "weapon", "ammo", "level", "zone", "trigger", "script",
+	};
+	static constexpr const char* BENCH_MEDIA_EXTENSIONS[] = { ".ogg", ".png", ".mp4" };
+
+	bool CorpusGenerator::Generate(const std::filesystem::path& in_dir, const BENCH_CORPUS_SPEC& in_spec, std::vector<BENCH_CORPUS_GROUP>& out_groups) {
+		std::filesystem::path stampPath = in_dir;
+		stampPath += ".stamp";
+		std::string stamp = GetStamp(in_spec);
+
+		std::error_code ec;
+		{
+			std::ifstream stampFile(stampPath);
+			std::string existing((std::istreambuf_iterator<char>(stampFile)), std::istreambuf_iterator<char>());
+			if (existing == stamp && std::filesystem::is_directory(in_dir, ec)) {
+				out_groups = Describe(in_dir);
+				return true;
+			}
+		}
+
+		std::filesystem::remove_all(in_dir, ec);
+		std::filesystem::remove(stampPath, ec);
+
+		auto scaled = [&in_spec](size_t in_count) {
+			return std::max<size_t>(1, static_cast<size_t>(std::llround(in_count * in_spec.scale)));
+		};
+
+		Random random(in_spec.seed);
+		std::vector<uint8_t> data;
+
+		for (size_t i = 0; i < scaled(in_spec.tinyCount); i++) {
+			FillConfig(random, random.Range(in_spec.tinyMinSize, in_spec.tinyMaxSize), data);
+			std::filesystem::path path = in_dir / "configs" / ("group_" + std::to_string(i % BENCH_CONFIG_DIRECTORIES)) /
+				("config_" + std::to_string(i) + (i % 2 == 0 ? ".ini" : ".cfg"));
+			if (!WriteFile(path, data)) {
+				return false;
+			}
+		}
+
+		for (size_t i = 0; i < scaled(in_spec.textureCount); i++) {
+			FillTexture(random, random.Range(in_spec.textureMinSize, in_spec.textureMaxSize), data);
+			if (!WriteFile(in_dir / "textures" / ("texture_" + std::to_string(i) + ".dds"), data)) {
+				return false;
+			}
+		}
+
+		for (size_t i = 0; i < scaled(in_spec.mediaCount); i++) {
+			FillNoise(random, random.Range(in_spec.mediaMinSize, in_spec.mediaMaxSize), data);
+			const char* extension = BENCH_MEDIA_EXTENSIONS[i % std::size(BENCH_MEDIA_EXTENSIONS)];
+			if (!WriteFile(in_dir / "media" / ("media_" + std::to_string(i) + extension), data)) {
+				return false;
+			}
+		}
+
+		// Huge files only grow with the scale, there are always hugeCount of them
+		uint64_t hugeSize = std::max<uint64_t>(BENCH_HUGE_BLOCK_SIZE, static_cast<uint64_t>(in_spec.hugeSize * in_spec.scale));
+		for (size_t i = 0; i < in_spec.hugeCount; i++) {
+			std::vector<uint8_t> file;
+			file.reserve(static_cast<size_t>(hugeSize));
+			for (uint64_t offset = 0; offset < hugeSize; offset += BENCH_HUGE_BLOCK_SIZE) {
+				uint64_t blockSize = std::min(BENCH_HUGE_BLOCK_SIZE, hugeSize - offset);
+				if ((offset / BENCH_HUGE_BLOCK_SIZE) % 2 == 0) {
+					FillTexture(random, blockSize, data);
+				}
+				else {
+					FillNoise(random, blockSize, data);
+				}
+				file.insert(file.end(), data.begin(), data.end());
+			}
+
+			if (!WriteFile(in_dir / "huge" / ("bundle_" + std::to_string(i) + ".bin"), file)) {
+				return false;
+			}
+		}
+
+		std::ofstream stampFile(stampPath, std::ios::trunc);
+		stampFile << stamp;
+
+		out_groups = Describe(in_dir);
+		return true;
+	}
+
+	std::vector<BENCH_CORPUS_GROUP> CorpusGenerator::Describe(const std::filesystem::path& in_dir) {
+		std::vector<BENCH_CORPUS_GROUP> groups;
+		for (const char* name : { "configs", "textures", "media", "huge" }) {
+			BENCH_CORPUS_GROUP group;
+			group.name = name;
+
+			std::error_code ec;
+			if (std::filesystem::is_directory(in_dir / name, ec)) {
+				for (const auto& entry : std::filesystem::recursive_directory_iterator(in_dir / name)) {
+					if (entry.is_regular_file()) {
+						group.fileCount++;
+						group.byteCount += entry.file_size();
+					}
+				}
+			}
+			groups.push_back(group);
+		}
+
+		return groups;
+	}
+
+	void CorpusGenerator::FillSample(uint64_t in_seed, uint64_t in_size, bool in_compressible, std::vector<uint8_t>& out_data) {
+		Random random(in_seed);
+		if (in_compressible) {
+			FillTexture(random, in_size, out_data);
+		}
+		else {
+			FillNoise(random, in_size, out_data);
+		}
+	}
+
+	// Private methods
+	// ---------------------------------------------------------------------------
+	uint64_t CorpusGenerator::Random::Next() {
+		// SplitMix64
+		uint64_t value = (m_state += 0x9E3779B97F4A7C15ULL);
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+		return value ^ (value >> 31);
+	}
+
+	uint64_t CorpusGenerator::Random::Range(uint64_t in_min, uint64_t in_max) {
+		return in_max <= in_min ? in_min : in_min + Next() % (in_max - in_min + 1);
+	}
+
+	bool CorpusGenerator::WriteFile(const std::filesystem::path& in_path, const std::vector<uint8_t>& in_data) {
+		std::error_code ec;
+		std::filesystem::create_directories(in_path.parent_path(), ec);
+
+		std::ofstream file(in_path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(in_data.data()), static_cast<std::streamsize>(in_data.size()));
+		if (!file) {
+			/// TODO
+			/// Handle error: failed to write corpus file
+			/// Output to console
+			std::cerr << "Error: Failed to write corpus file: " << in_path.string() << "\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	std::string CorpusGenerator::GetStamp(const BENCH_CORPUS_SPEC& in_spec) {
+		std::ostringstream stamp;
+		stamp << "seed=" << in_spec.seed << " scale=" << in_spec.scale
+			<< " tiny=" << in_spec.tinyCount << ":" << in_spec.tinyMinSize << "-" << in_spec.tinyMaxSize
+			<< " texture=" << in_spec.textureCount << ":" << in_spec.textureMinSize << "-" << in_spec.textureMaxSize
+			<< " media=" << in_spec.mediaCount << ":" << in_spec.mediaMinSize << "-" << in_spec.mediaMaxSize
+			<< " huge=" << in_spec.hugeCount << ":" << in_spec.hugeSize;
+		return stamp.str();
+	}
+
+	void CorpusGenerator::FillConfig(Random& io_random, uint64_t in_size, std::vector<uint8_t>& out_data) {
+		// "key = value" lines grouped in sections, like an ini file
+		std::string text;
+		while (text.size() < in_size) {
+			if (io_random.Range(0, 7) == 0) {
+				text += "[";
+				text += BENCH_CONFIG_WORDS[io_random.Range(0, std::size(BENCH_CONFIG_WORDS) - 1)];
+				text += "]\n";
+			}
+
+			text += BENCH_CONFIG_WORDS[io_random.Range(0, std::size(BENCH_CONFIG_WORDS) - 1)];
+			text += "_";
+			text += BENCH_CONFIG_WORDS[io_random.Range(0, std::size(BENCH_CONFIG_WORDS) - 1)];
+			text += " = ";
+			switch (io_random.Range(0, 2)) {
+			case 0:
+				text += std::to_string(io_random.Range(0, 1000));
+				break;
+			case 1:
+				text += io_random.Range(0, 1) ? "true" : "false";
+				break;
+			default:
+				text += "\"";
+				text += BENCH_CONFIG_WORDS[io_random.Range(0, std::size(BENCH_CONFIG_WORDS) - 1)];
+				text += ".asset\"";
+				break;
+			}
+			text += "\n";
+		}
+
+		out_data.assign(text.begin(), text.begin() + static_cast<std::ptrdiff_t>(in_size));
+	}
+
+	void CorpusGenerator::FillTexture(Random& io_random, uint64_t in_size, std::vector<uint8_t>& out_data) {
+		// RGBA8 gradients with a little noise, compresses about like real albedo maps
+		out_data.resize(static_cast<size_t>(in_size));
+		std::array<uint32_t, 4> slopes {};
+		for (uint32_t& slope : slopes) {
+			slope = static_cast<uint32_t>(io_random.Range(1, 7));
+		}
+
+		uint64_t noise = 0;
+		for (size_t i = 0; i < out_data.size(); i++) {
+			if (i % 16 == 0) {
+				noise = io_random.Next();
+			}
+			uint32_t pixel = static_cast<uint32_t>(i / 4);
+			uint32_t x = pixel % BENCH_TEXTURE_WIDTH;
+			uint32_t y = pixel / BENCH_TEXTURE_WIDTH;
+			uint32_t channel = static_cast<uint32_t>(i % 4);
+
+			uint32_t value = (x * slopes[channel] + y * slopes[3 - channel]) / 8 + static_cast<uint32_t>((noise >> (4 * (i % 16))) & 3);
+			out_data[i] = static_cast<uint8_t>(channel == 3 ? 0xFF : value);
+		}
+	}
+
+	void CorpusGenerator::FillNoise(Random& io_random, uint64_t in_size, std::vector<uint8_t>& out_data) {
+		out_data.resize(static_cast<size_t>(in_size));
+		for (size_t i = 0; i < out_data.size(); i += sizeof(uint64_t)) {
+			uint64_t value = io_random.Next();
+			for (size_t b = 0; b < sizeof(uint64_t) && i + b < out_data.size(); b++) {
+				out_data[i + b] = static_cast<uint8_t>(value >> (8 * b));
+			}
+		}
+	}
+
+} // namespace flakpak::bench
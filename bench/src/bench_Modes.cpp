@@ -0,0 +1,49 @@
+#include <flakbench/bench_Modes.hpp>
+
+#include <algorithm>
+
+
+namespace flakpak::bench {
+	static BENCH_PACK_MODE MakeMode(const char* in_name, bool in_compress, bool in_encrypt, int in_level, size_t in_jobCount) {
+		BENCH_PACK_MODE mode;
+		mode.name = in_name;
+		mode.level = in_compress ? in_level : 0;
+		mode.compress = in_compress;
+		mode.encrypt = in_encrypt;
+		mode.options.compress = in_compress;
+		mode.options.encrypt = in_encrypt;
+		if (in_compress) {
+			mode.options.compressionLevel = in_level;
+		}
+		mode.options.jobCount = in_jobCount;
+		mode.options.formatVersion = FLK_FORMAT_VERSION_2;
+		return mode;
+	}
+
+	std::vector<BENCH_PACK_MODE> BuildPackModes(const std::vector<std::string>& in_selected, const std::vector<int>& in_levels, size_t in_jobCount) {
+		auto selected = [&in_selected](const char* in_mode) {
+			return in_selected.empty() || std::find(in_selected.begin(), in_selected.end(), in_mode) != in_selected.end();
+		};
+
+		std::vector<BENCH_PACK_MODE> modes;
+		if (selected("plain")) {
+			modes.push_back(MakeMode("PackUncompressedAndUnencrypted", false, false, 0, in_jobCount));
+		}
+		if (selected("compressed")) {
+			for (int level : in_levels) {
+				modes.push_back(MakeMode("PackCompressedAndUnencrypted", true, false, level, in_jobCount));
+			}
+		}
+		if (selected("encrypted")) {
+			modes.push_back(MakeMode("PackUncompressedAndEncrypted", false, true, 0, in_jobCount));
+		}
+		if (selected("compressed-encrypted")) {
+			for (int level : in_levels) {
+				modes.push_back(MakeMode("PackCompressedAndEncrypted", true, true, level, in_jobCount));
+			}
+		}
+
+		return modes;
+	}
+
+} // namespace flakpak::bench
@@ -0,0 +1,352 @@
+#include <flakbench/bench_Report.hpp>
+
+#include <flakpak/flak_FLKDefinition.hpp>
+
+#include <zstd/zstd.h>
+#include <libsodium/sodium.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+
+namespace flakpak::bench {
+	JsonWriter& JsonWriter::BeginObject(const char* in_key) {
+		BeginValue(in_key);
+		m_text += "{";
+		m_hasItems.push_back(false);
+		return *this;
+	}
+
+	JsonWriter& JsonWriter::EndObject() {
+		bool hasItems = m_hasItems.back();
+		m_hasItems.pop_back();
+		if (hasItems) {
+			m_text += "\n" + std::string(m_hasItems.size() * 2, ' ');
+		}
+		m_text += "}";
+		return *this;
+	}
+
+	JsonWriter& JsonWriter::BeginArray(const char* in_key) {
+		BeginValue(in_key);
+		m_text += "[";
+		m_hasItems.push_back(false);
+		return *this;
+	}
+
+	JsonWriter& JsonWriter::EndArray() {
+		bool hasItems = m_hasItems.back();
+		m_hasItems.pop_back();
+		if (hasItems) {
+			m_text += "\n" + std::string(m_hasItems.size() * 2, ' ');
+		}
+		m_text += "]";
+		return *this;
+	}
+
+	JsonWriter& JsonWriter::Value(const char* in_key, const std::string& in_value) {
+		BeginValue(in_key);
+		m_text += "\"" + Escape(in_value) + "\"";
+		return *this;
+	}
+
+	JsonWriter& JsonWriter::Value(const char* in_key, const char* in_value) {
+		return Value(in_key, std::string(in_value));
+	}
+
+	JsonWriter& JsonWriter::Value(const char* in_key, double in_value) {
+		BeginValue(in_key);
+		// JSON has no infinity or NaN
+		if (!std::isfinite(in_value)) {
+			m_text += "null";
+			return *this;
+		}
+
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.6g", in_value);
+		m_text += buffer;
+		return *this;
+	}
+
+	JsonWriter& JsonWriter::Value(const char* in_key, uint64_t in_value) {
+		BeginValue(in_key);
+		m_text += std::to_string(in_value);
+		return *this;
+	}
+
+	JsonWriter& JsonWriter::Value(const char* in_key, int64_t in_value) {
+		BeginValue(in_key);
+		m_text += std::to_string(in_value);
+		return *this;
+	}
+
+	JsonWriter& JsonWriter::Value(const char* in_key, int in_value) {
+		return Value(in_key, static_cast<int64_t>(in_value));
+	}
+
+	JsonWriter& JsonWriter::Value(const char* in_key, bool in_value) {
+		BeginValue(in_key);
+		m_text += in_value ? "true" : "false";
+		return *this;
+	}
+
+	const std::string& JsonWriter::GetText() const {
+		return m_text;
+	}
+
+	// Private methods
+	// ---------------------------------------------------------------------------
+	void JsonWriter::BeginValue(const char* in_key) {
+		if (!m_hasItems.empty()) {
+			m_text += m_hasItems.back() ? ",\n" : "\n";
+			m_hasItems.back() = true;
+			m_text += std::string(m_hasItems.size() * 2, ' ');
+		}
+		if (in_key) {
+			m_text += "\"" + Escape(in_key) + "\": ";
+		}
+	}
+
+	std::string JsonWriter::Escape(const std::string& in_text) {
+		std::string escaped;
+		for (char c : in_text) {
+			switch (c) {
+			case '"': escaped += "\\\""; break;
+			case '\\': escaped += "\\\\"; break;
+			case '\n': escaped += "\\n"; break;
+			case '\t': escaped += "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char buffer[8];
+					std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+					escaped += buffer;
+				}
+				else {
+					escaped += c;
+				}
+				break;
+			}
+		}
+		return escaped;
+	}
+
+	// Measurement
+	// ---------------------------------------------------------------------------
+#ifdef _WIN32
+	BENCH_RUN RunIsolated(const std::function<bool()>& in_workload) {
+		BENCH_RUN run;
+
+		// The packer output is dropped, the standard error stays for errors
+		std::ostringstream discard;
+		std::streambuf* previous = std::cout.rdbuf(discard.rdbuf());
+
+		auto startTime = std::chrono::steady_clock::now();
+		run.success = in_workload();
+		run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+		std::cout.rdbuf(previous);
+
+		PROCESS_MEMORY_COUNTERS counters {};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			run.peakRssKiB = counters.PeakWorkingSetSize >> 10;
+		}
+		return run;
+	}
+#else
+	BENCH_RUN RunIsolated(const std::function<bool()>& in_workload) {
+		BENCH_RUN run;
+		run.isolated = true;
+
+		int channel[2];
+		if (::pipe(channel) != 0) {
+			/// TODO
+			/// Handle error: failed to create pipe
+			/// Output to console
+			std::cerr << "Error: Failed to create the result pipe.\n";
+			return run;
+		}
+
+		// Flushed before forking, the child would print them a second time
+		std::cout.flush();
+		std::cerr.flush();
+
+		pid_t child = ::fork();
+		if (child == 0) {
+			::close(channel[0]);
+			int null = ::open("/dev/null", O_WRONLY);
+			if (null >= 0) {
+				::dup2(null, STDOUT_FILENO);
+			}
+
+			auto startTime = std::chrono::steady_clock::now();
+			bool success = in_workload();
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+			std::cout.flush();
+
+			char result[sizeof(success) + sizeof(seconds)];
+			std::memcpy(result, &success, sizeof(success));
+			std::memcpy(result + sizeof(success), &seconds, sizeof(seconds));
+			bool written = ::write(channel[1], result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+			::_exit(written ? 0 : 1);
+		}
+		::close(channel[1]);
+		if (child < 0) {
+			::close(channel[0]);
+			std::cerr << "Error: Failed to fork the benchmark run.\n";
+			return run;
+		}
+
+		char result[sizeof(bool) + sizeof(double)];
+		size_t received = 0;
+		while (received < sizeof(result)) {
+			ssize_t size = ::read(channel[0], result + received, sizeof(result) - received);
+			if (size <= 0) {
+				break;
+			}
+			received += static_cast<size_t>(size);
+		}
+		::close(channel[0]);
+
+		int status = 0;
+		struct rusage usage {};
+		::wait4(child, &status, 0, &usage);
+
+		// A crashed child never sent its result
+		if (received == sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+			std::memcpy(&run.success, result, sizeof(run.success));
+			std::memcpy(&run.seconds, result + sizeof(run.success), sizeof(run.seconds));
+		}
+		run.cpuSeconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#ifdef __APPLE__
+		run.peakRssKiB = static_cast<uint64_t>(usage.ru_maxrss) >> 10;		// Bytes on macOS
+#else
+		run.peakRssKiB = static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+		return run;
+	}
+#endif
+
+	void WriteEnvironment(JsonWriter& io_writer) {
+		char timestamp[32] {};
+		std::time_t now = std::time(nullptr);
+		std::tm utc {};
+#ifdef _WIN32
+		gmtime_s(&utc, &now);
+#else
+		gmtime_r(&now, &utc);
+#endif
+		std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+		char hostName[256] {};
+#ifdef _WIN32
+		DWORD hostSize = sizeof(hostName);
+		GetComputerNameA(hostName, &hostSize);
+#else
+		::gethostname(hostName, sizeof(hostName) - 1);
+#endif
+
+#if defined(__clang__)
+		std::string compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+		std::string compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+		std::string compiler = "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+		std::string compiler = "unknown";
+#endif
+
+		io_writer.BeginObject("environment")
+			.Value("timestamp", timestamp)
+			.Value("host", hostName)
+			.Value("hardwareThreads", static_cast<uint64_t>(std::thread::hardware_concurrency()))
+			.Value("compiler", compiler)
+			.Value("zstd", ZSTD_versionString())
+			.Value("libsodium", sodium_version_string())
+			.Value("formatVersion", static_cast<int>(FLK_FORMAT_VERSION_2))
+			.EndObject();
+	}
+
+	void WriteCorpus(JsonWriter& io_writer, const BENCH_CORPUS_SPEC& in_spec, const std::vector<BENCH_CORPUS_GROUP>& in_groups) {
+		uint64_t fileCount = 0;
+		uint64_t byteCount = 0;
+		for (const BENCH_CORPUS_GROUP& group : in_groups) {
+			fileCount += group.fileCount;
+			byteCount += group.byteCount;
+		}
+
+		io_writer.BeginObject("corpus")
+			.Value("seed", in_spec.seed)
+			.Value("scale", in_spec.scale)
+			.Value("files", fileCount)
+			.Value("bytes", byteCount)
+			.BeginArray("groups");
+		for (const BENCH_CORPUS_GROUP& group : in_groups) {
+			io_writer.BeginObject()
+				.Value("name", group.name)
+				.Value("files", static_cast<uint64_t>(group.fileCount))
+				.Value("bytes", group.byteCount)
+				.EndObject();
+		}
+		io_writer.EndArray().EndObject();
+	}
+
+	bool SaveReport(const JsonWriter& in_writer, const std::string& in_path) {
+		if (in_path.empty()) {
+			std::cout << in_writer.GetText() << "\n";
+			return true;
+		}
+
+		std::ofstream file(in_path, std::ios::trunc);
+		file << in_writer.GetText() << "\n";
+		if (!file) {
+			/// TODO
+			/// Handle error: failed to write report
+			/// Output to console
+			std::cerr << "Error: Failed to write report: " << in_path << "\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	double Median(std::vector<double>& io_samples) {
+		return Percentile(io_samples, 50.0);
+	}
+
+	double Percentile(std::vector<double>& io_samples, double in_percentile) {
+		if (io_samples.empty()) {
+			return 0.0;
+		}
+
+		// Nearest rank
+		size_t rank = static_cast<size_t>(std::ceil(in_percentile / 100.0 * io_samples.size()));
+		size_t index = std::min(io_samples.size() - 1, rank > 0 ? rank - 1 : 0);
+		std::nth_element(io_samples.begin(), io_samples.begin() + static_cast<std::ptrdiff_t>(index), io_samples.end());
+		return io_samples[index];
+	}
+
+} // namespace flakpak::bench
@@ -0,0 +1,74 @@
+-- Some preprocessor directives for the Lua language
+---@diagnostic disable: lowercase-global
+---@diagnostic disable: undefined-global
+
+-- Benchmarks, they build the flakpak sources without the CLI entry point
+-- and add their own. Run on the Linux build hosts:
+--   flakbench-pack -o pack.json
+--   flakbench-read -o read.json
+local function benchproject(in_name, in_targetName, in_main)
+project(in_name)
+    kind "ConsoleApp"
+
+    targetname(in_targetName)
+
+    location(wsdir.. "/bench")
+    targetdir(wsdir.. outputdir)
+    objdir(wsdir.. outputdir.. "/obj_output")
+
+    language "C++"
+    cppdialect "C++20"
+
+    files {
+        wsdir.. "/paker/src/**.cpp",
+        wsdir.. "/paker/include/**.hpp",
+        wsdir.. "/bench/src/**.cpp",
+        wsdir.. "/bench/include/**.hpp",
+        wsdir.. in_main,
+    }
+    removefiles {
+        wsdir.. "/paker/src/main.cpp",
+    }
+    includedirs {
+        wsdir.. "/paker/include/",
+        wsdir.. "/bench/include/",
+        wsdir.. "/vendor/include"
+    }
+    libdirs {
+        wsdir.. "/vendor/lib",
+    }
+
+    vpaths {
+        ["Source Files/*"] = { wsdir.. "/paker/src/**.cpp", wsdir.. "/bench/src/**.cpp", wsdir.. in_main },
+
+        ["Header Files/*"] = { wsdir.. "/paker/include/**.hpp", wsdir.. "/bench/include/**.hpp" },
+    }
+
+    filter "system:windows"
+        links {
+            "libzstd_static.lib", -- Compression Library
+            "libsodium.lib" -- Encryption Library
+        }
+
+    filter "system:linux"
+        links {
+            "zstd",
+            "sodium",
+            "pthread"
+        }
+
+    filter "configurations:Release"
+        defines {
+            "NDEBUG",
+            "PAK_RELEASE"
+        }
+        runtime "Release"
+
+        symbols "on"
+        optimize "on"
+
+    filter {}
+end
+
+benchproject("PackBench", "flakbench-pack", "/bench/pack/main.cpp")
+benchproject("ReadBench", "flakbench-read", "/bench/read/main.cpp")
@@ -0,0 +1,114 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_BatchReader.hpp - flak_BatchReader.cpp]
+//
+// Description: Loads a list of entries of an open FLKArchiveReader in one
+//              go. The blobs of the entries are sorted by offset and merged
+//              into a few large reads, which are all queued at once (io_uring
+//              on Linux, a pool of positional reads elsewhere). Every entry is
+//              decoded by a worker as soon as the reads it needs completed.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKReader.hpp>	- flakpak API
+//
+//  - <functional> - C++ Standard Library
+//  - <vector>     - C++ Standard Library
+//  - <cstdint>    - C++ Standard Library
+//
+// Notes:
+//  - io_uring is driven through its raw system calls, no liburing needed.
+//    When the kernel refuses it (old kernel, seccomp, container) the reads
+//    fall back to the positional read pool without any error.
+//  - The callback runs on the decode workers, several entries can be
+//    reported at the same time and in any order.
+//  - Reads are buffered (no O_DIRECT). The chunks of chunked entries are
+//    planned like any other blob and decoded from the read buffers.
+//  - The reader is only used through its const methods, it must stay open
+//    and untouched until ReadEntries() returns.
+//
+// ===========================================================================
+#ifndef FLAK_BATCH_READER_HPP
+#define FLAK_BATCH_READER_HPP
+
+#include <flakpak/flak_FLKReader.hpp>
+
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+
+namespace flakpak::io {
+	static constexpr uint64_t FLK_BATCH_MERGE_GAP = 64 * 1024;		// Largest hole read through to merge two blobs
+	static constexpr uint64_t FLK_BATCH_MAX_READ = 8 * 1024 * 1024;	// Largest merged read
+	static constexpr uint32_t FLK_BATCH_QUEUE_DEPTH = 64;				// Reads in flight at once
+	static constexpr size_t FLK_BATCH_READ_THREADS = 4;				// Positional read threads without io_uring
+
+	// Receives an entry loaded by BatchReader::ReadEntries()
+	//    @param in_index		 - Entry index in the archive
+	//	  @param in_data			 - Entry bytes, only valid during the call (nullptr if in_size is 0 or on failure)
+	//	  @param in_size			 - Size of the entry
+	//	  @param in_success		 - false if the entry could not be read or decoded
+	using FLKEntryCallback = std::function<void(size_t in_index, const uint8_t* in_data, uint64_t in_size, bool in_success)>;
+
+	class BatchReader final {
+	public:
+		// @param in_workerCount - Number of decode workers, 0 picks the hardware concurrency
+		explicit BatchReader(size_t in_workerCount = 0);
+		~BatchReader() = default;
+
+		BatchReader(const BatchReader&) = delete;
+		BatchReader& operator=(const BatchReader&) = delete;
+
+		// Loads every entry of in_indices and reports each one to in_callback
+		//    @param in_reader		 - Open archive
+		//	  @param in_indices		 - Entries to load [0, GetEntryCount()), in any order
+		//	  @param in_callback		 - Called once per listed entry, from the decode workers
+		//
+		//	  @return bool			 - false if an index is invalid or any entry failed
+		bool ReadEntries(const FLKArchiveReader& in_reader, const std::vector<size_t>& in_indices, const FLKEntryCallback& in_callback);
+
+		[[nodiscard]] size_t GetWorkerCount() const;
+		// Statistics of the last ReadEntries() call
+		[[nodiscard]] size_t GetReadCount() const;
+		[[nodiscard]] uint64_t GetBytesRead() const;
+		[[nodiscard]] bool UsedIoUring() const;
+
+	private:
+		size_t m_workerCount { 1 };
+		size_t m_readCount { 0 };
+		uint64_t m_bytesRead { 0 };
+		bool m_usedIoUring { false };
+
+	}; // class BatchReader final
+
+} // namespace flakpak::io
+
+#endif // !FLAK_BATCH_READER_HPP
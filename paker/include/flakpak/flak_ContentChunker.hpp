@@ -0,0 +1,89 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_ContentChunker.hpp - flak_ContentChunker.cpp]
+//
+// Description: Content-defined chunking (FastCDC). Data is cut where a Gear
+//              rolling hash matches a mask, so an insertion or a removal only
+//              moves the boundaries around it and unchanged regions of two
+//              files still produce the same chunks.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <vector>  - C++ Standard Library
+//  - <cstdint> - C++ Standard Library
+//
+// Notes:
+//  - Chunks are between a quarter and four times the average size. Normalized
+//    chunking is used: a stricter mask before the average size and a looser
+//    one after it, which keeps most chunks close to the average.
+//  - The Gear table is fixed, the same data always gives the same chunks
+//    on every platform and in every archive.
+//
+// ===========================================================================
+#ifndef FLAK_CONTENT_CHUNKER_HPP
+#define FLAK_CONTENT_CHUNKER_HPP
+
+#include <vector>
+#include <cstdint>
+
+
+namespace flakpak::dedup {
+	class ContentChunker final {
+	public:
+		// @param in_averageSize - Target chunk size, rounded down to a power of two
+		explicit ContentChunker(uint64_t in_averageSize);
+		~ContentChunker() = default;
+
+		// Size of the chunk starting at in_data
+		//    @param in_data			 - Remaining data
+		//	  @param in_size			 - Size of the remaining data in bytes
+		//
+		//	  @return uint64_t		 - Chunk size, in_size when the data ends first
+		uint64_t NextChunk(const uint8_t* in_data, uint64_t in_size) const;
+		// Splits a whole buffer into chunks
+		//    @param out_sizes		 - Size of every chunk, in order
+		void Split(const uint8_t* in_data, uint64_t in_size, std::vector<uint32_t>& out_sizes) const;
+
+		[[nodiscard]] uint64_t GetMinSize() const;
+		[[nodiscard]] uint64_t GetAverageSize() const;
+		[[nodiscard]] uint64_t GetMaxSize() const;
+
+	private:
+		uint64_t m_minSize { 0 };
+		uint64_t m_averageSize { 0 };
+		uint64_t m_maxSize { 0 };
+		uint64_t m_maskSmall { 0 };		// Used before the average size, one bit more than the average
+		uint64_t m_maskLarge { 0 };		// Used after the average size, one bit less than the average
+
+	}; // class ContentChunker final
+
+} // namespace flakpak::dedup
+
+#endif // !FLAK_CONTENT_CHUNKER_HPP
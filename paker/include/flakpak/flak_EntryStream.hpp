@@ -0,0 +1,149 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_EntryStream.hpp - flak_EntryStream.cpp]
+//
+// Description: Pull-based sequential reader over one entry of an open
+//              FLKArchiveReader. The caller asks for the next bytes with a
+//              buffer of any size, the packed data is decrypted one
+//              secretstream chunk at a time and fed to ZSTD_decompressStream
+//              only as far as needed to fill that buffer. Playback of a large
+//              track can start after its first chunk instead of after the
+//              whole entry was decoded.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKReader.hpp>		- flakpak API
+//  - <flakpak/zstd_Compressor.hpp>		- flakpak API
+//  - <flakpak/xccp20_Encryptor.hpp>	- flakpak API
+//
+//  - <span>    - C++ Standard Library
+//  - <vector>  - C++ Standard Library
+//  - <cstdint> - C++ Standard Library
+//
+// Notes:
+//  - Memory does not depend on the entry size: one decrypted chunk (64 KiB),
+//    the zstd window of the frame and a small discard buffer for seeks.
+//  - Frames and chunks are read one after the other, Seek() restarts at the
+//    frame or chunk holding the target and decodes up to it. Seeking in a
+//    single-frame or solid entry decodes from the start of the blob.
+//  - Solid members are decoded from the start of their block without the
+//    block cache, the bytes before the member are discarded.
+//  - The reader is only used through its const methods, it must stay open
+//    while the stream is in use. One stream per thread.
+//
+// ===========================================================================
+#ifndef FLAK_ENTRY_STREAM_HPP
+#define FLAK_ENTRY_STREAM_HPP
+
+#include <flakpak/flak_FLKReader.hpp>
+#include <flakpak/zstd_Compressor.hpp>
+#include <flakpak/xccp20_Encryptor.hpp>
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+
+namespace flakpak::io {
+	static constexpr size_t FLK_STREAM_DISCARD_SIZE = 64 * 1024;	// Decoded bytes thrown away per step while seeking
+
+	class EntryStream final {
+	public:
+		EntryStream() = default;
+		~EntryStream() = default;
+
+		EntryStream(const EntryStream&) = delete;
+		EntryStream& operator=(const EntryStream&) = delete;
+
+		// Starts streaming an entry from its first byte
+		//    @param in_reader		 - Open archive, must outlive the stream
+		//	  @param in_index		 - Entry index [0, GetEntryCount())
+		//
+		//	  @return bool			 - false if the index is invalid or the first blob cannot be read
+		bool Open(const FLKArchiveReader& in_reader, size_t in_index);
+		// Decodes the next bytes of the entry
+		//    @param out_data		 - Receives up to out_data.size() bytes
+		//	  @param out_read		 - Number of bytes written, smaller than out_data.size() only at the end
+		//
+		//	  @return bool			 - false if the data is corrupted (the stream then has to be reopened)
+		bool Read(std::span<uint8_t> out_data, size_t& out_read);
+		// Moves the read position
+		//    @param in_offset		 - New position [0, GetSize()]
+		//
+		//	  @return bool			 - false if in_offset is past the end of the entry
+		bool Seek(uint64_t in_offset);
+		void Close();
+
+		[[nodiscard]] bool IsOpen() const;
+		[[nodiscard]] uint64_t GetSize() const;
+		[[nodiscard]] uint64_t GetPosition() const;
+		[[nodiscard]] bool IsEnd() const;
+
+	private:
+		// Starts decoding frame, chunk or blob in_segment of the entry
+		bool OpenSegment(size_t in_segment);
+		// Checks the current segment was decoded to its end
+		bool FinishSegment();
+		// Decodes at least one byte of the current segment into out_data
+		bool Produce(std::span<uint8_t> out_data, size_t& out_size);
+		// Moves to the next decrypted chunk (or the end) of an exhausted input
+		bool RefillInput();
+
+		const FLKArchiveReader* m_reader { nullptr };
+		FLK_PACKED_ENTRY m_entry;
+		bool m_solid { false };
+		std::span<const uint8_t> m_solidBlob;		// Packed solid block of a solid member
+		uint64_t m_solidBaseSize { 0 };
+		uint64_t m_solidOffset { 0 };
+		uint64_t m_size { 0 };
+		uint64_t m_position { 0 };
+		size_t m_segmentCount { 0 };
+
+		// Current segment
+		size_t m_segment { 0 };
+		bool m_segmentOpen { false };
+		bool m_compressed { false };
+		bool m_encrypted { false };
+		bool m_inputDone { false };
+		std::span<const uint8_t> m_packed;			// Whole segment blob in the mapping
+		std::span<const uint8_t> m_input;			// Plain (decrypted) bytes waiting for the decompressor
+		uint64_t m_segmentSize { 0 };				// Decoded size of the segment
+		uint64_t m_segmentDecoded { 0 };
+		uint64_t m_skip { 0 };						// Decoded bytes to discard before m_position
+
+		compression::zstd::ZstdStreamDecompressor m_decompressor;
+		encryption::xccp20::XChaCha20Poly1305StreamDecryptor m_decryptor;
+		std::vector<uint8_t> m_discard;
+
+	}; // class EntryStream final
+
+} // namespace flakpak::io
+
+#endif // !FLAK_ENTRY_STREAM_HPP
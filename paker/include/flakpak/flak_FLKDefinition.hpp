@@ -31,8 +31,8 @@
 //				Also includes other data type definitions used across the application.
 //
 // Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
-// Date: 15.09.2025
-// Version: 1.0.1
+// Date: 17.10.2026
+// Version: 1.2.0
 //
 // ---------------------------------------------------------------------------
 // Dependencies:
@@ -40,6 +40,8 @@
 //  - <array>   - C++ Standard Library
 //  - <string>  - C++ Standard Library
 //  - <vector>   - C++ Standard Library
+//  - <filesystem> - C++ Standard Library
+//  - <functional> - C++ Standard Library
 //
 // Notes:
 //  - [Any important implementation notes]
@@ -54,15 +56,71 @@
 #include <array>
 #include <string>
 #include <vector>
+#include <filesystem>
+#include <functional>
 
 
 namespace flakpak {
 	static constexpr size_t MAX_FLK_HEADER_ENTRIES = 256;	// Maximum number of entries in the FLK file
 	static constexpr size_t MAX_FILE_PATH_LENGTH = 128;		// Maximum length for file paths
-	static constexpr size_t MAX_FILE_SIZE = 1ULL << 30;		// Maximum file size (1 GB)
+	static constexpr uint8_t FLK_FORMAT_VERSION_1 = 1;			// Fixed FLKHeader holding MAX_FLK_HEADER_ENTRIES entries
+	static constexpr uint8_t FLK_FORMAT_VERSION_2 = 2;			// FLKHeaderV2 followed by variable-length entry and string tables
+	static constexpr size_t FLK_ENCRYPTION_CHUNK_SIZE = 1 << 16;		// Plaintext bytes per secretstream chunk (64 KiB)
+	static constexpr uint64_t FLK_STREAM_ENTRY_THRESHOLD = 1ULL << 26;	// Entries above this size are packed in constant memory (64 MiB)
+	static constexpr uint64_t FLK_ZSTD_LARGE_INPUT_THRESHOLD = 1ULL << 25;	// Inputs from this size on use the large input zstd parameters (32 MiB)
+
+	static constexpr size_t FLK_SALT_SIZE = 16;				// Size of the global Argon2id salt
+	static constexpr size_t FLK_KEY_SIZE = 32;				// Size of the archive master key and entry subkeys
+	static constexpr uint64_t FLK_KDF_MAX_OPSLIMIT = 32;		// Most Argon2id passes accepted from an archive
+	static constexpr uint64_t FLK_KDF_MAX_MEMLIMIT = 1ULL << 30;	// Most Argon2id memory accepted from an archive (SENSITIVE)
 
 	static constexpr uint8_t FLK_PADDING_PATTERN = 0xCC;
 	static constexpr uint64_t FLK_PADDING_PATTERN_64 = 0xCCCCCCCCCCCCCCCC;
+
+	// Archive flags stored in the FLKFooter
+	static constexpr uint32_t FLK_FLAG_COMPRESSED = 1u << 0;		// Entries are zstd compressed
+	static constexpr uint32_t FLK_FLAG_ENCRYPTED = 1u << 1;			// Entries are XChaCha20-Poly1305 encrypted
+	static constexpr uint32_t FLK_FLAG_COMPRESSED_PATHS = 1u << 2;	// Entry paths use PathCompressor substitutions
+	static constexpr uint32_t FLK_FLAG_STREAMED = 1u << 3;			// Header is stored in the trailer (see FLKStreamPreamble)
+	static constexpr uint32_t FLK_FLAG_CHUNKED_ENCRYPTION = 1u << 4;	// Entries use chunked secretstream encryption
+	static constexpr uint32_t FLK_FLAG_SECTIONS = 1u << 5;			// An FLKSectionDirectory precedes the footer
+	static constexpr uint32_t FLK_FLAG_SOLID = 1u << 6;				// Some entries are stored inside shared solid blocks
+	static constexpr uint32_t FLK_FLAG_FRAMED = 1u << 7;			// Some entries are split into independently decodable frames
+	static constexpr uint32_t FLK_FLAG_ENTRY_CODECS = 1u << 8;		// Some entries use another codec than the archive one (see FLKEntryInfo::codec)
+	static constexpr uint32_t FLK_FLAG_CHUNKED = 1u << 9;			// Some entries are lists of chunks from the chunk store
+	static constexpr uint32_t FLK_FLAG_PATH_INDEX = 1u << 10;		// A perfect hash path index section is stored
+	static constexpr uint32_t FLK_FLAG_CHECKSUMS = 1u << 11;		// Per-entry checksums of the original and packed bytes are stored
+
+	// Section types (see FLKSection)
+	static constexpr uint32_t FLK_SECTION_ENTRY_INFO = 1;			// FLKEntryInfoTable followed by one FLKEntryInfo per entry
+	static constexpr uint32_t FLK_SECTION_DICTIONARY = 2;			// zstd dictionary, the section id is the dictionary id
+	static constexpr uint32_t FLK_SECTION_SOLID_BLOCKS = 3;			// One FLKSolidBlock per solid block, in block index order
+	static constexpr uint32_t FLK_SECTION_FRAMES = 4;				// Seek tables, FLKFrame records of every framed entry back to back
+	static constexpr uint32_t FLK_SECTION_CHUNKS = 5;				// Chunk store, one FLKChunk per distinct chunk
+	static constexpr uint32_t FLK_SECTION_CHUNK_REFS = 6;			// uint32_t chunk indices of every chunked entry back to back
+	static constexpr uint32_t FLK_SECTION_PATH_INDEX = 7;			// FLKPathIndex followed by the pilots, path hashes and entry indices
+	static constexpr uint32_t FLK_SECTION_CHECKSUMS = 8;			// FLKChecksumTable followed by one FLKEntryChecksum per entry
+
+	// Section flags
+	static constexpr uint32_t FLK_SECTION_FLAG_ENCRYPTED = 1u << 0;	// Payload is encrypted like an entry blob
+
+	static constexpr uint32_t FLK_NO_DICTIONARY = 0;				// Entry compressed without a dictionary
+	static constexpr uint32_t FLK_NOT_SOLID = 0xFFFFFFFF;			// Entry stored in its own blob
+	static constexpr size_t FLK_NOT_DUPLICATE = static_cast<size_t>(-1);	// Pack job whose content is not a copy of an earlier one
+	static constexpr size_t FLK_ENTRY_NOT_FOUND = static_cast<size_t>(-1);	// Returned by path lookups when no entry has the path
+	static constexpr uint32_t FLK_PATH_INDEX_EMPTY_SLOT = 0xFFFFFFFF;	// Entry index of the path index slots no path maps to
+
+	// Entry codecs (FLKEntryInfo::codec)
+	static constexpr uint32_t FLK_CODEC_ARCHIVE = 0;				// Codec given by the archive flags (zstd if FLK_FLAG_COMPRESSED)
+	static constexpr uint32_t FLK_CODEC_STORED = 1;					// Data stored as is (still encrypted in encrypted archives)
+	static constexpr uint32_t FLK_CODEC_ZSTD = 2;					// Data is a zstd frame
+
+	// Checksum algorithms (FLKChecksumTable::algorithm)
+	static constexpr uint32_t FLK_CHECKSUM_XXH3_64 = 1;				// 64-bit XXH3, seed 0 (checksum::xxh3::Xxh3Hasher)
+
+	// Receives data produced incrementally (compressed, encrypted or decoded bytes)
+	//    @return bool - false to stop the producer
+	using FLKDataSink = std::function<bool(const uint8_t* in_data, size_t in_size)>;
 }
 
 namespace flakpak::data_types {
@@ -77,7 +135,7 @@ namespace flakpak::data_types {
 
 	struct FLKHeader {
 		std::array<char, 4> magic { {'F', 'L', 'K', '\0'} };			// Magic number to identify FLK files
-		uint8_t version { 1 };											// FLK file format version
+		uint8_t version { FLK_FORMAT_VERSION_1 };							// FLK file format version
 		uint16_t reserved{ 0xABCD }; 									// Reserved for future use
 		uint32_t saltLen { 0 };											// Length of the global salt (0 if no salt)
 		uint32_t contentVersion { 0 };									// User-defined content version
@@ -85,6 +143,177 @@ namespace flakpak::data_types {
 		std::array<FLKEntry, MAX_FLK_HEADER_ENTRIES> entries {};		// Fixed-size array of entries
 
 	}; // FLKHeader
+
+	// Version 2 header, the first fields match FLKHeader so the version can
+	// be read before knowing the layout. Version 2 archives always use the
+	// streamed layout: an FLKStreamPreamble (version 2) at byte 0 and the
+	// header region in the trailer, made of this header, the salt and KDF
+	// parameters (if encrypted) and the packed tables. Once unpacked the
+	// tables are entryCount FLKEntryRecord followed by the string table.
+	struct FLKHeaderV2 {
+		std::array<char, 4> magic { {'F', 'L', 'K', '\0'} };			// Magic number to identify FLK files
+		uint8_t version { FLK_FORMAT_VERSION_2 };						// FLK file format version
+		uint16_t reserved { 0xABCD };									// Reserved for future use
+		uint32_t saltLen { 0 };											// Length of the global salt (0 if no salt)
+		uint32_t contentVersion { 0 };									// User-defined content version
+		uint32_t entryCount { 0 };										// Number of FLKEntryRecord in the entry table
+		uint32_t stringTableSize { 0 };									// Size of the string table once unpacked
+		uint32_t tableCodec { FLK_CODEC_STORED };						// FLK_CODEC_STORED or FLK_CODEC_ZSTD (one frame for both tables)
+		uint64_t tableSize { 0 };										// Size of the packed tables
+
+	}; // FLKHeaderV2
+
+	// Entry of the version 2 entry table. Paths are split into a directory
+	// and a file name, both null-terminated strings of the string table
+	// stored once however many entries use them. The path of an entry is
+	// "directory/name", or "name" when the directory is empty.
+	struct FLKEntryRecord {
+		uint64_t offset { 0 };											// Offset of the file data in the FLK file
+		uint64_t baseSize { 0 };										// Original size of the file before compression/encryption
+		uint64_t packedSize { 0 };										// Size of the file after compression/encryption
+		uint32_t directory { 0 };										// String table offset of the directory ('/' separated)
+		uint32_t name { 0 };											// String table offset of the file name
+
+	}; // FLKEntryRecord
+
+	// Argon2id parameters used to derive the archive master key. When the
+	// header saltLen is not 0 the header is followed by the salt and then
+	// by this structure, blob data starts right after it.
+	struct FLKKdfParams {
+		uint64_t opsLimit { 0 };										// Argon2id operations limit
+		uint64_t memLimit { 0 };										// Argon2id memory limit in bytes
+		uint32_t algorithm { 0 };										// crypto_pwhash algorithm identifier
+		uint32_t reserved { 0xCCCCCCCC };								// Reserved for future use
+
+	}; // FLKKdfParams
+
+	// Written at byte 0 of streamed archives instead of the FLKHeader.
+	// Blobs follow right after it and the FLKHeader (with absolute offsets)
+	// is written in the trailer, located through the FLKFooter.
+	struct FLKStreamPreamble {
+		std::array<char, 4> magic { {'F', 'L', 'K', 'S'} };			// Magic number to identify streamed FLK files
+		uint8_t version { FLK_FORMAT_VERSION_1 };							// FLK file format version
+		std::array<uint8_t, 3> reserved { {0xCC, 0xCC, 0xCC} };		// Reserved for future use
+
+	}; // FLKStreamPreamble
+
+	// Fixed-size footer at the very end of the archive
+	struct FLKFooter {
+		uint64_t headerOffset { 0 };									// Offset of the FLKHeader (0 unless streamed)
+		uint64_t headerSize { 0 };										// Size of the header region (header, salt and KDF params)
+		uint32_t flags { 0 };											// FLK_FLAG_* values
+		std::array<char, 4> magic { {'F', 'L', 'K', 'F'} };			// Magic number to identify the footer
+
+	}; // FLKFooter
+
+	// Optional archive data stored outside of the entry blobs (dictionaries,
+	// per-entry tables, ...). Readers skip the section types they do not know.
+	struct FLKSection {
+		uint32_t type { 0 };											// FLK_SECTION_* value
+		uint32_t id { 0 };												// Identifier within the type (dictionary id, ...)
+		uint64_t offset { 0 };											// Absolute offset of the payload
+		uint64_t size { 0 };											// Size of the payload as stored
+		uint32_t flags { 0 };											// FLK_SECTION_FLAG_* values
+		uint32_t reserved { 0xCCCCCCCC };								// Reserved for future use
+
+	}; // FLKSection
+
+	// Written right before the FLKFooter when FLK_FLAG_SECTIONS is set,
+	// points at the array of FLKSection records
+	struct FLKSectionDirectory {
+		uint64_t offset { 0 };											// Absolute offset of the FLKSection array
+		uint32_t count { 0 };											// Number of FLKSection records
+		std::array<char, 4> magic { {'F', 'L', 'K', 'D'} };			// Magic number to identify the directory
+
+	}; // FLKSectionDirectory
+
+	// Start of the FLK_SECTION_ENTRY_INFO payload. Records are stride bytes
+	// apart so fields can be appended to FLKEntryInfo without breaking readers.
+	struct FLKEntryInfoTable {
+		uint32_t stride { 0 };											// Size of one record (sizeof(FLKEntryInfo) when written)
+		uint32_t count { 0 };											// Number of records, one per entry in header order
+
+	}; // FLKEntryInfoTable
+
+	// Per-entry data that does not fit in the fixed FLKEntry
+	struct FLKEntryInfo {
+		uint32_t dictionaryId { FLK_NO_DICTIONARY };					// Dictionary used to compress the entry
+		uint32_t solidBlock { FLK_NOT_SOLID };							// Solid block holding the entry
+		uint64_t solidOffset { 0 };										// Offset of the entry in the decompressed block
+		uint32_t firstFrame { 0 };										// First FLKFrame of the entry in the seek tables
+		uint32_t frameCount { 0 };										// Number of frames (0 = single frame, not seekable)
+		uint32_t codec { FLK_CODEC_ARCHIVE };							// FLK_CODEC_* value of the entry data
+		uint32_t firstChunk { 0 };										// First chunk reference of the entry
+		uint32_t chunkCount { 0 };										// Number of chunk references (0 = not chunked)
+
+	}; // FLKEntryInfo
+
+	// Seek table record of a framed entry. Every frame is compressed and
+	// encrypted on its own, frame i covers the entry bytes [baseOffset,
+	// next baseOffset) and its packed data starts at packedOffset in the
+	// entry blob. The last frame ends with the entry.
+	struct FLKFrame {
+		uint64_t baseOffset { 0 };										// Offset of the frame in the original entry
+		uint64_t packedOffset { 0 };									// Offset of the frame in the entry blob
+
+	}; // FLKFrame
+
+	// Chunk store record. Chunked entries are cut at content-defined
+	// boundaries and every distinct chunk is packed once, as a blob of its
+	// own (compressed and encrypted like an entry). An entry is the
+	// concatenation of the chunks listed by its chunk references.
+	struct FLKChunk {
+		uint64_t offset { 0 };											// Absolute offset of the chunk blob
+		uint64_t packedSize { 0 };										// Size of the chunk blob
+		uint32_t baseSize { 0 };										// Size of the chunk data
+		uint32_t codec { FLK_CODEC_ARCHIVE };							// FLK_CODEC_* value of the chunk data
+
+	}; // FLKChunk
+
+	// Start of the FLK_SECTION_PATH_INDEX payload, a perfect hash index of
+	// the entry paths (hash and displace). The payload continues with three
+	// arrays: slotCount uint64_t path hashes (slot order), bucketCount
+	// uint32_t pilots and slotCount uint32_t entry indices (slot order).
+	// There are a few more slots than entries, unused slots hold the entry
+	// index FLK_PATH_INDEX_EMPTY_SLOT.
+	// A path hashing to h can only be in the slot picked by the pilot of
+	// bucket h % bucketCount, see pathcom::PathIndex::GetSlot().
+	struct FLKPathIndex {
+		uint32_t slotCount { 0 };										// Number of slots, at least one per entry
+		uint32_t bucketCount { 0 };										// Number of pilots
+		uint64_t seed { 0 };											// Seed of the path hash
+
+	}; // FLKPathIndex
+
+	// Start of the FLK_SECTION_CHECKSUMS payload, records are stride bytes
+	// apart like the entry info table. The packed checksum covers the bytes
+	// [offset, offset + packedSize) of the entry, so solid members share the
+	// one of their block and copies the one of their source. Chunked entries
+	// hash the array of the packed checksums of their chunks (reference
+	// order, little-endian uint64_t) instead.
+	struct FLKChecksumTable {
+		uint32_t stride { 0 };											// Size of one record (sizeof(FLKEntryChecksum) when written)
+		uint32_t count { 0 };											// Number of records, one per entry in header order
+		uint32_t algorithm { FLK_CHECKSUM_XXH3_64 };					// FLK_CHECKSUM_* value
+		uint32_t reserved { 0 };
+
+	}; // FLKChecksumTable
+
+	struct FLKEntryChecksum {
+		uint64_t base { 0 };											// Checksum of the original bytes
+		uint64_t packed { 0 };											// Checksum of the stored bytes
+
+	}; // FLKEntryChecksum
+
+	// A solid block packs several small entries into a single blob (one zstd
+	// frame). The FLKEntry of every member points at the block blob, the
+	// member bytes are found at solidOffset once the block is decompressed.
+	struct FLKSolidBlock {
+		uint64_t offset { 0 };											// Absolute offset of the block blob
+		uint64_t packedSize { 0 };										// Size of the block blob
+		uint64_t baseSize { 0 };										// Size of the decompressed block
+
+	}; // FLKSolidBlock
 #pragma pack(pop)
 
 	// Result structure for compression operations
@@ -95,6 +324,24 @@ namespace flakpak::data_types {
 
 	}; // FLK_COMPRESSION_RESULT
 
+	// Advanced zstd parameters applied to large inputs only, small inputs
+	// are compressed with the compression level alone. 0 keeps the value
+	// picked by the compression level.
+	struct FLK_ZSTD_PARAMS {
+		uint64_t largeInputThreshold{ FLK_ZSTD_LARGE_INPUT_THRESHOLD };	// Inputs at least this large use the parameters below
+		int workerCount{};				// ZSTD_c_nbWorkers, zstd compresses on its own threads (0 = calling thread)
+		int jobSize{};					// ZSTD_c_jobSize, input bytes per zstd worker job
+		bool longDistanceMatching{ false };	// ZSTD_c_enableLongDistanceMatching (window of 128 MiB unless windowLog is set)
+		int windowLog{};				// ZSTD_c_windowLog
+		int chainLog{};					// ZSTD_c_chainLog
+		int hashLog{};					// ZSTD_c_hashLog
+		int searchLog{};				// ZSTD_c_searchLog
+		int minMatch{};					// ZSTD_c_minMatch
+		int targetLength{};				// ZSTD_c_targetLength
+		int strategy{};					// ZSTD_c_strategy (1 = fast ... 9 = btultra2)
+
+	}; // FLK_ZSTD_PARAMS
+
 	// Result structure for encryption operations
 	struct FLK_ENCRYPTION_RESULT {
 		std::vector<uint8_t> data;
@@ -103,6 +350,44 @@ namespace flakpak::data_types {
 
 	}; // FLK_ENCRYPTION_RESULT
 
+	// Source file scheduled to be packed
+	struct FLK_PACK_JOB {
+		std::filesystem::path sourcePath{};	// Path of the file on disk
+		std::string relPath{};			// Path relative to the packed directory
+		std::string entryPath{};		// Path stored in the entry (may be substitution-compressed)
+		uint64_t fileSize{};			// Size of the file on disk
+		bool streamed{ false };			// Packed by the committer straight into the archive (large files)
+		uint32_t dictionaryId{ FLK_NO_DICTIONARY };	// Trained dictionary used to compress the entry
+		uint32_t solidBlock{ FLK_NOT_SOLID };	// Solid block the entry is packed into
+		uint64_t solidOffset{};			// Offset of the entry in its solid block
+		uint32_t codec{ FLK_CODEC_ARCHIVE };	// Codec picked from the extension, may become stored once the data is seen
+		size_t duplicateOf{ FLK_NOT_DUPLICATE };	// Earlier job with the same content, the entry shares its blob
+		bool chunked{ false };			// Split into content-defined chunks stored in the chunk store
+
+	}; // FLK_PACK_JOB
+
+	// Distinct chunk scheduled to be packed in the chunk store
+	struct FLK_CHUNK_JOB {
+		size_t jobIndex{};				// Job of the first entry holding the chunk
+		uint64_t offset{};				// Offset of the chunk in that entry
+		uint32_t size{};				// Size of the chunk
+
+	}; // FLK_CHUNK_JOB
+
+	// Result structure for a single entry processed by the pack pipeline
+	struct FLK_PACK_RESULT {
+		std::vector<uint8_t> data{};	// Packed blob ready to be written
+		uint64_t baseSize{};			// Original size of the file
+		std::vector<FLKFrame> frames{};	// Seek table of the blob when it was split into frames
+		uint32_t codec{ FLK_CODEC_ARCHIVE };	// Codec the blob was packed with
+		uint64_t baseChecksum{};		// Checksum of the original bytes (FLK_CHECKSUM_XXH3_64)
+		uint64_t packedChecksum{};		// Checksum of the packed blob
+		std::vector<uint64_t> memberChecksums{};	// Checksums of the original bytes of every solid block member
+		bool failed{ false };			// Set when the entry could not be processed
+		std::string error{};			// Reason of the failure (if any)
+
+	}; // FLK_PACK_RESULT
+
 } // namespace flakpak::data_types
 
 #endif // !FLAK_FLK_DEFINITION_HPP
\ No newline at end of file
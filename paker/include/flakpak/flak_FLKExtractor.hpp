@@ -0,0 +1,121 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_FLKExtractor.hpp - flak_FLKExtractor.cpp]
+//
+// Description: Unpacks an FLK archive into a directory. The archive is opened
+//              once, then a pool of workers decodes the selected entries and
+//              writes them with positional writes. Large framed or chunked
+//              entries are split in slices so several workers can fill the
+//              same output file.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKDefinition.hpp>	- flakpak API data types
+//  - <flakpak/flak_FLKReader.hpp>		- flakpak API
+//
+//  - <filesystem>  - C++ Standard Library
+//  - <string>      - C++ Standard Library
+//  - <string_view> - C++ Standard Library
+//  - <vector>      - C++ Standard Library
+//
+// Notes:
+//  - Filters are matched against the '/' separated entry path, '*' matches
+//    any run of characters (including '/') and '?' a single one.
+//  - Entry paths that are absolute, rooted, contain ".." or a backslash are
+//    refused, nothing is ever written outside of the output directory.
+//  - Slices are only used when a slice can be decoded on its own (stored
+//    entries, several frames or several chunks), single-frame entries are
+//    always decoded by one worker.
+//
+// ===========================================================================
+#ifndef FLAK_FLK_EXTRACTOR_HPP
+#define FLAK_FLK_EXTRACTOR_HPP
+
+#include <flakpak/flak_FLKDefinition.hpp>
+#include <flakpak/flak_FLKReader.hpp>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace flakpak {
+	static constexpr uint64_t FLK_EXTRACT_SLICE_SIZE = 64 << 20;	// Entries larger than this are written by several workers
+
+	// Options of FLKExtractor::ExtractArchive()
+	struct FLK_EXTRACT_OPTIONS {
+		size_t jobCount { 0 };				// Worker threads decoding and writing entries (0 = all cores)
+		std::vector<std::string> filters;	// Only extract entries matching one of these patterns (empty = everything)
+
+	}; // FLK_EXTRACT_OPTIONS
+
+	class FLKExtractor {
+	public:
+		FLKExtractor() = default;
+		~FLKExtractor() = default;
+
+		// Extracts the entries of an FLK archive into a directory
+		//    @param in_archivePath	 - Archive to extract
+		//	  @param in_outDir		 - Directory receiving the files, created if missing
+		//	  @param in_options		 - Worker count and path filters
+		//
+		//	  @return bool			 - false if the archive could not be opened or any entry failed
+		static bool ExtractArchive(const std::filesystem::path& in_archivePath, const std::filesystem::path& in_outDir, const FLK_EXTRACT_OPTIONS& in_options);
+
+		// Whether in_path matches a '*' and '?' wildcard pattern
+		static bool MatchesFilter(std::string_view in_path, std::string_view in_pattern);
+
+	private:
+		// One slice of an entry handled by a single worker
+		struct ExtractTask {
+			size_t entry { 0 };
+			uint64_t offset { 0 };
+			uint64_t length { 0 };
+			bool sliced { false };		// The output file was created beforehand and is shared with other tasks
+
+		}; // ExtractTask
+
+		// Rejects absolute or rooted paths, backslashes and paths escaping the output directory
+		static bool IsSafePath(std::string_view in_path);
+		// Whether slices of an entry can be decoded independently
+		static bool CanSlice(const io::FLKArchiveReader& in_reader, size_t in_index);
+		// Decodes a task and writes it at its offset in the output file
+		static bool RunTask(const io::FLKArchiveReader& in_reader,
+			const ExtractTask& in_task,
+			const std::filesystem::path& in_outPath,
+			io::FrameReader& io_frameReader,
+			io::SolidBlockCache& io_solidCache);
+
+	}; // class FLKExtractor
+
+} // namespace flakpak
+
+#endif // !FLAK_FLK_EXTRACTOR_HPP
@@ -30,8 +30,8 @@
 //              and FLK file format handling.
 //
 // Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
-// Date: 29.09.2025
-// Version: 1.0.3
+// Date: 17.10.2026
+// Version: 1.3.0
 //
 // ---------------------------------------------------------------------------
 // Dependencies:
@@ -40,12 +40,18 @@
 //  - <flakpak/xccp20_Encryptor.hpp>		 - flakpak API
 //  - <flakpak/flak_PasswordHandler.hpp>	 - flakpak API
 //	- <flakpak/flak_PathCompressor.hpp>		 - flakpak API
+//	- <flakpak/flak_PackPipeline.hpp>		 - flakpak API
+//	- <flakpak/flak_FLKWriter.hpp>			 - flakpak API
+//	- <flakpak/flak_MappedFile.hpp>			 - flakpak API
+//	- <flakpak/flak_ContentChunker.hpp>		 - flakpak API
+//	- <flakpak/xxh3_Hash.hpp>				 - flakpak API
 // 
 //  - <filesystem>   - C++ Standard Library
 //  - <cstring>      - C++ Standard Library
 //  - <memory>		 - C++ Standard Library
 //  - <iostream>	 - C++ Standard Library
-//  - <fstream>		 - C++ Standard Library
+//
+//  - <libsodium> - BLAKE2b content hashes used to find duplicate files
 //
 // Notes:
 //  - [Any important implementation notes]
@@ -57,38 +63,226 @@
 #define FLAK_FLK_PACKER_HPP
 
 #include <flakpak/flak_FLKDefinition.hpp>
+#include <flakpak/zstd_Compressor.hpp>
+#include <flakpak/xccp20_Encryptor.hpp>
+#include <flakpak/flak_FLKWriter.hpp>
 
 #include <filesystem>
 #include <cstring>
+#include <memory>
 
 
 namespace flakpak {
+	// How entries are grouped when training dictionaries
+	enum class FLK_DICTIONARY_GROUPING {
+		EXTENSION,		// One dictionary per file extension
+		DIRECTORY		// One dictionary per parent directory
+
+	}; // FLK_DICTIONARY_GROUPING
+
+	// Options shared by every packing mode
+	struct FLK_PACK_OPTIONS {
+		bool compress { false };		// Compress the entries with zstd
+		bool encrypt { false };			// Encrypt the entries with XChaCha20-Poly1305
+		int compressionLevel { 3 };		// zstd compression level (1-22)
+		size_t jobCount { 1 };			// Worker threads used to process entries (0 = all cores)
+		bool stream { false };			// Write the streamed layout (header in the trailer), forced for stdout/pipes
+		uint32_t kdfTargetMs { 0 };		// Calibrate Argon2id to take about this long (0 = libsodium MODERATE limits)
+		bool trainDictionaries { false };	// Train zstd dictionaries for groups of small entries (requires compress)
+		uint64_t solidBlockSize { 0 };	// Pack small entries into shared blocks of about this size (0 = off, requires compress)
+		uint64_t frameSize { 0 };		// Split larger entries into independently decodable frames of this size (0 = off)
+		bool detectCodec { true };		// Store entries that would not shrink (compressed formats, high entropy data) instead of compressing them
+		bool deduplicate { true };		// Entries with identical content share a single blob
+		uint64_t chunkSize { 0 };		// Split larger entries into content-defined chunks of about this size, each distinct chunk is stored once (0 = off)
+		uint64_t blobAlignment { 0 };	// Start every blob on a multiple of this power of two, padded with FLK_PADDING_PATTERN (0 = packed tightly)
+		uint8_t formatVersion { FLK_FORMAT_VERSION_1 };	// FLK_FORMAT_VERSION_1 (fixed 256 entry header at byte 0) or FLK_FORMAT_VERSION_2 (opt-in)
+		FLK_DICTIONARY_GROUPING dictionaryGrouping { FLK_DICTIONARY_GROUPING::EXTENSION };
+		data_types::FLK_ZSTD_PARAMS zstdParams;	// zstd workers, long distance matching and strategy for large entries
+
+	}; // FLK_PACK_OPTIONS
+
 	class FLKPacker {
 	public:
 		FLKPacker() = default;
 		~FLKPacker() = default;
 
+		// The Pack* modes below write format version 1 archives (FLKHeader at
+		// byte 0, at most 256 entries), use PackDirectory for version 2
+
 		// Packs all the files in the specified directory into an FLK file
 		// with no compression and no encryption
-		static bool PackUncompressedAndUnencrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath);
+		static bool PackUncompressedAndUnencrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, size_t in_jobCount = 1);
 		// Packs all the files in the specified directory into an FLK file
 		// with compression and no encryption
-		static bool PackCompressedAndUnencrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, int in_compressionLevel);
+		static bool PackCompressedAndUnencrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, int in_compressionLevel, size_t in_jobCount = 1);
 		// Packs all the files in the specified directory into an FLK file
 		// with no compression and with encryption
-		static bool PackUncompressedAndEncrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath);
+		static bool PackUncompressedAndEncrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, size_t in_jobCount = 1);
 		// Packs all the files in the specified directory into an FLK file
 		// with compression and with encryption
-		static bool PackCompressedAndEncrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, int in_compressionLevel);
+		static bool PackCompressedAndEncrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, int in_compressionLevel, size_t in_jobCount = 1);
+
+		// Packs all the files in the specified directory into an FLK file
+		// using the given options. Entries are read, compressed and encrypted
+		// by a pool of in_options.jobCount workers and written in path order,
+		// so the output layout does not depend on the number of jobs.
+		static bool PackDirectory(const std::filesystem::path& in_dirPath, const std::filesystem::path& in_outPath, const FLK_PACK_OPTIONS& in_options);
 
 	private:
-		static std::vector<uint8_t> ReadFileData(const std::filesystem::path& in_filePath);
 		static size_t CountFilesInDirectory(const std::filesystem::path& in_dirPath);
 
-		// Validates file path length and file size constraints in the FLK format
-		static bool ValidateFLKConstraints(const std::string& in_relPath, size_t in_fileSize);
+		// Scans the directory and builds the sorted list of files to pack
+		static bool CollectPackJobs(const std::filesystem::path& in_dirPath, const FLK_PACK_OPTIONS& in_options, std::vector<data_types::FLK_PACK_JOB>& out_jobs);
+
+		// Maps a file and packs it with PackData (or PackFrames when it is
+		// larger than the frame size), the mapped bytes are never copied into
+		// an intermediate buffer. Entries that would not shrink are stored.
+		//    @param in_job			 - Entry to pack
+		//	  @param in_options		 - Packing options
+		//	  @param in_session		 - Archive key session, used when encrypting
+		//	  @param in_dictionary	 - Dictionary of the entry, nullptr if it has none
+		//	  @param in_compressor	 - Compressor owned by the calling thread
+		//	  @param in_encryptor	 - Encryptor owned by the calling thread
+		//	  @param in_sink			 - Receives the packed blob
+		//	  @param out_frames		 - Seek table of the blob, empty if it was not split
+		//	  @param out_codec		 - Codec the blob was packed with (FLK_CODEC_*)
+		//	  @param out_baseChecksum - Checksum of the file bytes (FLK_CHECKSUM_XXH3_64)
+		//	  @param out_error		 - Reason of the failure
+		//
+		//	  @return bool			 - false if the entry could not be packed
+		static bool PackEntryData(const data_types::FLK_PACK_JOB& in_job,
+			const FLK_PACK_OPTIONS& in_options,
+			const encryption::xccp20::XChaCha20Poly1305KeySession& in_session,
+			const compression::zstd::ZstdDictionary* in_dictionary,
+			compression::zstd::ZstdStreamCompressor& in_compressor,
+			encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor,
+			const FLKDataSink& in_sink,
+			std::vector<data_types::FLKFrame>& out_frames,
+			uint32_t& out_codec,
+			uint64_t& out_baseChecksum,
+			std::string& out_error);
+		// Packs data as a sequence of frames of in_options.frameSize bytes,
+		// each compressed and encrypted on its own, and builds its seek table
+		static bool PackFrames(const uint8_t* in_data, uint64_t in_size,
+			const FLK_PACK_OPTIONS& in_options,
+			const encryption::xccp20::XChaCha20Poly1305KeySession& in_session,
+			const compression::zstd::ZstdDictionary* in_dictionary,
+			compression::zstd::ZstdStreamCompressor& in_compressor,
+			encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor,
+			const FLKDataSink& in_sink,
+			std::vector<data_types::FLKFrame>& out_frames,
+			std::string& out_error);
+		// Packs a chunk of the chunk store, stored when it does not shrink
+		//    @param out_codec		 - Codec the chunk was packed with (FLK_CODEC_*)
+		static bool PackChunk(const std::vector<data_types::FLK_PACK_JOB>& in_jobs,
+			const data_types::FLK_CHUNK_JOB& in_chunk,
+			const FLK_PACK_OPTIONS& in_options,
+			const encryption::xccp20::XChaCha20Poly1305KeySession& in_session,
+			compression::zstd::ZstdStreamCompressor& in_compressor,
+			encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor,
+			const FLKDataSink& in_sink,
+			uint32_t& out_codec,
+			std::string& out_error);
+		// Concatenates the members of a solid block and packs them as one blob
+		//    @param out_baseSize	 - Size of the decompressed block
+		//	  @param out_memberChecksums - Checksum of every member, in in_members order
+		static bool PackSolidBlock(const std::vector<data_types::FLK_PACK_JOB>& in_jobs,
+			const std::vector<size_t>& in_members,
+			const FLK_PACK_OPTIONS& in_options,
+			const encryption::xccp20::XChaCha20Poly1305KeySession& in_session,
+			compression::zstd::ZstdStreamCompressor& in_compressor,
+			encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor,
+			const FLKDataSink& in_sink,
+			uint64_t& out_baseSize,
+			std::vector<uint64_t>& out_memberChecksums,
+			std::string& out_error);
+		// Pushes data through the compressor and the encryptor (when enabled)
+		// into in_sink. Data that fits in memory is compressed in one shot,
+		// in_incremental streams it instead so the output is never held whole.
+		// When out_stored is set, one-shot data that does not shrink enough is
+		// passed on as is and *out_stored tells so.
+		static bool PackData(const uint8_t* in_data, uint64_t in_size, bool in_incremental,
+			const FLK_PACK_OPTIONS& in_options,
+			const encryption::xccp20::XChaCha20Poly1305KeySession& in_session,
+			const compression::zstd::ZstdDictionary* in_dictionary,
+			compression::zstd::ZstdStreamCompressor& in_compressor,
+			encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor,
+			const FLKDataSink& in_sink,
+			std::string& out_error,
+			bool* out_stored = nullptr);
+
+		// Codec of an entry from its extension alone, known compressed
+		// formats (images, audio, video, archives) are presumed stored
+		static uint32_t SelectCodec(const data_types::FLK_PACK_JOB& in_job, const FLK_PACK_OPTIONS& in_options);
+		// Estimates from a few samples whether zstd shrinks the data enough to
+		// be worth decoding: byte entropy first, then a fast trial compression
+		// (skipped for known compressed formats, the entropy is enough there)
+		static bool IsWorthCompressing(const uint8_t* in_data, uint64_t in_size, bool in_compressedFormat,
+			compression::zstd::ZstdStreamCompressor& in_compressor);
+		// Whether a compressed size saves enough over the original size
+		static bool PaysOff(uint64_t in_size, uint64_t in_compressedSize);
+
+		// Hashes the files that share their size with another one (BLAKE2b)
+		// and points every copy at the first job with the same content
+		//    @return size_t - Number of duplicate jobs found
+		static size_t FindDuplicates(std::vector<data_types::FLK_PACK_JOB>& io_jobs);
+
+		// Splits the entries larger than the chunk size into content-defined
+		// chunks and hashes them (BLAKE2b). Every distinct chunk becomes a
+		// chunk job, entries get the list of chunk indices they are made of.
+		//    @param out_chunks		 - Distinct chunks, in chunk index order
+		//	  @param out_entryChunks	 - Chunk indices of every job, empty if it is not chunked
+		//	  @param io_entryChecksums - Receives the base checksum of every chunked job
+		//
+		//	  @return bool			 - false if a file could not be read
+		static bool BuildChunkStore(std::vector<data_types::FLK_PACK_JOB>& io_jobs,
+			const FLK_PACK_OPTIONS& in_options,
+			std::vector<data_types::FLK_CHUNK_JOB>& out_chunks,
+			std::vector<std::vector<uint32_t>>& out_entryChunks,
+			std::vector<data_types::FLKEntryChecksum>& io_entryChecksums);
+
+		// Groups the small entries into solid blocks of about solidBlockSize
+		// bytes, sorted by extension then path, and records the block and the
+		// offset of every member in its job
+		static void BuildSolidBlocks(std::vector<data_types::FLK_PACK_JOB>& io_jobs,
+			const FLK_PACK_OPTIONS& in_options,
+			std::vector<std::vector<size_t>>& out_blocks);
+
+		// Groups the small entries (by extension or directory), trains one
+		// dictionary per group with enough samples and assigns its id to the
+		// entries of the group. Dictionary ids start at 1.
+		static bool TrainDictionaries(std::vector<data_types::FLK_PACK_JOB>& io_jobs,
+			const FLK_PACK_OPTIONS& in_options,
+			std::vector<std::unique_ptr<compression::zstd::ZstdDictionary>>& out_dictionaries);
+		// Dictionary/solid grouping key of an entry (lowercase extension or parent directory)
+		static std::string GetEntryGroup(const data_types::FLK_PACK_JOB& in_job, FLK_DICTIONARY_GROUPING in_grouping);
+
+		// Appends a section to the archive, encrypted with in_encryptor when requested
+		static bool WriteSection(io::FLKArchiveWriter& in_writer,
+			uint32_t in_type, uint32_t in_id,
+			const std::vector<uint8_t>& in_payload,
+			const encryption::xccp20::XChaCha20Poly1305KeySession* in_session,
+			encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor);
+
+		// Fills a version 1 header with the paths and locations of the entries
+		static void BuildHeaderV1(const std::vector<data_types::FLK_PACK_JOB>& in_jobs,
+			const std::vector<data_types::FLKEntryRecord>& in_entries,
+			const FLK_PACK_OPTIONS& in_options,
+			data_types::FLKHeader& out_header);
+		// Builds the version 2 entry table and string table, compressed
+		// together when the archive is compressed and it pays off
+		//    @param in_entries		 - Locations of the entries, the path offsets are filled here
+		//	  @param io_header		 - Receives the entry count, string table size and table codec
+		//	  @param out_tables		 - Packed tables, stored right after the header region
+		static bool BuildEntryTables(const std::vector<data_types::FLK_PACK_JOB>& in_jobs,
+			std::vector<data_types::FLKEntryRecord> in_entries,
+			const FLK_PACK_OPTIONS& in_options,
+			compression::zstd::ZstdStreamCompressor& in_compressor,
+			data_types::FLKHeaderV2& io_header,
+			std::vector<uint8_t>& out_tables);
 
-		static bool WriteFLKFile(const std::filesystem::path& in_outPath, data_types::FLKHeader* in_header, const std::vector<std::vector<uint8_t>>& in_fileBlobs, const std::vector<uint8_t>& in_globalSalt);
+		// Validates the file path length constraint in the FLK format
+		static bool ValidateFLKConstraints(const std::string& in_relPath);
 
 		static void OptimizePathPadding(char* out_entryPath, const std::string& in_actualPath);
 
@@ -0,0 +1,213 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_FLKReader.hpp - flak_FLKReader.cpp]
+//
+// Description: Memory-mapped reader for FLK archives. Open() maps the file,
+//              validates the footer and header, loads the sections and
+//              builds a path lookup table once. Entries are then returned
+//              straight from the mapping when they are stored as is, or
+//              decoded (solid blocks, frames, chunks, dictionaries and
+//              encryption) when they are packed.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.4.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKDefinition.hpp>	- flakpak API data types
+//  - <flakpak/flak_MappedFile.hpp>		- flakpak API
+//  - <flakpak/flak_FrameReader.hpp>	- flakpak API
+//  - <flakpak/flak_SolidBlockCache.hpp>	- flakpak API
+//  - <flakpak/flak_PathIndex.hpp>		- flakpak API
+//  - <flakpak/xccp20_KeySession.hpp>	- flakpak API
+//  - <flakpak/zstd_Compressor.hpp>		- flakpak API
+//
+//  - <filesystem>    - C++ Standard Library
+//  - <string>        - C++ Standard Library
+//  - <string_view>   - C++ Standard Library
+//  - <unordered_map> - C++ Standard Library
+//  - <map>           - C++ Standard Library
+//  - <memory>        - C++ Standard Library
+//  - <span>          - C++ Standard Library
+//  - <vector>        - C++ Standard Library
+//
+// Notes:
+//  - Version 1 and version 2 headers are both supported, version 2 entry
+//    tables are unpacked once at open.
+//  - Archives packed before the footer was added (FLKHeader at byte 0, no
+//    flags) are read in place, compression is detected from their entries.
+//    Their encrypted variant never stored the per-file salts and is refused.
+//  - Paths are decompressed once at open and looked up with '/' separators
+//    whatever the platform the archive was packed on. Archives with a path
+//    index are searched through it, the hash map is only built for older
+//    archives.
+//  - Views returned by ReadEntry() point into the mapping (stored entries),
+//    into the solid block cache or into the caller buffer. They stay valid
+//    until the next read or Close().
+//  - ReadEntryInto() decodes frames and chunks straight into the caller
+//    buffer with reused zstd and XChaCha20 states, nothing is allocated
+//    on that path once the decoders are warm.
+//  - Not thread safe, open one reader per reading thread (the mapping is
+//    shared by the OS, only the tables are duplicated).
+//
+// ===========================================================================
+#ifndef FLAK_FLK_READER_HPP
+#define FLAK_FLK_READER_HPP
+
+#include <flakpak/flak_FLKDefinition.hpp>
+#include <flakpak/flak_MappedFile.hpp>
+#include <flakpak/flak_FrameReader.hpp>
+#include <flakpak/flak_SolidBlockCache.hpp>
+#include <flakpak/flak_PathIndex.hpp>
+#include <flakpak/xccp20_KeySession.hpp>
+#include <flakpak/zstd_Compressor.hpp>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+
+
+namespace flakpak::io {
+	class FLKArchiveReader final {
+	public:
+		FLKArchiveReader() = default;
+		~FLKArchiveReader() = default;
+
+		FLKArchiveReader(const FLKArchiveReader&) = delete;
+		FLKArchiveReader& operator=(const FLKArchiveReader&) = delete;
+
+		// Maps an archive and loads its tables
+		//    @param in_path			 - Archive to open
+		//	  @param in_password		 - Password of encrypted archives, ignored otherwise
+		//
+		//	  @return bool			 - false if the file is not a valid FLK archive or the password is wrong
+		bool Open(const std::filesystem::path& in_path, const std::string& in_password = {});
+		// Unmaps the archive and drops every table
+		void Close();
+
+		// Index of the entry stored under in_path, FLK_ENTRY_NOT_FOUND if there is none
+		[[nodiscard]] size_t FindEntry(std::string_view in_path) const;
+
+		// Returns the whole content of an entry
+		//    @param in_index		 - Entry index [0, GetEntryCount())
+		//	  @param io_buffer		 - Receives the decoded bytes when the entry cannot be returned in place
+		//	  @param out_data		 - View of the GetEntrySize() entry bytes
+		//
+		//	  @return bool			 - false if the entry could not be decoded
+		bool ReadEntry(size_t in_index, std::vector<uint8_t>& io_buffer, const uint8_t*& out_data);
+		// Decodes the whole content of an entry into caller memory (an upload
+		// staging buffer for instance), without any allocation
+		//    @param in_index		 - Entry index [0, GetEntryCount())
+		//	  @param out_data		 - Receives the GetEntrySize() entry bytes (can be larger)
+		//
+		//	  @return bool			 - false if out_data is too small or the entry could not be decoded
+		bool ReadEntryInto(size_t in_index, std::span<uint8_t> out_data);
+		// Decodes the bytes [in_offset, in_offset + in_length) of an entry,
+		// only the frames and chunks overlapping the range are decoded
+		//    @param in_index		 - Entry index [0, GetEntryCount())
+		//	  @param in_offset		 - First byte to read
+		//	  @param in_length		 - Number of bytes to read
+		//	  @param in_sink			 - Receives the bytes of the range, in order
+		//
+		//	  @return bool			 - false if the range is out of bounds or the data is corrupted
+		bool ReadRange(size_t in_index, uint64_t in_offset, uint64_t in_length, const FLKDataSink& in_sink);
+
+		[[nodiscard]] bool IsOpen() const;
+		[[nodiscard]] uint32_t GetFlags() const;
+		[[nodiscard]] uint32_t GetContentVersion() const;
+		[[nodiscard]] size_t GetEntryCount() const;
+		[[nodiscard]] const std::string& GetEntryPath(size_t in_index) const;
+		[[nodiscard]] uint64_t GetEntrySize(size_t in_index) const;
+		[[nodiscard]] const data_types::FLKEntryRecord& GetEntry(size_t in_index) const;
+		[[nodiscard]] const data_types::FLKEntryInfo& GetEntryInfo(size_t in_index) const;
+		// Whether ReadEntry() returns the entry straight from the mapping
+		[[nodiscard]] bool IsStoredInPlace(size_t in_index) const;
+		// Everything FrameReader needs to decode an entry, packedData points into the mapping
+		[[nodiscard]] FLK_PACKED_ENTRY GetPackedEntry(size_t in_index) const;
+		[[nodiscard]] const data_types::FLKSolidBlock& GetSolidBlock(uint32_t in_blockIndex) const;
+		// Whether the archive stores per-entry checksums (FLK_FLAG_CHECKSUMS)
+		[[nodiscard]] bool HasChecksums() const;
+		// Stored checksums of an entry, nullptr if the archive has none
+		[[nodiscard]] const data_types::FLKEntryChecksum* GetEntryChecksum(size_t in_index) const;
+		[[nodiscard]] const std::filesystem::path& GetPath() const;
+
+	private:
+		// Lets the lookup table be queried with a std::string_view
+		struct PathHash {
+			using is_transparent = void;
+			size_t operator()(std::string_view in_path) const { return std::hash<std::string_view>{}(in_path); }
+
+		}; // PathHash
+
+		bool Load(const std::string& in_password);
+		bool LoadHeader(const std::string& in_password);
+		// Archives without footer: FLKHeader at byte 0, no flags, no sections
+		bool LoadLegacyHeader();
+		// Whether every entry of a footerless archive is a zstd frame of the entry size
+		[[nodiscard]] bool HasLegacyCompressedEntries() const;
+		bool OpenSession(uint64_t in_saltOffset, uint32_t in_saltLen, const std::string& in_password);
+		bool LoadEntriesV1();
+		bool LoadEntriesV2(const data_types::FLKHeaderV2& in_header, uint64_t in_tablesOffset);
+		bool LoadSections();
+		bool LoadSection(const data_types::FLKSection& in_section, const std::vector<uint8_t>& in_payload);
+		bool BuildIndex();
+		bool ValidateEntries() const;
+		// Frames start at 0, then offsets strictly increase inside the entry and its blob
+		[[nodiscard]] bool IsValidSeekTable(const data_types::FLKEntryRecord& in_entry, const data_types::FLKEntryInfo& in_info) const;
+
+		MappedFile m_file;
+		std::filesystem::path m_path;
+		data_types::FLKFooter m_footer;					// Built from the header when m_legacy is set
+		bool m_legacy { false };						// Packed before footers existed
+		uint32_t m_contentVersion { 0 };
+		std::vector<data_types::FLKEntryRecord> m_entries;	// Locations of the entries, whatever the header version
+		std::vector<data_types::FLKEntryInfo> m_entryInfos;
+		std::vector<std::string> m_paths;
+		std::unordered_map<std::string, size_t, PathHash, std::equal_to<>> m_index;	// Only used without a path index
+		pathcom::PathIndex m_pathIndex;
+
+		std::unique_ptr<encryption::xccp20::XChaCha20Poly1305KeySession> m_session;	// nullptr unless encrypted
+		std::map<uint32_t, std::unique_ptr<compression::zstd::ZstdDictionary>> m_dictionaries;
+		std::vector<data_types::FLKSolidBlock> m_solidBlocks;
+		std::vector<data_types::FLKFrame> m_frames;
+		std::vector<data_types::FLKChunk> m_chunks;
+		std::vector<uint32_t> m_chunkRefs;
+		std::vector<data_types::FLKEntryChecksum> m_checksums;	// Empty unless the archive has checksums
+
+		SolidBlockCache m_solidCache;
+		FrameReader m_frameReader;
+
+	}; // class FLKArchiveReader final
+
+} // namespace flakpak::io
+
+#endif // !FLAK_FLK_READER_HPP
@@ -0,0 +1,125 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_FLKVerifier.hpp - flak_FLKVerifier.cpp]
+//
+// Description: Checks an FLK archive against the checksums stored when it
+//              was packed. Every distinct packed region of the mapping is
+//              hashed once by a pool of workers, nothing is decoded. On
+//              request every entry is also decoded, its size compared to
+//              baseSize and its bytes to the checksum of the original file.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKDefinition.hpp>	- flakpak API data types
+//  - <flakpak/flak_FLKReader.hpp>		- flakpak API
+//  - <flakpak/xxh3_Hash.hpp>			- flakpak API
+//
+//  - <filesystem> - C++ Standard Library
+//  - <functional> - C++ Standard Library
+//  - <vector>     - C++ Standard Library
+//
+// Notes:
+//  - Regions are hashed in offset order, the workers walk the mapping
+//    roughly front to back. A single region is hashed by one worker, a
+//    huge entry bounds the run time by the speed of one core.
+//  - Solid members, copies and chunks shared by several entries are hashed
+//    or decoded once, every entry using them is checked against the result.
+//  - Every failing entry is reported, the check does not stop at the first.
+//  - Archives packed before checksums existed can only be checked with
+//    decoding, which then only confirms the sizes.
+//
+// ===========================================================================
+#ifndef FLAK_FLK_VERIFIER_HPP
+#define FLAK_FLK_VERIFIER_HPP
+
+#include <flakpak/flak_FLKDefinition.hpp>
+#include <flakpak/flak_FLKReader.hpp>
+
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+
+namespace flakpak {
+	// Options of FLKVerifier::VerifyArchive()
+	struct FLK_VERIFY_OPTIONS {
+		size_t jobCount { 0 };		// Worker threads hashing and decoding entries (0 = all cores)
+		bool decode { false };		// Also decode every entry and check its size and original checksum
+
+	}; // FLK_VERIFY_OPTIONS
+
+	class FLKVerifier {
+	public:
+		FLKVerifier() = default;
+		~FLKVerifier() = default;
+
+		// Checks every entry of an FLK archive
+		//    @param in_archivePath	 - Archive to check
+		//	  @param in_options		 - Worker count and decoding
+		//
+		//	  @return bool			 - false if the archive could not be opened or any entry failed
+		static bool VerifyArchive(const std::filesystem::path& in_archivePath, const FLK_VERIFY_OPTIONS& in_options);
+
+	private:
+		// Packed bytes hashed once, whatever the number of entries stored in them
+		struct PackedRegion {
+			const uint8_t* data { nullptr };
+			uint64_t size { 0 };
+
+			bool operator<(const PackedRegion& in_other) const {
+				return data != in_other.data ? data < in_other.data : size < in_other.size;
+			}
+			bool operator==(const PackedRegion& in_other) const = default;
+
+		}; // PackedRegion
+
+		// Entries decoded together, the members of a solid block or the
+		// copies of a blob
+		struct DecodeTask {
+			uint32_t solidBlock { FLK_NOT_SOLID };
+			std::vector<size_t> entries;
+
+		}; // DecodeTask
+
+		// Hashes the packed regions and compares them with the packed checksums
+		//    @return size_t - Number of entries that do not match
+		static size_t VerifyPacked(const io::FLKArchiveReader& in_reader, size_t in_jobCount, uint64_t& out_hashedSize);
+		// Decodes the entries and checks their size (and checksum when stored)
+		//    @return size_t - Number of entries that failed
+		static size_t VerifyDecoded(const io::FLKArchiveReader& in_reader, size_t in_jobCount, uint64_t& out_decodedSize);
+
+		// Runs in_worker on in_workerCount threads (the calling one included)
+		static void RunWorkers(size_t in_workerCount, const std::function<void()>& in_worker);
+
+	}; // class FLKVerifier
+
+} // namespace flakpak
+
+#endif // !FLAK_FLK_VERIFIER_HPP
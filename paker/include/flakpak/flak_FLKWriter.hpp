@@ -0,0 +1,163 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_FLKWriter.hpp - flak_FLKWriter.cpp]
+//
+// Description: Streaming writer for FLK archives. Blobs are appended as soon
+//              as they are produced. Two layouts are supported:
+//               - Seekable: the header region is reserved at byte 0 and
+//                 patched in place once all the offsets are known.
+//               - Streamed: a small FLKStreamPreamble is written at byte 0
+//                 and the header goes to the trailer, so the archive can be
+//                 written in a single pass to stdout or a pipe.
+//              Version 2 archives always use the streamed layout.
+//              Both layouts end with an optional FLKSectionDirectory and
+//              an FLKFooter.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.4.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKDefinition.hpp> - flakpak API data types
+//
+//  - <filesystem> - C++ Standard Library
+//  - <cstdio>     - C++ Standard Library
+//  - <vector>     - C++ Standard Library
+//  - <iostream>   - C++ Standard Library
+//
+// Notes:
+//  - Only the blob currently being appended is kept in memory, the archive
+//    size has no impact on memory use. Large entries can be appended piece
+//    by piece with AppendData() so they are never held in memory at all.
+//  - Blobs can be aligned to a power of two (page size for zero-copy
+//    mappings and O_DIRECT reads), the gaps are filled with
+//    FLK_PADDING_PATTERN. Sections and the header are never aligned.
+//  - If the writer is destroyed without calling Finalize() the partial
+//    output file is removed (stdout is left as is).
+//
+// ===========================================================================
+#ifndef FLAK_FLK_WRITER_HPP
+#define FLAK_FLK_WRITER_HPP
+
+#include <flakpak/flak_FLKDefinition.hpp>
+
+#include <filesystem>
+#include <cstdio>
+#include <vector>
+
+
+namespace flakpak::io {
+	// Output path used to write the archive to the standard output
+	static constexpr const char* FLK_STDOUT_PATH = "-";
+
+	class FLKArchiveWriter final {
+	public:
+		FLKArchiveWriter() = default;
+		~FLKArchiveWriter();
+
+		FLKArchiveWriter(const FLKArchiveWriter&) = delete;
+		FLKArchiveWriter& operator=(const FLKArchiveWriter&) = delete;
+
+		// Creates a seekable archive and reserves the header region
+		//    @param in_outPath		 - Path of the archive to create
+		//	  @param in_headerSize	 - Bytes reserved at the start of the file for the header
+		//
+		//	  @return bool			 - false if the file could not be created
+		bool Open(const std::filesystem::path& in_outPath, size_t in_headerSize);
+		// Creates a streamed archive, the header is written in the trailer
+		//    @param in_outPath		 - Path of the archive to create, pipe or FLK_STDOUT_PATH
+		//	  @param in_formatVersion - Format version written in the FLKStreamPreamble
+		//
+		//	  @return bool			 - false if the output could not be opened
+		bool OpenStream(const std::filesystem::path& in_outPath, uint8_t in_formatVersion = FLK_FORMAT_VERSION_1);
+		// Appends a blob at the end of the archive, aligned as set by SetAlignment()
+		//    @param in_data			 - Blob data
+		//	  @param in_size			 - Blob size in bytes
+		//	  @param out_offset		 - Absolute offset where the blob was written
+		//
+		//	  @return bool			 - false on write failure
+		bool AppendBlob(const uint8_t* in_data, size_t in_size, uint64_t& out_offset);
+		// Appends a piece of a blob that is written incrementally, the blob
+		// starts at the GetCurrentOffset() value read after calling AlignBlob()
+		//    @param in_data			 - Data to append
+		//	  @param in_size			 - Size in bytes
+		//
+		//	  @return bool			 - false on write failure
+		bool AppendData(const uint8_t* in_data, size_t in_size);
+		// Pads the archive up to the next blob alignment boundary
+		//    @return bool			 - false on write failure
+		bool AlignBlob();
+		// Appends a section payload and records it in the section directory
+		// written by Finalize()
+		//    @param in_type			 - FLK_SECTION_* value
+		//	  @param in_id			 - Identifier within the type
+		//	  @param in_flags		 - FLK_SECTION_FLAG_* values
+		//	  @param in_data			 - Payload data, already encrypted if flagged so
+		//	  @param in_size			 - Payload size in bytes
+		//
+		//	  @return bool			 - false on write failure
+		bool AppendSection(uint32_t in_type, uint32_t in_id, uint32_t in_flags, const uint8_t* in_data, size_t in_size);
+		// Writes the final header, the section directory (if any section was
+		// appended) and the footer and closes the output
+		//    @param in_header		 - Header bytes, must fit in the reserved region when seekable
+		//	  @param in_size			 - Size of the header bytes
+		//	  @param in_flags		 - FLK_FLAG_* values stored in the footer
+		//
+		//	  @return bool			 - false on write failure
+		bool Finalize(const void* in_header, size_t in_size, uint32_t in_flags);
+		// Closes and deletes the partially written archive
+		void Abort();
+
+		// Blob start alignment, a power of two (0 or 1 = no alignment)
+		void SetAlignment(uint64_t in_alignment);
+
+		[[nodiscard]] uint64_t GetCurrentOffset() const;
+		[[nodiscard]] bool IsStreamed() const;
+		// Bytes of FLK_PADDING_PATTERN written to align blobs
+		[[nodiscard]] uint64_t GetPaddingSize() const;
+
+		// Whether the output path requires the streamed layout (stdout, pipes, devices)
+		static bool RequiresStream(const std::filesystem::path& in_outPath);
+
+	private:
+		bool Write(const void* in_data, size_t in_size);
+
+		std::FILE* m_file { nullptr };
+		std::filesystem::path m_outPath;
+		bool m_isStdout { false };
+		bool m_streamed { false };
+		size_t m_headerSize { 0 };
+		uint64_t m_currentOffset { 0 };
+		uint64_t m_alignment { 0 };
+		uint64_t m_paddingSize { 0 };
+		std::vector<data_types::FLKSection> m_sections;
+
+	}; // class FLKArchiveWriter final
+
+} // namespace flakpak::io
+
+#endif // !FLAK_FLK_WRITER_HPP
\ No newline at end of file
@@ -0,0 +1,133 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_FrameReader.hpp - flak_FrameReader.cpp]
+//
+// Description: Random access into packed entries. Entries split into frames
+//              (see FLKFrame) are read through their seek table, only the
+//              frames overlapping the requested range are decrypted and
+//              decompressed. Single-frame entries are decoded from the start
+//              and decoding stops as soon as the range is complete. Chunked
+//              entries are reassembled from the chunk store the same way,
+//              every chunk acting as a frame.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.2.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKDefinition.hpp>	- flakpak API data types
+//  - <flakpak/zstd_Compressor.hpp>		- flakpak API
+//  - <flakpak/xccp20_Encryptor.hpp>	- flakpak API
+//
+//  - <vector>  - C++ Standard Library
+//  - <span>    - C++ Standard Library
+//  - <cstdint> - C++ Standard Library
+//
+// Notes:
+//  - Not thread safe, use one reader per reading thread. The decompression
+//    and decryption states are reused from one call to the next.
+//  - ReadInto() decodes every frame straight to its place in the caller
+//    buffer. Only encrypted and compressed frames go through a scratch
+//    buffer, which is kept between calls, so reads do not allocate once
+//    the scratch buffer has grown to the largest frame.
+//
+// ===========================================================================
+#ifndef FLAK_FRAME_READER_HPP
+#define FLAK_FRAME_READER_HPP
+
+#include <flakpak/flak_FLKDefinition.hpp>
+#include <flakpak/zstd_Compressor.hpp>
+#include <flakpak/xccp20_Encryptor.hpp>
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+
+namespace flakpak::io {
+	// Everything needed to decode an entry stored in its own blob
+	struct FLK_PACKED_ENTRY {
+		const uint8_t* packedData { nullptr };		// Entry blob (mapped archive or buffer)
+		uint64_t packedSize { 0 };					// FLKEntry::packedSize
+		uint64_t baseSize { 0 };					// FLKEntry::baseSize
+		const data_types::FLKFrame* frames { nullptr };	// Seek table, nullptr if the entry is a single frame
+		size_t frameCount { 0 };					// FLKEntryInfo::frameCount
+		bool compressed { false };					// Archive has FLK_FLAG_COMPRESSED
+		const encryption::xccp20::XChaCha20Poly1305KeySession* session { nullptr };	// Archive key session, nullptr if not encrypted
+		const compression::zstd::ZstdDictionary* dictionary { nullptr };	// Prepared dictionary of the entry (if any)
+		const uint8_t* archiveData { nullptr };		// Start of the archive, chunk blobs are located from it
+		const data_types::FLKChunk* chunks { nullptr };	// Chunk store of the archive
+		const uint32_t* chunkRefs { nullptr };		// Chunk indices of the entry, nullptr if it is not chunked
+		size_t chunkCount { 0 };					// FLKEntryInfo::chunkCount
+		const uint8_t* const* chunkData { nullptr };	// Packed data of each chunk (reference order) read into buffers, nullptr to use archiveData
+
+	}; // FLK_PACKED_ENTRY
+
+	class FrameReader final {
+	public:
+		FrameReader() = default;
+		~FrameReader() = default;
+
+		FrameReader(const FrameReader&) = delete;
+		FrameReader& operator=(const FrameReader&) = delete;
+
+		// Decodes the bytes [in_offset, in_offset + in_length) of an entry
+		//    @param in_entry		 - Entry to read
+		//	  @param in_offset		 - First byte to read in the original entry
+		//	  @param in_length		 - Number of bytes to read
+		//	  @param in_sink			 - Receives the bytes of the range, in order
+		//
+		//	  @return bool			 - false if the range is out of bounds or the data is corrupted
+		bool ReadRange(const FLK_PACKED_ENTRY& in_entry, uint64_t in_offset, uint64_t in_length, const FLKDataSink& in_sink);
+		// Decodes a whole entry into caller memory
+		//    @param in_entry		 - Entry to read
+		//	  @param out_data		 - Receives the in_entry.baseSize decoded bytes (can be larger)
+		//
+		//	  @return bool			 - false if out_data is too small or the data is corrupted
+		bool ReadInto(const FLK_PACKED_ENTRY& in_entry, std::span<uint8_t> out_data);
+
+	private:
+		// Reads the range from the chunks of a chunked entry
+		bool ReadChunks(const FLK_PACKED_ENTRY& in_entry, uint64_t in_begin, uint64_t in_end, const FLKDataSink& in_sink);
+		// Decodes one frame and forwards the part overlapping [in_begin, in_end)
+		bool DecodeFrame(const FLK_PACKED_ENTRY& in_entry, bool in_compressed,
+			const uint8_t* in_packed, uint64_t in_packedSize,
+			uint64_t in_frameOffset, uint64_t in_begin, uint64_t in_end,
+			const FLKDataSink& in_sink);
+		// Decodes one whole frame into out_frame, which is exactly its decoded size
+		bool DecodeFrameInto(const FLK_PACKED_ENTRY& in_entry, bool in_compressed,
+			std::span<const uint8_t> in_packed, std::span<uint8_t> out_frame);
+
+		compression::zstd::ZstdStreamDecompressor m_decompressor;
+		encryption::xccp20::XChaCha20Poly1305StreamDecryptor m_decryptor;
+		std::vector<uint8_t> m_scratch;		// Decrypted frames waiting for decompression
+
+	}; // class FrameReader final
+
+} // namespace flakpak::io
+
+#endif // !FLAK_FRAME_READER_HPP
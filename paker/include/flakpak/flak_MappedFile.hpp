@@ -0,0 +1,101 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_MappedFile.hpp - flak_MappedFile.cpp]
+//
+// Description: Read-only memory mapping of a source file. The mapped bytes
+//              are handed straight to zstd and libsodium, so packing does not
+//              copy the file into an intermediate buffer first.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <filesystem> - C++ Standard Library
+//  - <cstdint>    - C++ Standard Library
+//
+//  - <sys/mman.h> - POSIX mmap/madvise
+//  - <windows.h>  - CreateFileMapping/MapViewOfFile on Windows
+//
+// Notes:
+//  - Source files are hinted as sequential (MADV_SEQUENTIAL on POSIX,
+//    FILE_FLAG_SEQUENTIAL_SCAN on Windows) so the kernel reads ahead. The
+//    archive reader jumps between entries and maps with the NORMAL hint,
+//    which keeps the default read-ahead around each fault and does not drop
+//    pages behind the reads.
+//  - Empty files are not mapped, GetData() returns nullptr and GetSize() 0.
+//  - The file must not be truncated while it is mapped.
+//
+// ===========================================================================
+#ifndef FLAK_MAPPED_FILE_HPP
+#define FLAK_MAPPED_FILE_HPP
+
+#include <filesystem>
+#include <cstdint>
+
+
+namespace flakpak::io {
+	enum class FLK_MAP_ACCESS {
+		SEQUENTIAL,		// Read once from front to back (packing source files)
+		NORMAL			// Lookup-driven reads anywhere in the file (archive reader)
+
+	}; // FLK_MAP_ACCESS
+
+	class MappedFile final {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// Maps the whole file read-only
+		//    @param in_path			 - File to map
+		//	  @param in_access		 - Access pattern the kernel is hinted with
+		//
+		//	  @return bool			 - false if the file could not be opened or mapped
+		bool Open(const std::filesystem::path& in_path, FLK_MAP_ACCESS in_access = FLK_MAP_ACCESS::SEQUENTIAL);
+		// Unmaps the file, called by the destructor
+		void Close();
+
+		[[nodiscard]] const uint8_t* GetData() const;
+		[[nodiscard]] uint64_t GetSize() const;
+		[[nodiscard]] bool IsOpen() const;
+
+	private:
+		const uint8_t* m_data { nullptr };
+		uint64_t m_size { 0 };
+		bool m_open { false };
+#ifdef _WIN32
+		void* m_mapping { nullptr };
+#endif
+
+	}; // class MappedFile final
+
+} // namespace flakpak::io
+
+#endif // !FLAK_MAPPED_FILE_HPP
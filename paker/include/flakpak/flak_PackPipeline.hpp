@@ -0,0 +1,95 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_PackPipeline.hpp - flak_PackPipeline.cpp]
+//
+// Description: Worker pool used by the packer. Entries are processed
+//              (read, compress, encrypt) in parallel by the workers and then
+//              handed back to a single committer in index order.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKDefinition.hpp> - flakpak API data types
+//
+//  - <functional>         - C++ Standard Library
+//  - <thread>             - C++ Standard Library
+//  - <mutex>              - C++ Standard Library
+//  - <condition_variable> - C++ Standard Library
+//  - <atomic>             - C++ Standard Library
+//
+// Notes:
+//  - The commit callback always runs on the calling thread, so everything
+//    touching the header or the output file stays single threaded.
+//  - A job count of 1 runs everything inline without spawning threads.
+//  - At most two results per worker are held in memory at any time, the
+//    workers wait for the committer when they get too far ahead.
+//
+// ===========================================================================
+#ifndef FLAK_PACK_PIPELINE_HPP
+#define FLAK_PACK_PIPELINE_HPP
+
+#include <flakpak/flak_FLKDefinition.hpp>
+
+#include <functional>
+
+
+namespace flakpak::pipeline {
+	class PackPipeline final {
+	public:
+		// Processes a single entry on a worker thread
+		//    @param in_workerIndex	 - Index of the worker running the job [0, GetWorkerCount())
+		//	  @param in_jobIndex		 - Index of the entry being processed
+		//	  @param out_result		 - Result to fill, set error on failure
+		//
+		//	  @return bool			 - false if the entry failed to process
+		using ProcessFn = std::function<bool(size_t in_workerIndex, size_t in_jobIndex, data_types::FLK_PACK_RESULT& out_result)>;
+		// Consumes a processed entry, always called in job index order
+		using CommitFn = std::function<bool(size_t in_jobIndex, data_types::FLK_PACK_RESULT& in_result)>;
+
+		// @param in_workerCount - Number of worker threads, 0 picks the hardware concurrency
+		explicit PackPipeline(size_t in_workerCount);
+		~PackPipeline() = default;
+
+		// Runs in_process for every job in [0, in_jobCount) across the workers
+		// and feeds each result to in_commit in index order. Stops at the first failure.
+		//
+		//    @return bool - true if every job was processed and committed
+		bool Run(size_t in_jobCount, const ProcessFn& in_process, const CommitFn& in_commit);
+
+		[[nodiscard]] size_t GetWorkerCount() const;
+
+	private:
+		size_t m_workerCount { 1 };
+		size_t m_maxInFlight { 2 };		// Processed results allowed to wait for the committer
+
+	}; // class PackPipeline final
+
+} // namespace flakpak::pipeline
+
+#endif // !FLAK_PACK_PIPELINE_HPP
\ No newline at end of file
@@ -0,0 +1,112 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_PathIndex.hpp - flak_PathIndex.cpp]
+//
+// Description: Perfect hash index of the entry paths, stored in the
+//              FLK_SECTION_PATH_INDEX section. The packer builds it with hash
+//              and displace: paths are spread into buckets and every bucket
+//              gets a pilot value that sends all its paths to free slots.
+//              A lookup is then one hash, one slot and one compare, with no
+//              allocation and no table to build when the archive is opened.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKDefinition.hpp> - flakpak API data types
+//
+//  - <string>      - C++ Standard Library
+//  - <string_view> - C++ Standard Library
+//  - <vector>      - C++ Standard Library
+//  - <cstdint>     - C++ Standard Library
+//
+// Notes:
+//  - Paths are hashed with '/' separators and without PathCompressor
+//    substitutions, the same path gives the same hash on every platform.
+//  - Find() only compares the 64-bit hashes, the caller must compare the
+//    entry path to reject paths that are not in the archive.
+//  - The layout is struct-of-arrays so a lookup touches one pilot, one hash
+//    and one entry index.
+//  - The table has about 10% more slots than paths, with every slot taken
+//    the last buckets need close to a full scan of pilots and the build time
+//    grows faster than the path count.
+//
+// ===========================================================================
+#ifndef FLAK_PATH_INDEX_HPP
+#define FLAK_PATH_INDEX_HPP
+
+#include <flakpak/flak_FLKDefinition.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+
+namespace flakpak::pathcom {
+	class PathIndex final {
+	public:
+		PathIndex() = default;
+		~PathIndex() = default;
+
+		// Builds the FLK_SECTION_PATH_INDEX payload of a list of paths
+		//    @param in_paths		 - Entry paths in entry order, '/' separated and all different
+		//	  @param out_payload		 - FLKPathIndex followed by the index arrays
+		//
+		//	  @return bool			 - false if no perfect hash was found (two paths with the same hash)
+		static bool Build(const std::vector<std::string>& in_paths, std::vector<uint8_t>& out_payload);
+
+		// Uses a payload read from an archive
+		//    @param in_payload		 - FLK_SECTION_PATH_INDEX payload
+		//	  @param in_entryCount	 - Number of entries of the archive
+		//
+		//	  @return bool			 - false if the payload is malformed
+		bool Load(const std::vector<uint8_t>& in_payload, size_t in_entryCount);
+		// Drops the loaded index
+		void Clear();
+
+		// Entry whose path has the hash of in_path, FLK_ENTRY_NOT_FOUND otherwise
+		[[nodiscard]] size_t Find(std::string_view in_path) const;
+		[[nodiscard]] bool IsLoaded() const;
+
+		// 64-bit hash of a path (FNV-1a with a final avalanche)
+		static uint64_t HashPath(std::string_view in_path, uint64_t in_seed);
+		// Slot of a path hash given the pilot of its bucket
+		static uint32_t GetSlot(uint64_t in_hash, uint32_t in_pilot, uint32_t in_slotCount);
+
+	private:
+		data_types::FLKPathIndex m_header;
+		std::vector<uint64_t> m_hashes;
+		std::vector<uint32_t> m_pilots;
+		std::vector<uint32_t> m_entries;
+
+	}; // class PathIndex final
+
+} // namespace flakpak::pathcom
+
+#endif // !FLAK_PATH_INDEX_HPP
@@ -0,0 +1,123 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [flak_SolidBlockCache.hpp - flak_SolidBlockCache.cpp]
+//
+// Description: Block-aware reader for entries stored in solid blocks. The
+//              block holding an entry is decrypted and decompressed once and
+//              kept in a small LRU cache, so the entries packed next to it
+//              are served straight from memory.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flakpak/flak_FLKDefinition.hpp>	- flakpak API data types
+//  - <flakpak/zstd_Compressor.hpp>		- flakpak API
+//  - <flakpak/xccp20_Encryptor.hpp>	- flakpak API
+//
+//  - <vector>  - C++ Standard Library
+//  - <cstdint> - C++ Standard Library
+//
+// Notes:
+//  - Entries are returned as views into the cached block, a view stays
+//    valid until the next call to ReadEntry() or Clear().
+//  - Not thread safe, use one cache per reading thread.
+//
+// ===========================================================================
+#ifndef FLAK_SOLID_BLOCK_CACHE_HPP
+#define FLAK_SOLID_BLOCK_CACHE_HPP
+
+#include <flakpak/flak_FLKDefinition.hpp>
+#include <flakpak/zstd_Compressor.hpp>
+#include <flakpak/xccp20_Encryptor.hpp>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace flakpak::io {
+	static constexpr size_t FLK_SOLID_CACHE_BLOCKS = 2;		// Decompressed blocks kept by default
+
+	class SolidBlockCache final {
+	public:
+		// @param in_capacity - Number of decompressed blocks kept in memory (at least 1)
+		explicit SolidBlockCache(size_t in_capacity = FLK_SOLID_CACHE_BLOCKS);
+		~SolidBlockCache() = default;
+
+		SolidBlockCache(const SolidBlockCache&) = delete;
+		SolidBlockCache& operator=(const SolidBlockCache&) = delete;
+
+		// Returns the bytes of an entry stored in a solid block, the block is
+		// only decoded if it is not cached already
+		//    @param in_blockIndex	 - Solid block of the entry (FLKEntryInfo::solidBlock)
+		//	  @param in_block		 - Location and sizes of that block
+		//	  @param in_packedBlock	 - The packed block blob (in_block.packedSize bytes)
+		//	  @param in_offset		 - Offset of the entry in the block (FLKEntryInfo::solidOffset)
+		//	  @param in_size			 - Size of the entry (FLKEntry::baseSize)
+		//	  @param in_session		 - Key session of the archive, nullptr if not encrypted
+		//	  @param out_data		 - View of the entry bytes inside the cached block
+		//
+		//	  @return bool			 - false if the block could not be decoded or the entry is out of range
+		bool ReadEntry(uint32_t in_blockIndex,
+			const data_types::FLKSolidBlock& in_block,
+			const uint8_t* in_packedBlock,
+			uint64_t in_offset,
+			uint64_t in_size,
+			const encryption::xccp20::XChaCha20Poly1305KeySession* in_session,
+			const uint8_t*& out_data);
+		// Drops every cached block
+		void Clear();
+
+		[[nodiscard]] uint64_t GetHitCount() const;
+		[[nodiscard]] uint64_t GetMissCount() const;
+
+	private:
+		struct CachedBlock {
+			uint32_t index { FLK_NOT_SOLID };
+			uint64_t lastUse { 0 };
+			std::vector<uint8_t> data;
+
+		}; // CachedBlock
+
+		bool DecodeBlock(const data_types::FLKSolidBlock& in_block,
+			const uint8_t* in_packedBlock,
+			const encryption::xccp20::XChaCha20Poly1305KeySession* in_session,
+			std::vector<uint8_t>& out_data);
+
+		std::vector<CachedBlock> m_blocks;
+		uint64_t m_useCounter { 0 };
+		uint64_t m_hits { 0 };
+		uint64_t m_misses { 0 };
+		compression::zstd::ZstdStreamDecompressor m_decompressor;
+		encryption::xccp20::XChaCha20Poly1305StreamDecryptor m_decryptor;
+
+	}; // class SolidBlockCache final
+
+} // namespace flakpak::io
+
+#endif // !FLAK_SOLID_BLOCK_CACHE_HPP
@@ -28,17 +28,21 @@
 // Description: Interface for XChaCha20-Poly1305 encryption method
 // 
 // Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
-// Date: 30.08.2025
-// Version: 1.1.0
+// Date: 17.10.2026
+// Version: 1.4.0
 //
 // ---------------------------------------------------------------------------
 // Dependencies:
 //  - <flak_FLKDefinition.hpp> - flakpak API data types
+//  - <xccp20_KeySession.hpp>  - flakpak API archive key session
 // 
 //	- <iostream> - C++ Standard Library
 //  - <vector>  - C++ Standard Library
+//  - <array>   - C++ Standard Library
+//  - <span>    - C++ Standard Library
 //  - <cstdint> - C++ Standard Library
 //  - <string>	- C++ Standard Library
+//  - <memory>	- C++ Standard Library
 // 
 //  - <libsodium> - For XChaCha20-Poly1305 encryption and Argon2 key derivation
 // 
@@ -52,12 +56,18 @@
 #define FLAK_XCPP20_ENCRYPTOR_HPP
 
 #include <flakpak/flak_FLKDefinition.hpp>
+#include <flakpak/xccp20_KeySession.hpp>
 
 #include <vector>
+#include <array>
+#include <span>
 #include <cstdint>
 #include <string>
+#include <memory>
 
 
+struct crypto_secretstream_xchacha20poly1305_state;
+
 namespace flakpak::encryption::xccp20 {
 	class XChaCha20Poly1305Encryptor final {
 	public:
@@ -81,6 +91,32 @@ namespace flakpak::encryption::xccp20 {
 			const std::vector<uint8_t>& salt,
 			const std::string& in_password);
 
+		// Encrypts the input data with a subkey of the archive key session
+		// (no Argon2id run, the session derived the master key once)
+		//    @param in_data		 - The plaintext data to encrypt
+		//	  @param in_session		 - The archive key session
+		//
+		//    @return FLK_ENCRYPTION_RESULT - structure containing encrypted data and nonce
+		data_types::FLK_ENCRYPTION_RESULT EncryptData(const std::vector<uint8_t>& in_data,
+			const XChaCha20Poly1305KeySession& in_session);
+		// Decrypts data encrypted with a subkey of the archive key session
+		//    @param in_encryptedData	 - The encrypted data (nonce + ciphertext)
+		//	  @param in_session			 - The archive key session
+		//
+		//	  @return std::vector<uint8_t> - The decrypted plaintext data
+		std::vector<uint8_t> DecryptData(const std::vector<uint8_t>& in_encryptedData,
+			const XChaCha20Poly1305KeySession& in_session);
+		// Decrypts a blob of the archive key session where it lies, the
+		// plaintext overwrites the ciphertext (no allocation)
+		//    @param io_data			 - The encrypted data (nonce + ciphertext), decrypted in place
+		//	  @param in_session			 - The archive key session
+		//	  @param out_plain			 - View of the plaintext inside io_data
+		//
+		//	  @return bool				 - false if the data is too short or was tampered with
+		bool DecryptInPlace(std::span<uint8_t> io_data,
+			const XChaCha20Poly1305KeySession& in_session,
+			std::span<uint8_t>& out_plain);
+
 		[[nodiscard]] size_t GetNonceSize() const;
 		[[nodiscard]] size_t GetMacSize() const;
 
@@ -95,6 +131,96 @@ namespace flakpak::encryption::xccp20 {
 
 	}; // class XChaCha20Poly1305Encryptor final
 
+	// Chunked encryption built on crypto_secretstream_xchacha20poly1305.
+	// Blob layout: [8-byte subkey id][24-byte stream header][chunk]...[final chunk],
+	// every chunk holds up to FLK_ENCRYPTION_CHUNK_SIZE plaintext bytes plus
+	// 17 bytes of tag and MAC.
+	class XChaCha20Poly1305StreamEncryptor final {
+	public:
+		XChaCha20Poly1305StreamEncryptor();
+		~XChaCha20Poly1305StreamEncryptor();
+
+		XChaCha20Poly1305StreamEncryptor(const XChaCha20Poly1305StreamEncryptor&) = delete;
+		XChaCha20Poly1305StreamEncryptor& operator=(const XChaCha20Poly1305StreamEncryptor&) = delete;
+
+		// Starts a new stream and emits its header
+		bool Begin(const XChaCha20Poly1305KeySession& in_session, const FLKDataSink& in_sink);
+		// Encrypts the next piece of plaintext, full chunks are emitted as they fill up
+		bool Push(const uint8_t* in_data, size_t in_size, const FLKDataSink& in_sink);
+		// Emits the last (possibly empty) chunk tagged as final
+		bool End(const FLKDataSink& in_sink);
+
+		// Size of the encrypted blob for a given plaintext size
+		static uint64_t GetEncryptedSize(uint64_t in_plainSize);
+
+	private:
+		bool EmitChunk(const uint8_t* in_data, size_t in_size, bool in_final, const FLKDataSink& in_sink);
+
+		std::unique_ptr<crypto_secretstream_xchacha20poly1305_state> m_state;
+		std::vector<uint8_t> m_plainChunk;
+		std::vector<uint8_t> m_cipherChunk;
+
+	}; // class XChaCha20Poly1305StreamEncryptor final
+
+	// Decrypts blobs written by XChaCha20Poly1305StreamEncryptor, the input can
+	// be pushed in pieces of any size and only one chunk is buffered
+	class XChaCha20Poly1305StreamDecryptor final {
+	public:
+		XChaCha20Poly1305StreamDecryptor();
+		~XChaCha20Poly1305StreamDecryptor();
+
+		XChaCha20Poly1305StreamDecryptor(const XChaCha20Poly1305StreamDecryptor&) = delete;
+		XChaCha20Poly1305StreamDecryptor& operator=(const XChaCha20Poly1305StreamDecryptor&) = delete;
+
+		// Prepares the decryptor for a new blob
+		void Begin(const XChaCha20Poly1305KeySession& in_session);
+		// Decrypts the next piece of the blob (stream header included)
+		bool Push(const uint8_t* in_data, size_t in_size, const FLKDataSink& in_sink);
+		// Decrypts the remaining chunk and checks the stream was not truncated
+		bool End(const FLKDataSink& in_sink);
+
+		// Decrypts a whole blob straight into caller memory, every chunk is
+		// pulled to its final place without going through a buffer
+		//    @param in_session		 - The archive key session
+		//	  @param in_blob			 - The encrypted blob (subkey id, stream header and chunks)
+		//	  @param out_data		 - Receives the plaintext, at least the plaintext size
+		//	  @param out_size		 - Number of bytes written to out_data
+		//
+		//	  @return bool			 - false if the blob is truncated, tampered with or does not fit
+		bool DecryptInto(const XChaCha20Poly1305KeySession& in_session, std::span<const uint8_t> in_blob,
+			std::span<uint8_t> out_data, size_t& out_size);
+
+		// Pull mode: starts decrypting a blob lying in memory, the chunks are
+		// then decrypted one by one by PullNext()
+		//    @param in_session		 - The archive key session
+		//	  @param in_blob			 - The encrypted blob, must stay valid until the last PullNext()
+		//
+		//	  @return bool			 - false if the stream header is missing or invalid
+		bool BeginPull(const XChaCha20Poly1305KeySession& in_session, std::span<const uint8_t> in_blob);
+		// Decrypts the next chunk of the blob
+		//    @param out_plain		 - Plaintext of the chunk, valid until the next call (empty once the final chunk was read)
+		//
+		//	  @return bool			 - false if the blob is truncated or tampered with
+		bool PullNext(std::span<const uint8_t>& out_plain);
+
+	private:
+		bool PullChunk(const FLKDataSink& in_sink);
+		// Starts pulling a stream, the subkey of the last blob is reused when the id matches
+		bool InitPull(const uint8_t* in_header);
+
+		const XChaCha20Poly1305KeySession* m_session { nullptr };
+		const XChaCha20Poly1305KeySession* m_keySession { nullptr };	// Session m_key was derived from
+		uint64_t m_keyId { 0 };
+		std::array<unsigned char, FLK_KEY_SIZE> m_key {};
+		std::unique_ptr<crypto_secretstream_xchacha20poly1305_state> m_state;
+		std::vector<uint8_t> m_cipherChunk;
+		std::vector<uint8_t> m_plainChunk;
+		std::span<const uint8_t> m_pullBlob;		// Remaining chunks in pull mode
+		bool m_headerDone { false };
+		bool m_finished { false };
+
+	}; // class XChaCha20Poly1305StreamDecryptor final
+
 } // namespace flakpak::encryption::xccp20
 
 #endif // !FLAK_XCPP20_ENCRYPTOR_HPP
\ No newline at end of file
@@ -0,0 +1,126 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [xccp20_KeySession.hpp - xccp20_KeySession.cpp]
+//
+// Description: Archive-wide key session. The password is stretched once per
+//              archive with Argon2id into a master key, every entry then gets
+//              its own subkey through crypto_kdf (BLAKE2b), which is cheap.
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <flak_FLKDefinition.hpp> - flakpak API data types
+//
+//  - <vector>  - C++ Standard Library
+//  - <array>   - C++ Standard Library
+//  - <cstdint> - C++ Standard Library
+//  - <string>  - C++ Standard Library
+//
+//  - <libsodium> - For Argon2id and crypto_kdf subkey derivation
+//
+// Notes:
+//  - The subkey identifier of an entry is taken from the first 8 bytes of
+//    its random nonce, so a blob can always be decrypted on its own no
+//    matter which entry points at it.
+//  - The master key is wiped from memory when the session is destroyed.
+//  - Open refuses limits above FLK_KDF_MAX_OPSLIMIT/FLK_KDF_MAX_MEMLIMIT so a
+//    crafted archive cannot make the reader allocate or spin without bound.
+//
+// ===========================================================================
+#ifndef FLAK_XCCP20_KEY_SESSION_HPP
+#define FLAK_XCCP20_KEY_SESSION_HPP
+
+#include <flakpak/flak_FLKDefinition.hpp>
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <string>
+
+
+namespace flakpak::encryption::xccp20 {
+	class XChaCha20Poly1305KeySession final {
+	public:
+		XChaCha20Poly1305KeySession() = default;
+		~XChaCha20Poly1305KeySession();
+
+		XChaCha20Poly1305KeySession(const XChaCha20Poly1305KeySession&) = delete;
+		XChaCha20Poly1305KeySession& operator=(const XChaCha20Poly1305KeySession&) = delete;
+
+		// Creates a new session with a fresh random salt (packing)
+		//    @param in_password	 - The password used for encryption
+		//	  @param in_params		 - Argon2id limits used for the derivation
+		//
+		//	  @return bool			 - false if the key derivation failed
+		bool Create(const std::string& in_password, const data_types::FLKKdfParams& in_params);
+		// Opens a session from the salt and limits stored in an archive (reading)
+		//    @param in_password	 - The password used for encryption
+		//	  @param in_salt		 - The global salt stored after the header
+		//	  @param in_params		 - The KDF parameters stored after the salt
+		//
+		//	  @return bool			 - false if the limits are out of bounds or
+		//							   the key derivation failed
+		bool Open(const std::string& in_password,
+			const std::vector<uint8_t>& in_salt,
+			const data_types::FLKKdfParams& in_params);
+
+		// Derives the subkey of an entry from the master key
+		//    @param in_subkeyId	 - Subkey identifier (see GetSubkeyId)
+		//	  @param out_key		 - Output buffer of FLK_KEY_SIZE bytes
+		void DeriveSubkey(uint64_t in_subkeyId, unsigned char* out_key) const;
+
+		[[nodiscard]] bool IsValid() const;
+		[[nodiscard]] const std::vector<uint8_t>& GetSalt() const;
+		[[nodiscard]] const data_types::FLKKdfParams& GetParams() const;
+
+		// Subkey identifier of an entry, read from the start of its nonce
+		static uint64_t GetSubkeyId(const uint8_t* in_nonce);
+
+		// libsodium MODERATE limits, used unless the limits are calibrated
+		static data_types::FLKKdfParams GetDefaultParams();
+		// Picks Argon2id limits so that one derivation takes about in_targetMs
+		// on this machine. Memory grows up to the SENSITIVE limit before any
+		// pass is added, both stay within the bounds Open accepts
+		//    @param in_targetMs	 - Wanted derivation time in milliseconds
+		//	  @param out_expectedMs	 - Time the chosen limits should take here
+		static data_types::FLKKdfParams Calibrate(uint32_t in_targetMs, uint32_t& out_expectedMs);
+
+	private:
+		bool DeriveMasterKey(const std::string& in_password);
+
+		std::array<unsigned char, FLK_KEY_SIZE> m_masterKey {};
+		std::vector<uint8_t> m_salt;
+		data_types::FLKKdfParams m_params;
+		bool m_valid { false };
+
+	}; // class XChaCha20Poly1305KeySession final
+
+} // namespace flakpak::encryption::xccp20
+
+#endif // !FLAK_XCCP20_KEY_SESSION_HPP
\ No newline at end of file
@@ -0,0 +1,92 @@
+// ===========================================================================
+//
+// flakpak - File Archiver and Compressor CL Application
+//
+// Copyright (C) 2025 SACRAROSSA
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+// ---------------------------------------------------------------------------
+// File: [xxh3_Hash.hpp - xxh3_Hash.cpp]
+//
+// Description: 64-bit XXH3 hash (seed 0, default secret), used for the
+//              per-entry checksums of FLK_SECTION_CHECKSUMS. Inputs can be
+//              hashed in one call or pushed in pieces of any size, both give
+//              the same value, the one printed by "xxhsum -H3".
+//
+// Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
+// Date: 17.10.2026
+// Version: 1.0.0
+//
+// ---------------------------------------------------------------------------
+// Dependencies:
+//  - <array>   - C++ Standard Library
+//  - <cstddef> - C++ Standard Library
+//  - <cstdint> - C++ Standard Library
+//
+// Notes:
+//  - Implemented from the XXH3 specification, no xxHash dependency. The
+//    stripe loop has scalar, SSE2 and AVX2 versions. AVX2 is picked at run
+//    time on x86 with GCC/Clang (compile time with MSVC /arch:AVX2).
+//  - Not a cryptographic hash, it detects corruption, not tampering.
+//    Encrypted entries are authenticated by XChaCha20-Poly1305 already.
+//
+// ===========================================================================
+#ifndef FLAK_XXH3_HASH_HPP
+#define FLAK_XXH3_HASH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace flakpak::checksum::xxh3 {
+	class Xxh3Hasher final {
+	public:
+		Xxh3Hasher();
+		~Xxh3Hasher() = default;
+
+		// Starts a new hash
+		void Reset();
+		// Hashes the next piece of input
+		void Update(const uint8_t* in_data, size_t in_size);
+		// Hash of everything pushed since Reset(), more input can follow
+		[[nodiscard]] uint64_t Digest() const;
+
+		// Hashes a whole input in one call
+		//    @param in_data		 - Data to hash
+		//	  @param in_size		 - Size of the data in bytes
+		//
+		//	  @return uint64_t		 - XXH3 64-bit hash of the data
+		static uint64_t Hash(const uint8_t* in_data, size_t in_size);
+		// Stripe loop in use ("avx2", "sse2" or "scalar")
+		static const char* GetImplementation();
+
+	private:
+		alignas(64) std::array<uint64_t, 8> m_acc {};
+		alignas(64) std::array<uint8_t, 256> m_buffer {};
+		size_t m_bufferedSize { 0 };
+		size_t m_stripesSoFar { 0 };		// Stripes of the current block already accumulated
+		uint64_t m_totalSize { 0 };
+
+	}; // class Xxh3Hasher final
+
+} // namespace flakpak::checksum::xxh3
+
+#endif // !FLAK_XXH3_HASH_HPP
@@ -28,26 +28,37 @@
 // Description: Interface for zstd compression algorithm
 // 
 // Author: \x45\x6D\x61\x6E\x75\x65\x6C\x20\x46\x61\x76\x61\x72\x6F
-// Date: 30.08.2025
-// Version: 1.1.0
+// Date: 17.10.2026
+// Version: 1.8.0
 //
 // ---------------------------------------------------------------------------
 // Dependencies:
 //  - <flak_FLKDefinition.hpp> - flakpak API data types
+//  - <flak_MappedFile.hpp>	   - Zero-copy file input
 //
 //  - <vector>     - C++ Standard Library
 //  - <filesystem> - C++ Standard Library
+//  - <span>       - C++ Standard Library
 //  - <cstdint>	   - C++ Standard Library
 //  - <iostream>   - C++ Standard Library
-//  - <fstream>	   - C++ Standard Library
 //  - <iomanip>	   - C++ Standard Library
 //
-//  - <zstd> - Zstandard compression library
+//  - <zstd> - Zstandard compression library (zdict for dictionary training)
 // 
 // Notes:
 //  - [Any important implementation notes]
 //  - [Known issues or limitations]
-//  - [Performance considerations]
+//  - ZstdCompressor keeps one compression context per thread, and the
+//    one-shot output buffer only grows, so packing many small files does not
+//    allocate a context or reallocate the output for each of them.
+//  - Large inputs can use zstd worker threads and long distance matching
+//    (see FLK_ZSTD_PARAMS), this requires zstd built with ZSTD_MULTITHREAD
+//    for the workers. Without it they are ignored and the input is
+//    compressed on the calling thread.
+//  - Windows above 128 MiB (windowLog > 27) need the decompressor to allow
+//    them, ZstdStreamDecompressor accepts any window zstd supports.
+//  - The span overloads decode into caller memory without allocating, the
+//    context is created once per thread (or per ZstdStreamDecompressor).
 //
 // ===========================================================================
 #ifndef FLAK_ZSTD_COMPRESSOR_HPP
@@ -57,10 +68,53 @@
 
 #include <vector>
 #include <filesystem>
+#include <span>
 #include <cstdint>
 
 
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
 namespace flakpak::compression::zstd {
+	// Dictionary shared by a group of small entries. The raw content is what
+	// gets stored in the archive, the prepared ZSTD_CDict/ZSTD_DDict are built
+	// once and can be used by every thread at the same time.
+	class ZstdDictionary final {
+	public:
+		ZstdDictionary() = default;
+		~ZstdDictionary();
+
+		ZstdDictionary(const ZstdDictionary&) = delete;
+		ZstdDictionary& operator=(const ZstdDictionary&) = delete;
+
+		// Trains the dictionary with ZDICT_trainFromBuffer
+		//    @param in_samples			- Sample files stored back to back
+		//	  @param in_sampleSizes		- Size of every sample in in_samples
+		//	  @param in_capacity			- Maximum dictionary size
+		//
+		//	  @return bool				- false if zstd could not train a dictionary
+		bool Train(const std::vector<uint8_t>& in_samples, const std::vector<size_t>& in_sampleSizes, size_t in_capacity);
+		// Uses the content of a dictionary stored in an archive
+		void Load(std::vector<uint8_t> in_data);
+
+		// Builds the ZSTD_CDict used by the compressors
+		bool PrepareCompression(int in_compressionLevel);
+		// Builds the ZSTD_DDict used by the decompressors
+		bool PrepareDecompression();
+
+		[[nodiscard]] const std::vector<uint8_t>& GetData() const;
+		[[nodiscard]] const ZSTD_CDict_s* GetCDict() const;
+		[[nodiscard]] const ZSTD_DDict_s* GetDDict() const;
+
+	private:
+		std::vector<uint8_t> m_data;
+		ZSTD_CDict_s* m_cdict { nullptr };
+		ZSTD_DDict_s* m_ddict { nullptr };
+
+	}; // class ZstdDictionary final
+
 	class ZstdCompressor final {
 	public:
 		ZstdCompressor() = default;
@@ -73,16 +127,132 @@ namespace flakpak::compression::zstd {
 		//    @return FLK_COMPRESSION_RESULT	- structure containing compressed data and sizes
 		data_types::FLK_COMPRESSION_RESULT CompressData(const std::filesystem::path& in_path,
 			int in_compressionLevel = 3);
+		// Compress a block of memory (a mapped file for instance) with specified compression level
+		//    @param in_data					- Data to compress
+		//	  @param in_size					- Size of the data in bytes
+		//	  @param in_compressionLevel		- Compression level (default is 3)
+		//    
+		//    @return FLK_COMPRESSION_RESULT	- structure containing compressed data and sizes
+		data_types::FLK_COMPRESSION_RESULT CompressData(const uint8_t* in_data, size_t in_size,
+			int in_compressionLevel = 3);
 		// Decompress data to its original form
 		//    @param in_data				 - Data to decompress
 		//	  @param in_originalSize		 - Original size of the data (required for some algorithms)
+		//	  @param in_dictionary		 - Dictionary the data was compressed with (if any)
 		//	  
 		//    @return std::vector<uint8_t>	 - Decompressed data
 		std::vector<uint8_t> DecompressData(const std::vector<uint8_t>& in_data,
-			size_t in_originalSize);
+			size_t in_originalSize, const ZstdDictionary* in_dictionary = nullptr);
+		// Decompress data into caller memory, with a decompression context kept per thread
+		//    @param in_data				 - Compressed frame (a view of a mapped archive for instance)
+		//	  @param out_data			 - Receives the decompressed bytes, at least the original size
+		//	  @param out_size			 - Number of bytes written to out_data
+		//	  @param in_dictionary		 - Dictionary the data was compressed with (if any)
+		//
+		//    @return bool				 - false if the frame is corrupted or does not fit in out_data
+		bool DecompressData(std::span<const uint8_t> in_data, std::span<uint8_t> out_data,
+			size_t& out_size, const ZstdDictionary* in_dictionary = nullptr);
 
 	}; // class ZstdCompressor final
 
+	// Reusable compression context. Owns a single ZSTD_CCtx that is reset
+	// between entries instead of being created and freed for each of them.
+	// Inputs that fit in memory are compressed in one shot (Compress), larger
+	// ones incrementally (Begin/Push/End), the output is handed to the sink as
+	// soon as zstd produces it so memory use does not depend on the input size
+	class ZstdStreamCompressor final {
+	public:
+		ZstdStreamCompressor();
+		~ZstdStreamCompressor();
+
+		ZstdStreamCompressor(const ZstdStreamCompressor&) = delete;
+		ZstdStreamCompressor& operator=(const ZstdStreamCompressor&) = delete;
+
+		// Starts a new frame
+		//    @param in_compressionLevel	- Compression level
+		//	  @param in_pledgedSize		- Total input size, recorded in the frame header
+		//	  @param in_dictionary		- Prepared dictionary to compress with (optional)
+		//
+		//	  @return bool				- false if the parameters are invalid
+		bool Begin(int in_compressionLevel, uint64_t in_pledgedSize, const ZstdDictionary* in_dictionary = nullptr);
+		// Compresses the next piece of input
+		bool Push(const uint8_t* in_data, size_t in_size, const FLKDataSink& in_sink);
+		// Flushes and closes the frame
+		bool End(const FLKDataSink& in_sink);
+
+		// Compresses a whole input with ZSTD_compress2 into a buffer sized by
+		// ZSTD_compressBound, the content size is recorded in the frame header
+		//    @param in_data				- Data to compress
+		//	  @param in_size				- Size of the data in bytes
+		//	  @param in_compressionLevel	- Compression level
+		//	  @param in_sink				- Receives the whole frame in a single call
+		//	  @param in_dictionary		- Prepared dictionary to compress with (optional)
+		//
+		//	  @return bool				- false if compression failed
+		bool Compress(const uint8_t* in_data, size_t in_size, int in_compressionLevel, const FLKDataSink& in_sink,
+			const ZstdDictionary* in_dictionary = nullptr);
+
+		// Sets the parameters used by Begin/Compress for inputs of at least
+		// in_params.largeInputThreshold bytes
+		void SetLargeInputParams(const data_types::FLK_ZSTD_PARAMS& in_params);
+
+		// Checks every parameter against the bounds supported by zstd
+		//    @return bool				- false if a parameter is out of range
+		static bool ValidateParams(const data_types::FLK_ZSTD_PARAMS& in_params);
+
+	private:
+		ZSTD_CCtx_s* m_cctx { nullptr };
+		std::vector<uint8_t> m_outBuffer;
+		std::vector<uint8_t> m_frameBuffer;		// One-shot output, kept between entries
+		data_types::FLK_ZSTD_PARAMS m_largeInputParams;
+		bool m_hasLargeInputParams { false };
+
+	}; // class ZstdStreamCompressor final
+
+	// Incremental decompressor, accepts the compressed frame in pieces of any
+	// size and hands the decoded data to the sink
+	class ZstdStreamDecompressor final {
+	public:
+		ZstdStreamDecompressor();
+		~ZstdStreamDecompressor();
+
+		ZstdStreamDecompressor(const ZstdStreamDecompressor&) = delete;
+		ZstdStreamDecompressor& operator=(const ZstdStreamDecompressor&) = delete;
+
+		// Resets the decompressor for a new frame
+		//    @param in_dictionary		- Prepared dictionary the frame was compressed with (optional)
+		bool Begin(const ZstdDictionary* in_dictionary = nullptr);
+		// Decompresses the next piece of compressed input
+		bool Push(const uint8_t* in_data, size_t in_size, const FLKDataSink& in_sink);
+		// Checks that the whole frame was consumed
+		bool End();
+		// Pull mode: decodes as much of io_input as fits in out_data, the
+		// caller drives the pace instead of a sink
+		//    @param io_input			- Compressed bytes, advanced past what zstd consumed
+		//	  @param out_data			- Receives the decoded bytes
+		//	  @param out_size			- Number of bytes written to out_data
+		//
+		//	  @return bool				- false if the frame is corrupted or followed by trailing data
+		bool Pull(std::span<const uint8_t>& io_input, std::span<uint8_t> out_data, size_t& out_size);
+
+		// Decompresses a whole frame in one shot straight into caller memory,
+		// reusing the context of this decompressor
+		//    @param in_data				- Compressed frame
+		//	  @param out_data			- Receives the decompressed bytes
+		//	  @param out_size			- Number of bytes written to out_data
+		//	  @param in_dictionary		- Prepared dictionary the frame was compressed with (optional)
+		//
+		//	  @return bool				- false if the frame is corrupted or does not fit in out_data
+		bool DecompressInto(std::span<const uint8_t> in_data, std::span<uint8_t> out_data,
+			size_t& out_size, const ZstdDictionary* in_dictionary = nullptr);
+
+	private:
+		ZSTD_DCtx_s* m_dctx { nullptr };
+		std::vector<uint8_t> m_outBuffer;
+		bool m_frameDone { false };
+
+	}; // class ZstdStreamDecompressor final
+
 } // namespace flakpak::compression::zstd
 
 #endif // !FLAK_ZSTD_COMPRESSOR_HPP
\ No newline at end of file
@@ -0,0 +1,693 @@
+#include <flakpak/flak_BatchReader.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define FLK_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+
+using namespace flakpak::data_types;
+
+namespace flakpak::io {
+#ifdef _WIN32
+	using NativeFile = HANDLE;
+	static const NativeFile FLK_INVALID_FILE = INVALID_HANDLE_VALUE;
+#else
+	using NativeFile = int;
+	static constexpr NativeFile FLK_INVALID_FILE = -1;
+#endif
+
+	static constexpr uint64_t FLK_BATCH_MAX_SUBMIT = 1 << 30;	// Largest single read request, bigger reads are resubmitted
+
+	static NativeFile OpenNative(const std::filesystem::path& in_path) {
+#ifdef _WIN32
+		return CreateFileW(in_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+#else
+		return ::open(in_path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+	}
+
+	static void CloseNative(NativeFile in_file) {
+#ifdef _WIN32
+		CloseHandle(in_file);
+#else
+		::close(in_file);
+#endif
+	}
+
+	// Reads exactly in_size bytes at in_offset, callable from several threads at once
+	static bool ReadAt(NativeFile in_file, uint8_t* out_data, uint64_t in_size, uint64_t in_offset) {
+		while (in_size > 0) {
+#ifdef _WIN32
+			OVERLAPPED overlapped {};
+			overlapped.Offset = static_cast<DWORD>(in_offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(in_offset >> 32);
+			DWORD bytesRead = 0;
+			if (!ReadFile(in_file, out_data, static_cast<DWORD>(std::min(in_size, FLK_BATCH_MAX_SUBMIT)), &bytesRead, &overlapped) ||
+				bytesRead == 0) {
+				return false;
+			}
+#else
+			ssize_t bytesRead = ::pread(in_file, out_data, static_cast<size_t>(std::min(in_size, FLK_BATCH_MAX_SUBMIT)), static_cast<off_t>(in_offset));
+			if (bytesRead < 0 && errno == EINTR) {
+				continue;
+			}
+			if (bytesRead <= 0) {
+				return false;
+			}
+#endif
+			out_data += bytesRead;
+			in_size -= bytesRead;
+			in_offset += bytesRead;
+		}
+
+		return true;
+	}
+
+#ifdef FLK_HAS_IO_URING
+	// Smallest possible io_uring: one submission ring, one completion ring, reads only
+	class IoRing final {
+	public:
+		IoRing() = default;
+		~IoRing() { Close(); }
+
+		IoRing(const IoRing&) = delete;
+		IoRing& operator=(const IoRing&) = delete;
+
+		bool Init(uint32_t in_depth) {
+			io_uring_params params {};
+			int fd = static_cast<int>(::syscall(__NR_io_uring_setup, in_depth, &params));
+			if (fd < 0) {
+				return false;
+			}
+			m_fd = fd;
+
+			m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+			m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+			if (singleMap) {
+				m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+			}
+
+			m_sqRing = Map(m_sqRingSize, IORING_OFF_SQ_RING);
+			m_cqRing = singleMap ? m_sqRing : Map(m_cqRingSize, IORING_OFF_CQ_RING);
+			m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			m_sqes = static_cast<io_uring_sqe*>(Map(m_sqesSize, IORING_OFF_SQES));
+			if (!m_sqRing || !m_cqRing || !m_sqes) {
+				Close();
+				return false;
+			}
+
+			uint8_t* sq = static_cast<uint8_t*>(m_sqRing);
+			m_sqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+			m_sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+			m_sqMask = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+			m_sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+			uint8_t* cq = static_cast<uint8_t*>(m_cqRing);
+			m_cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+			m_cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+			m_cqMask = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+			m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+			return true;
+		}
+
+		// Releases the rings, reads still owned by the kernel are cancelled
+		void Close() {
+			if (m_sqes) {
+				::munmap(m_sqes, m_sqesSize);
+			}
+			if (m_cqRing && m_cqRing != m_sqRing) {
+				::munmap(m_cqRing, m_cqRingSize);
+			}
+			if (m_sqRing) {
+				::munmap(m_sqRing, m_sqRingSize);
+			}
+			if (m_fd >= 0) {
+				::close(m_fd);
+			}
+
+			m_fd = -1;
+			m_sqRing = m_cqRing = nullptr;
+			m_sqes = nullptr;
+		}
+
+		// Queues a read, it is handed to the kernel by the next SubmitAndWait()
+		void PrepareRead(int in_fd, uint8_t* out_data, uint32_t in_size, uint64_t in_offset, uint64_t in_userData) {
+			// This thread is the only producer, the tail can be read plainly
+			uint32_t tail = *m_sqTail;
+			uint32_t slot = tail & *m_sqMask;
+
+			io_uring_sqe& sqe = m_sqes[slot];
+			std::memset(&sqe, 0, sizeof(sqe));
+			sqe.opcode = IORING_OP_READ;
+			sqe.fd = in_fd;
+			sqe.addr = reinterpret_cast<uint64_t>(out_data);
+			sqe.len = in_size;
+			sqe.off = in_offset;
+			sqe.user_data = in_userData;
+
+			m_sqArray[slot] = slot;
+			std::atomic_ref<uint32_t>(*m_sqTail).store(tail + 1, std::memory_order_release);
+		}
+
+		// Submits the queued reads and waits for at least one completion
+		bool SubmitAndWait() {
+			for (;;) {
+				uint32_t toSubmit = *m_sqTail - std::atomic_ref<uint32_t>(*m_sqHead).load(std::memory_order_acquire);
+				if (::syscall(__NR_io_uring_enter, m_fd, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0) {
+					return true;
+				}
+				// Busy rings are drained by the caller before the next call
+				if (errno == EAGAIN || errno == EBUSY) {
+					return true;
+				}
+				if (errno != EINTR) {
+					return false;
+				}
+			}
+		}
+
+		bool PopCompletion(uint64_t& out_userData, int32_t& out_result) {
+			uint32_t head = *m_cqHead;
+			if (head == std::atomic_ref<uint32_t>(*m_cqTail).load(std::memory_order_acquire)) {
+				return false;
+			}
+
+			const io_uring_cqe& cqe = m_cqes[head & *m_cqMask];
+			out_userData = cqe.user_data;
+			out_result = cqe.res;
+			std::atomic_ref<uint32_t>(*m_cqHead).store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		void* Map(size_t in_size, uint64_t in_offset) const {
+			void* mapping = ::mmap(nullptr, in_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, static_cast<off_t>(in_offset));
+			return mapping != MAP_FAILED ? mapping : nullptr;
+		}
+
+		int m_fd { -1 };
+		void* m_sqRing { nullptr };
+		void* m_cqRing { nullptr };
+		size_t m_sqRingSize { 0 };
+		size_t m_cqRingSize { 0 };
+		io_uring_sqe* m_sqes { nullptr };
+		size_t m_sqesSize { 0 };
+
+		uint32_t* m_sqHead { nullptr };
+		uint32_t* m_sqTail { nullptr };
+		uint32_t* m_sqMask { nullptr };
+		uint32_t* m_sqArray { nullptr };
+		uint32_t* m_cqHead { nullptr };
+		uint32_t* m_cqTail { nullptr };
+		uint32_t* m_cqMask { nullptr };
+		io_uring_cqe* m_cqes { nullptr };
+
+	}; // class IoRing final
+#endif
+
+	// One merged read and the entries waiting for it
+	struct BatchRead {
+		uint64_t offset { 0 };
+		uint64_t size { 0 };
+		std::vector<uint8_t> data;
+		std::vector<size_t> slots;		// Positions in the index list that need this read
+		bool failed { false };
+
+	}; // BatchRead
+
+	// Everything shared by the read loop and the decode workers
+	struct BatchState {
+		BatchState(const FLKArchiveReader& in_reader, const std::vector<size_t>& in_indices, const FLKEntryCallback& in_callback)
+			: reader(in_reader), indices(in_indices), callback(in_callback) {}
+
+		const FLKArchiveReader& reader;
+		const std::vector<size_t>& indices;
+		const FLKEntryCallback& callback;
+
+		std::vector<BatchRead> reads;
+		std::vector<std::vector<size_t>> slotReads;			// Reads needed by each slot
+		std::unique_ptr<std::atomic<uint32_t>[]> readsLeft;	// Per slot, reads not completed yet
+		std::unique_ptr<std::atomic<uint32_t>[]> slotsLeft;	// Per read, slots not decoded yet
+
+		std::mutex jobsMutex;
+		std::condition_variable jobReady;
+		std::deque<std::vector<size_t>> jobs;	// Slots ready to decode, members of a solid block stay together
+		bool closed { false };
+		std::atomic<bool> failed { false };
+
+	}; // BatchState
+
+	// Sorts the blobs of the requested entries and merges the close ones
+	static void PlanReads(BatchState& io_state) {
+		struct Extent {
+			uint64_t offset;
+			uint64_t size;
+			size_t slot;
+		};
+
+		const FLKArchiveReader& reader = io_state.reader;
+		std::vector<Extent> extents;
+		extents.reserve(io_state.indices.size());
+
+		for (size_t slot = 0; slot < io_state.indices.size(); slot++) {
+			size_t index = io_state.indices[slot];
+			const FLKEntryRecord& entry = reader.GetEntry(index);
+			const FLKEntryInfo& info = reader.GetEntryInfo(index);
+
+			if (info.solidBlock != FLK_NOT_SOLID) {
+				const FLKSolidBlock& block = reader.GetSolidBlock(info.solidBlock);
+				extents.push_back({ block.offset, block.packedSize, slot });
+			}
+			else if (info.chunkCount != 0) {
+				FLK_PACKED_ENTRY packed = reader.GetPackedEntry(index);
+				for (size_t c = 0; c < packed.chunkCount; c++) {
+					const FLKChunk& chunk = packed.chunks[packed.chunkRefs[c]];
+					extents.push_back({ chunk.offset, chunk.packedSize, slot });
+				}
+			}
+			else {
+				extents.push_back({ entry.offset, entry.packedSize, slot });
+			}
+		}
+
+		extents.erase(std::remove_if(extents.begin(), extents.end(), [](const Extent& in_extent) {
+			return in_extent.size == 0;
+		}), extents.end());
+		std::sort(extents.begin(), extents.end(), [](const Extent& in_a, const Extent& in_b) {
+			return in_a.offset < in_b.offset;
+		});
+
+		std::vector<std::pair<size_t, size_t>> links;	// (read, slot)
+		links.reserve(extents.size());
+		for (const Extent& extent : extents) {
+			uint64_t end = extent.offset + extent.size;
+			BatchRead* last = io_state.reads.empty() ? nullptr : &io_state.reads.back();
+
+			bool merge = last && extent.offset <= last->offset + last->size + FLK_BATCH_MERGE_GAP &&
+				std::max(end, last->offset + last->size) - last->offset <= FLK_BATCH_MAX_READ;
+			if (merge) {
+				last->size = std::max(end, last->offset + last->size) - last->offset;
+			}
+			else {
+				BatchRead read;
+				read.offset = extent.offset;
+				read.size = extent.size;
+				io_state.reads.push_back(std::move(read));
+			}
+			links.emplace_back(io_state.reads.size() - 1, extent.slot);
+		}
+
+		// Shared solid blocks and chunks link a slot to the same read several times
+		std::sort(links.begin(), links.end());
+		links.erase(std::unique(links.begin(), links.end()), links.end());
+
+		io_state.slotReads.resize(io_state.indices.size());
+		for (const auto& [read, slot] : links) {
+			io_state.reads[read].slots.push_back(slot);
+			io_state.slotReads[slot].push_back(read);
+		}
+
+		io_state.readsLeft = std::make_unique<std::atomic<uint32_t>[]>(io_state.indices.size());
+		for (size_t slot = 0; slot < io_state.indices.size(); slot++) {
+			io_state.readsLeft[slot].store(static_cast<uint32_t>(io_state.slotReads[slot].size()), std::memory_order_relaxed);
+		}
+		io_state.slotsLeft = std::make_unique<std::atomic<uint32_t>[]>(io_state.reads.size());
+		for (size_t read = 0; read < io_state.reads.size(); read++) {
+			io_state.slotsLeft[read].store(static_cast<uint32_t>(io_state.reads[read].slots.size()), std::memory_order_relaxed);
+		}
+	}
+
+	// Queues the slots that have all their reads, members of one solid block form a single job
+	static void PushReadySlots(BatchState& io_state, std::vector<size_t>& io_ready) {
+		if (io_ready.empty()) {
+			return;
+		}
+
+		auto blockOf = [&io_state](size_t in_slot) {
+			return io_state.reader.GetEntryInfo(io_state.indices[in_slot]).solidBlock;
+		};
+		std::stable_sort(io_ready.begin(), io_ready.end(), [&blockOf](size_t in_a, size_t in_b) {
+			return blockOf(in_a) < blockOf(in_b);
+		});
+
+		std::vector<std::vector<size_t>> jobs;
+		for (size_t slot : io_ready) {
+			uint32_t block = blockOf(slot);
+			if (jobs.empty() || block == FLK_NOT_SOLID || block != blockOf(jobs.back().front())) {
+				jobs.emplace_back();
+			}
+			jobs.back().push_back(slot);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(io_state.jobsMutex);
+			for (auto& job : jobs) {
+				io_state.jobs.push_back(std::move(job));
+			}
+		}
+		io_state.jobReady.notify_all();
+	}
+
+	static void OnReadDone(BatchState& io_state, size_t in_read) {
+		std::vector<size_t> ready;
+		for (size_t slot : io_state.reads[in_read].slots) {
+			if (io_state.readsLeft[slot].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				ready.push_back(slot);
+			}
+		}
+
+		PushReadySlots(io_state, ready);
+	}
+
+	// Blob [in_offset, in_offset + in_size) inside the reads of a slot, falls back to the mapping
+	static const uint8_t* FindBlob(const BatchState& in_state, size_t in_slot, uint64_t in_offset, uint64_t in_size) {
+		for (size_t read : in_state.slotReads[in_slot]) {
+			const BatchRead& batchRead = in_state.reads[read];
+			if (in_offset >= batchRead.offset && in_offset - batchRead.offset <= batchRead.size &&
+				in_size <= batchRead.size - (in_offset - batchRead.offset)) {
+				return batchRead.data.data() + (in_offset - batchRead.offset);
+			}
+		}
+
+		return in_state.reader.GetPackedEntry(in_state.indices[in_slot]).archiveData + in_offset;
+	}
+
+	static void DecodeSlot(BatchState& io_state, size_t in_slot, FrameReader& io_frameReader,
+		SolidBlockCache& io_solidCache, std::vector<uint8_t>& io_buffer, std::vector<const uint8_t*>& io_chunkData) {
+		const FLKArchiveReader& reader = io_state.reader;
+		size_t index = io_state.indices[in_slot];
+		const FLKEntryRecord& entry = reader.GetEntry(index);
+		const FLKEntryInfo& info = reader.GetEntryInfo(index);
+
+		bool success = true;
+		for (size_t read : io_state.slotReads[in_slot]) {
+			success = success && !io_state.reads[read].failed;
+		}
+
+		const uint8_t* data = nullptr;
+		if (success && entry.baseSize != 0) {
+			FLK_PACKED_ENTRY packed = reader.GetPackedEntry(index);
+
+			if (info.solidBlock != FLK_NOT_SOLID) {
+				const FLKSolidBlock& block = reader.GetSolidBlock(info.solidBlock);
+				success = io_solidCache.ReadEntry(info.solidBlock, block, FindBlob(io_state, in_slot, block.offset, block.packedSize),
+					info.solidOffset, entry.baseSize, packed.session, data);
+			}
+			else {
+				if (info.chunkCount == 0) {
+					packed.packedData = FindBlob(io_state, in_slot, entry.offset, entry.packedSize);
+				}
+				else {
+					// Every chunk was planned as its own extent, decode it from the read holding it
+					io_chunkData.resize(packed.chunkCount);
+					for (size_t c = 0; c < packed.chunkCount; c++) {
+						const FLKChunk& chunk = packed.chunks[packed.chunkRefs[c]];
+						io_chunkData[c] = FindBlob(io_state, in_slot, chunk.offset, chunk.packedSize);
+					}
+					packed.chunkData = io_chunkData.data();
+				}
+
+				if (reader.IsStoredInPlace(index)) {
+					data = packed.packedData;
+				}
+				else {
+					io_buffer.resize(static_cast<size_t>(entry.baseSize));
+					success = io_frameReader.ReadInto(packed, io_buffer);
+					data = io_buffer.data();
+				}
+			}
+		}
+
+		if (!success) {
+			io_state.failed.store(true, std::memory_order_relaxed);
+		}
+		io_state.callback(index, success ? data : nullptr, entry.baseSize, success);
+
+		// The last entry of a read frees its buffer
+		for (size_t read : io_state.slotReads[in_slot]) {
+			if (io_state.slotsLeft[read].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				std::vector<uint8_t>().swap(io_state.reads[read].data);
+			}
+		}
+	}
+
+	static void RunDecodeWorker(BatchState& io_state) {
+		FrameReader frameReader;
+		SolidBlockCache solidCache(1);
+		std::vector<uint8_t> buffer;
+		std::vector<const uint8_t*> chunkData;
+
+		for (;;) {
+			std::vector<size_t> job;
+			{
+				std::unique_lock<std::mutex> lock(io_state.jobsMutex);
+				io_state.jobReady.wait(lock, [&io_state]() { return !io_state.jobs.empty() || io_state.closed; });
+				if (io_state.jobs.empty()) {
+					return;
+				}
+				job = std::move(io_state.jobs.front());
+				io_state.jobs.pop_front();
+			}
+
+			for (size_t slot : job) {
+				DecodeSlot(io_state, slot, frameReader, solidCache, buffer, chunkData);
+			}
+		}
+	}
+
+#ifdef FLK_HAS_IO_URING
+	// Keeps FLK_BATCH_QUEUE_DEPTH reads queued in io_uring, false if the ring cannot be created
+	static bool RunRingReads(BatchState& io_state, NativeFile in_file) {
+		IoRing ring;
+		if (!ring.Init(FLK_BATCH_QUEUE_DEPTH)) {
+			return false;
+		}
+
+		std::vector<BatchRead>& reads = io_state.reads;
+		std::vector<uint64_t> bytesDone(reads.size(), 0);
+		std::vector<bool> completed(reads.size(), false);
+		size_t nextRead = 0;
+		size_t inFlight = 0;
+		size_t completedCount = 0;
+
+		auto queueRead = [&](size_t in_read) {
+			BatchRead& read = reads[in_read];
+			uint64_t done = bytesDone[in_read];
+			ring.PrepareRead(in_file, read.data.data() + done, static_cast<uint32_t>(std::min(read.size - done, FLK_BATCH_MAX_SUBMIT)),
+				read.offset + done, in_read);
+			inFlight++;
+		};
+
+		while (completedCount < reads.size()) {
+			while (inFlight < FLK_BATCH_QUEUE_DEPTH && nextRead < reads.size()) {
+				reads[nextRead].data.resize(static_cast<size_t>(reads[nextRead].size));
+				queueRead(nextRead++);
+			}
+
+			if (!ring.SubmitAndWait()) {
+				break;
+			}
+
+			uint64_t userData = 0;
+			int32_t result = 0;
+			while (ring.PopCompletion(userData, result)) {
+				size_t readIndex = static_cast<size_t>(userData);
+				BatchRead& read = reads[readIndex];
+				inFlight--;
+
+				if (result > 0) {
+					bytesDone[readIndex] += static_cast<uint64_t>(result);
+					if (bytesDone[readIndex] < read.size) {
+						queueRead(readIndex);
+						continue;
+					}
+				}
+				else {
+					// Kernels without IORING_OP_READ answer -EINVAL, the read is done here instead
+					uint64_t done = bytesDone[readIndex];
+					read.failed = !ReadAt(in_file, read.data.data() + done, read.size - done, read.offset + done);
+				}
+
+				completed[readIndex] = true;
+				completedCount++;
+				OnReadDone(io_state, readIndex);
+			}
+		}
+
+		// The ring broke down, whatever is left is read directly
+		if (completedCount < reads.size()) {
+			ring.Close();
+
+			for (size_t r = 0; r < reads.size(); r++) {
+				if (completed[r]) {
+					continue;
+				}
+
+				BatchRead& read = reads[r];
+				read.data.resize(static_cast<size_t>(read.size));
+				read.failed = !ReadAt(in_file, read.data.data() + bytesDone[r], read.size - bytesDone[r], read.offset + bytesDone[r]);
+				OnReadDone(io_state, r);
+			}
+		}
+
+		return true;
+	}
+#endif
+
+	// Spreads the reads over a few threads doing positional reads
+	static void RunPooledReads(BatchState& io_state, NativeFile in_file) {
+		std::atomic<size_t> nextRead { 0 };
+
+		auto readLoop = [&io_state, &nextRead, in_file]() {
+			for (;;) {
+				size_t readIndex = nextRead.fetch_add(1, std::memory_order_relaxed);
+				if (readIndex >= io_state.reads.size()) {
+					return;
+				}
+
+				BatchRead& read = io_state.reads[readIndex];
+				read.data.resize(static_cast<size_t>(read.size));
+				read.failed = !ReadAt(in_file, read.data.data(), read.size, read.offset);
+				OnReadDone(io_state, readIndex);
+			}
+		};
+
+		size_t threadCount = std::min(FLK_BATCH_READ_THREADS, io_state.reads.size());
+		std::vector<std::thread> threads;
+		for (size_t t = 1; t < threadCount; t++) {
+			threads.emplace_back(readLoop);
+		}
+		readLoop();
+
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+	}
+
+	BatchReader::BatchReader(size_t in_workerCount) {
+		if (in_workerCount == 0) {
+			in_workerCount = std::thread::hardware_concurrency();
+		}
+		m_workerCount = std::max<size_t>(in_workerCount, 1);
+	}
+
+	bool BatchReader::ReadEntries(const FLKArchiveReader& in_reader, const std::vector<size_t>& in_indices, const FLKEntryCallback& in_callback) {
+		m_readCount = 0;
+		m_bytesRead = 0;
+		m_usedIoUring = false;
+
+		if (!in_reader.IsOpen()) {
+			/// TODO
+			/// Handle error: no archive
+			/// Output to console
+			std::cout << "Error: No archive is open.\n";
+			return false;
+		}
+		for (size_t index : in_indices) {
+			if (index >= in_reader.GetEntryCount()) {
+				/// TODO
+				/// Handle error: invalid entry index
+				/// Output to console
+				std::cout << "Error: Invalid entry index " << index << ".\n";
+				return false;
+			}
+		}
+		if (in_indices.empty()) {
+			return true;
+		}
+
+		// A separate handle, the mapping of the reader is left alone
+		NativeFile file = OpenNative(in_reader.GetPath());
+		if (file == FLK_INVALID_FILE) {
+			/// TODO
+			/// Handle error: failed to open archive
+			/// Output to console
+			std::cout << "Error: Failed to open archive: " << in_reader.GetPath().string() << "\n";
+			return false;
+		}
+
+		BatchState state(in_reader, in_indices, in_callback);
+		PlanReads(state);
+
+		m_readCount = state.reads.size();
+		for (const BatchRead& read : state.reads) {
+			m_bytesRead += read.size;
+		}
+
+		std::vector<std::thread> workers;
+		for (size_t w = 0; w < m_workerCount; w++) {
+			workers.emplace_back(RunDecodeWorker, std::ref(state));
+		}
+
+		// Entries with nothing to read (empty files) are ready right away
+		std::vector<size_t> ready;
+		for (size_t slot = 0; slot < in_indices.size(); slot++) {
+			if (state.slotReads[slot].empty()) {
+				ready.push_back(slot);
+			}
+		}
+		PushReadySlots(state, ready);
+
+#ifdef FLK_HAS_IO_URING
+		m_usedIoUring = RunRingReads(state, file);
+#endif
+		if (!m_usedIoUring) {
+			RunPooledReads(state, file);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(state.jobsMutex);
+			state.closed = true;
+		}
+		state.jobReady.notify_all();
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		CloseNative(file);
+
+		return !state.failed.load();
+	}
+
+	size_t BatchReader::GetWorkerCount() const {
+		return m_workerCount;
+	}
+	size_t BatchReader::GetReadCount() const {
+		return m_readCount;
+	}
+	uint64_t BatchReader::GetBytesRead() const {
+		return m_bytesRead;
+	}
+	bool BatchReader::UsedIoUring() const {
+		return m_usedIoUring;
+	}
+
+} // namespace flakpak::io
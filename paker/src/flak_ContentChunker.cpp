@@ -0,0 +1,94 @@
+#include <flakpak/flak_ContentChunker.hpp>
+
+#include <array>
+#include <algorithm>
+
+
+namespace flakpak::dedup {
+	static constexpr uint64_t FLK_CHUNK_MIN_AVERAGE = 1 << 10;		// Smallest supported average chunk size
+	static constexpr uint64_t FLK_CHUNK_SIZE_RATIO = 4;				// Chunks are within [average / 4, average * 4]
+
+	// Gear table: one pseudo-random 64-bit value per byte, from a fixed seed
+	static std::array<uint64_t, 256> BuildGearTable() {
+		std::array<uint64_t, 256> table {};
+		uint64_t state = 0x464C4B4344433031;	// "FLKCDC01"
+		for (auto& value : table) {
+			// splitmix64
+			state += 0x9E3779B97F4A7C15;
+			uint64_t z = state;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+			value = z ^ (z >> 31);
+		}
+		return table;
+	}
+	static const std::array<uint64_t, 256> FLK_GEAR_TABLE = BuildGearTable();
+
+	// Mask of in_bits ones in the top bits, those depend on the last 64 bytes
+	static uint64_t TopBitsMask(unsigned in_bits) {
+		return in_bits == 0 ? 0 : ~0ULL << (64 - in_bits);
+	}
+
+	ContentChunker::ContentChunker(uint64_t in_averageSize) {
+		unsigned bits = 0;
+		while ((2ULL << bits) <= std::max(in_averageSize, FLK_CHUNK_MIN_AVERAGE)) {
+			bits++;
+		}
+
+		m_averageSize = 1ULL << bits;
+		m_minSize = m_averageSize / FLK_CHUNK_SIZE_RATIO;
+		m_maxSize = m_averageSize * FLK_CHUNK_SIZE_RATIO;
+		m_maskSmall = TopBitsMask(bits + 1);
+		m_maskLarge = TopBitsMask(bits - 1);
+	}
+
+	uint64_t ContentChunker::NextChunk(const uint8_t* in_data, uint64_t in_size) const {
+		if (in_size <= m_minSize) {
+			return in_size;
+		}
+
+		uint64_t end = std::min(in_size, m_maxSize);
+		uint64_t normal = std::min(end, m_averageSize);
+		uint64_t hash = 0;
+
+		// Nothing before the minimum size can be a boundary, so it is not hashed
+		uint64_t i = m_minSize;
+		for (; i < normal; i++) {
+			hash = (hash << 1) + FLK_GEAR_TABLE[in_data[i]];
+			if ((hash & m_maskSmall) == 0) {
+				return i + 1;
+			}
+		}
+		for (; i < end; i++) {
+			hash = (hash << 1) + FLK_GEAR_TABLE[in_data[i]];
+			if ((hash & m_maskLarge) == 0) {
+				return i + 1;
+			}
+		}
+
+		return end;
+	}
+
+	void ContentChunker::Split(const uint8_t* in_data, uint64_t in_size, std::vector<uint32_t>& out_sizes) const {
+		out_sizes.clear();
+		out_sizes.reserve(static_cast<size_t>(in_size / m_averageSize + 1));
+
+		uint64_t offset = 0;
+		while (offset < in_size) {
+			uint64_t size = NextChunk(in_data + offset, in_size - offset);
+			out_sizes.push_back(static_cast<uint32_t>(size));
+			offset += size;
+		}
+	}
+
+	uint64_t ContentChunker::GetMinSize() const {
+		return m_minSize;
+	}
+	uint64_t ContentChunker::GetAverageSize() const {
+		return m_averageSize;
+	}
+	uint64_t ContentChunker::GetMaxSize() const {
+		return m_maxSize;
+	}
+
+} // namespace flakpak::dedup
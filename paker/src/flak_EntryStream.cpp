@@ -0,0 +1,354 @@
+#include <flakpak/flak_EntryStream.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+
+using namespace flakpak::data_types;
+
+namespace flakpak::io {
+	bool EntryStream::Open(const FLKArchiveReader& in_reader, size_t in_index) {
+		Close();
+
+		if (!in_reader.IsOpen() || in_index >= in_reader.GetEntryCount()) {
+			/// TODO
+			/// Handle error: invalid entry index
+			/// Output to console
+			std::cout << "Error: Invalid entry index " << in_index << ".\n";
+			return false;
+		}
+
+		m_reader = &in_reader;
+		m_entry = in_reader.GetPackedEntry(in_index);
+		m_size = m_entry.baseSize;
+
+		const FLKEntryInfo& info = in_reader.GetEntryInfo(in_index);
+		if (info.solidBlock != FLK_NOT_SOLID) {
+			const FLKSolidBlock& block = in_reader.GetSolidBlock(info.solidBlock);
+			m_solid = true;
+			m_solidBlob = std::span<const uint8_t>(m_entry.archiveData + block.offset, static_cast<size_t>(block.packedSize));
+			m_solidBaseSize = block.baseSize;
+			m_solidOffset = info.solidOffset;
+			m_segmentCount = 1;
+		}
+		else if (m_entry.chunkRefs) {
+			m_segmentCount = m_entry.chunkCount;
+		}
+		else if (m_entry.frames && m_entry.frameCount != 0) {
+			m_segmentCount = m_entry.frameCount;
+		}
+		else {
+			m_segmentCount = 1;
+		}
+
+		if (!Seek(0)) {
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool EntryStream::Read(std::span<uint8_t> out_data, size_t& out_read) {
+		out_read = 0;
+		if (!m_reader) {
+			return false;
+		}
+
+		while (out_read < out_data.size() && m_position < m_size) {
+			if (!m_segmentOpen) {
+				if (m_segment >= m_segmentCount) {
+					/// TODO
+					/// Handle error: entry shorter than its recorded size
+					/// Output to console
+					std::cout << "Error: Failed to decode entry data.\n";
+					return false;
+				}
+				if (!OpenSegment(m_segment)) {
+					return false;
+				}
+			}
+
+			if (m_segmentDecoded == m_segmentSize) {
+				if (!FinishSegment()) {
+					return false;
+				}
+				m_segment++;
+				continue;
+			}
+
+			// Discarded bytes (seek target inside the segment) go through a small buffer
+			uint64_t segmentLeft = m_segmentSize - m_segmentDecoded;
+			std::span<uint8_t> target;
+			if (m_skip > 0) {
+				m_discard.resize(FLK_STREAM_DISCARD_SIZE);
+				target = std::span<uint8_t>(m_discard).first(static_cast<size_t>(std::min({ m_skip, segmentLeft, uint64_t { FLK_STREAM_DISCARD_SIZE } })));
+			}
+			else {
+				target = out_data.subspan(out_read, static_cast<size_t>(std::min({ uint64_t { out_data.size() - out_read }, m_size - m_position, segmentLeft })));
+			}
+
+			size_t produced = 0;
+			if (!Produce(target, produced)) {
+				return false;
+			}
+			m_segmentDecoded += produced;
+
+			if (m_skip > 0) {
+				m_skip -= produced;
+				continue;
+			}
+			out_read += produced;
+			m_position += produced;
+
+			// The last frame is checked to its end (checksum, final chunk), the
+			// rest of a solid block belongs to other entries
+			if (m_position == m_size && !m_solid && !FinishSegment()) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool EntryStream::Seek(uint64_t in_offset) {
+		if (!m_reader || in_offset > m_size) {
+			/// TODO
+			/// Handle error: position outside of the entry
+			/// Output to console
+			std::cout << "Error: Seek position is outside of the entry.\n";
+			return false;
+		}
+
+		m_segmentOpen = false;
+		m_position = in_offset;
+		m_skip = 0;
+		if (in_offset == m_size) {
+			m_segment = m_segmentCount;
+			return true;
+		}
+
+		// Segment holding in_offset, and how many decoded bytes of it come before
+		size_t segment = 0;
+		uint64_t skip = in_offset;
+		if (m_solid) {
+			skip += m_solidOffset;
+		}
+		else if (m_entry.chunkRefs) {
+			uint64_t chunkOffset = 0;
+			while (segment + 1 < m_entry.chunkCount && chunkOffset + m_entry.chunks[m_entry.chunkRefs[segment]].baseSize <= in_offset) {
+				chunkOffset += m_entry.chunks[m_entry.chunkRefs[segment]].baseSize;
+				segment++;
+			}
+			skip = in_offset - chunkOffset;
+		}
+		else if (m_entry.frames && m_entry.frameCount != 0) {
+			const FLKFrame* framesEnd = m_entry.frames + m_entry.frameCount;
+			const FLKFrame* frame = std::upper_bound(m_entry.frames + 1, framesEnd, in_offset, [](uint64_t in_value, const FLKFrame& in_frame) {
+				return in_value < in_frame.baseOffset;
+			}) - 1;
+			segment = static_cast<size_t>(frame - m_entry.frames);
+			skip = in_offset - std::min(frame->baseOffset, in_offset);
+		}
+
+		m_segment = segment;
+		if (!OpenSegment(segment)) {
+			return false;
+		}
+
+		// Stored data is skipped without being copied
+		if (!m_compressed && !m_encrypted) {
+			uint64_t stored = std::min<uint64_t>(skip, m_input.size());
+			m_input = m_input.subspan(static_cast<size_t>(stored));
+			m_segmentDecoded = stored;
+			skip -= stored;
+		}
+		m_skip = skip;
+
+		return true;
+	}
+
+	void EntryStream::Close() {
+		m_reader = nullptr;
+		m_entry = {};
+		m_solid = false;
+		m_solidBlob = {};
+		m_solidBaseSize = 0;
+		m_solidOffset = 0;
+		m_size = 0;
+		m_position = 0;
+		m_segmentCount = 0;
+		m_segment = 0;
+		m_segmentOpen = false;
+		m_packed = {};
+		m_input = {};
+		m_skip = 0;
+	}
+
+	bool EntryStream::IsOpen() const {
+		return m_reader != nullptr;
+	}
+	uint64_t EntryStream::GetSize() const {
+		return m_size;
+	}
+	uint64_t EntryStream::GetPosition() const {
+		return m_position;
+	}
+	bool EntryStream::IsEnd() const {
+		return m_position >= m_size;
+	}
+
+	// Private methods
+	// ---------------------------------------------------------------------------
+	bool EntryStream::OpenSegment(size_t in_segment) {
+		const compression::zstd::ZstdDictionary* dictionary = m_entry.dictionary;
+
+		if (m_solid) {
+			// Solid blocks are always compressed, without dictionary
+			m_packed = m_solidBlob;
+			m_compressed = true;
+			m_segmentSize = m_solidBaseSize;
+			dictionary = nullptr;
+		}
+		else if (m_entry.chunkRefs) {
+			const FLKChunk& chunk = m_entry.chunks[m_entry.chunkRefs[in_segment]];
+			m_packed = std::span<const uint8_t>(m_entry.archiveData + chunk.offset, static_cast<size_t>(chunk.packedSize));
+			m_compressed = m_entry.compressed && chunk.codec != FLK_CODEC_STORED;
+			m_segmentSize = chunk.baseSize;
+		}
+		else if (m_entry.frames && m_entry.frameCount != 0) {
+			const FLKFrame& frame = m_entry.frames[in_segment];
+			bool last = in_segment + 1 == m_entry.frameCount;
+			uint64_t packedEnd = last ? m_entry.packedSize : m_entry.frames[in_segment + 1].packedOffset;
+			uint64_t baseEnd = last ? m_entry.baseSize : m_entry.frames[in_segment + 1].baseOffset;
+			if (frame.packedOffset > packedEnd || packedEnd > m_entry.packedSize || frame.baseOffset > baseEnd || baseEnd > m_entry.baseSize) {
+				std::cout << "Error: Corrupted seek table.\n";
+				return false;
+			}
+
+			m_packed = std::span<const uint8_t>(m_entry.packedData + frame.packedOffset, static_cast<size_t>(packedEnd - frame.packedOffset));
+			m_compressed = m_entry.compressed;
+			m_segmentSize = baseEnd - frame.baseOffset;
+		}
+		else {
+			m_packed = std::span<const uint8_t>(m_entry.packedData, static_cast<size_t>(m_entry.packedSize));
+			m_compressed = m_entry.compressed;
+			m_segmentSize = m_entry.baseSize;
+		}
+
+		m_encrypted = m_entry.session != nullptr;
+		m_segmentDecoded = 0;
+		m_inputDone = false;
+		m_input = {};
+
+		if (m_compressed && !m_decompressor.Begin(dictionary)) {
+			std::cout << "Error: Failed to decode entry data.\n";
+			return false;
+		}
+		if (m_encrypted) {
+			if (!m_decryptor.BeginPull(*m_entry.session, m_packed)) {
+				return false;
+			}
+		}
+		else {
+			m_input = m_packed;
+		}
+
+		m_segmentOpen = true;
+		return true;
+	}
+
+	bool EntryStream::FinishSegment() {
+		m_segmentOpen = false;
+		bool finished = true;
+
+		// Lets zstd read the end of the frame (checksum) once all bytes are out,
+		// any extra decoded byte means the frame is larger than recorded
+		if (m_compressed) {
+			uint8_t extra = 0;
+			while (finished && !m_decompressor.End()) {
+				if (m_input.empty()) {
+					finished = RefillInput() && !(m_input.empty() && m_inputDone);
+					if (!finished) {
+						break;
+					}
+				}
+
+				size_t produced = 0;
+				finished = m_decompressor.Pull(m_input, std::span<uint8_t>(&extra, 1), produced) && produced == 0;
+			}
+		}
+
+		// Nothing may follow, the final chunk of an encrypted blob must be there
+		finished = finished && m_input.empty() && RefillInput() && m_input.empty();
+		finished = finished && m_segmentDecoded == m_segmentSize;
+		if (!finished) {
+			/// TODO
+			/// Handle error: corrupted frame
+			/// Output to console
+			std::cout << "Error: Failed to decode entry data.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool EntryStream::Produce(std::span<uint8_t> out_data, size_t& out_size) {
+		out_size = 0;
+
+		while (out_size == 0) {
+			if (m_input.empty() && !RefillInput()) {
+				return false;
+			}
+
+			if (!m_compressed) {
+				if (m_input.empty()) {
+					break;
+				}
+
+				out_size = std::min(out_data.size(), m_input.size());
+				std::memcpy(out_data.data(), m_input.data(), out_size);
+				m_input = m_input.subspan(out_size);
+			}
+			else {
+				if (!m_decompressor.Pull(m_input, out_data, out_size)) {
+					break;
+				}
+				// Frame over or input exhausted before the segment was complete
+				if (out_size == 0 && (m_decompressor.End() || (m_input.empty() && m_inputDone))) {
+					break;
+				}
+			}
+		}
+
+		if (out_size == 0) {
+			/// TODO
+			/// Handle error: corrupted frame
+			/// Output to console
+			std::cout << "Error: Failed to decode entry data.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool EntryStream::RefillInput() {
+		if (m_inputDone) {
+			return true;
+		}
+
+		// Unencrypted blobs are handed to the decoder whole when the segment opens
+		if (!m_encrypted) {
+			m_inputDone = true;
+			return true;
+		}
+
+		if (!m_decryptor.PullNext(m_input)) {
+			return false;
+		}
+		m_inputDone = m_input.empty();
+		return true;
+	}
+
+} // namespace flakpak::io
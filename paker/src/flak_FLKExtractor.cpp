@@ -0,0 +1,327 @@
+#include <flakpak/flak_FLKExtractor.hpp>
+
+#include <flakpak/flak_PasswordHandler.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace flakpak::data_types;
+
+namespace flakpak {
+#ifdef _WIN32
+    using OutputFile = HANDLE;
+    static const OutputFile FLK_INVALID_OUTPUT = INVALID_HANDLE_VALUE;
+#else
+    using OutputFile = int;
+    static constexpr OutputFile FLK_INVALID_OUTPUT = -1;
+#endif
+
+    static OutputFile OpenOutput(const std::filesystem::path& in_path, bool in_truncate) {
+#ifdef _WIN32
+        return CreateFileW(in_path.c_str(), GENERIC_WRITE, FILE_SHARE_WRITE, nullptr,
+            in_truncate ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+#else
+        return ::open(in_path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (in_truncate ? O_TRUNC : 0), 0644);
+#endif
+    }
+
+    static bool CloseOutput(OutputFile in_file) {
+#ifdef _WIN32
+        return CloseHandle(in_file) != 0;
+#else
+        return ::close(in_file) == 0;
+#endif
+    }
+
+    // Sets the final size of a file before its slices are written
+    static bool ResizeOutput(OutputFile in_file, uint64_t in_size) {
+#ifdef _WIN32
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(in_size);
+        return SetFilePointerEx(in_file, size, nullptr, FILE_BEGIN) && SetEndOfFile(in_file);
+#else
+        return ::ftruncate(in_file, static_cast<off_t>(in_size)) == 0;
+#endif
+    }
+
+    // Writes in_size bytes at in_offset, several threads can write the same file
+    static bool WriteAt(OutputFile in_file, const uint8_t* in_data, size_t in_size, uint64_t in_offset) {
+        while (in_size > 0) {
+#ifdef _WIN32
+            OVERLAPPED overlapped {};
+            overlapped.Offset = static_cast<DWORD>(in_offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(in_offset >> 32);
+            DWORD written = 0;
+            if (!WriteFile(in_file, in_data, static_cast<DWORD>(std::min<size_t>(in_size, 1 << 30)), &written, &overlapped) || written == 0) {
+                return false;
+            }
+#else
+            ssize_t written = ::pwrite(in_file, in_data, in_size, static_cast<off_t>(in_offset));
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+#endif
+            in_data += written;
+            in_size -= static_cast<size_t>(written);
+            in_offset += static_cast<uint64_t>(written);
+        }
+
+        return true;
+    }
+
+    bool FLKExtractor::ExtractArchive(const std::filesystem::path& in_archivePath, const std::filesystem::path& in_outDir, const FLK_EXTRACT_OPTIONS& in_options) {
+        auto startTime = std::chrono::steady_clock::now();
+
+        // The password is only used when the archive is encrypted
+        io::FLKArchiveReader reader;
+        if (!reader.Open(in_archivePath, encryption::GetPassword())) {
+            return false;
+        }
+
+        std::vector<size_t> selected;
+        for (size_t i = 0; i < reader.GetEntryCount(); i++) {
+            const std::string& path = reader.GetEntryPath(i);
+
+            bool matches = in_options.filters.empty() || std::any_of(in_options.filters.begin(), in_options.filters.end(),
+                [&path](const std::string& in_filter) { return MatchesFilter(path, in_filter); });
+            if (!matches) {
+                continue;
+            }
+
+            if (!IsSafePath(path)) {
+                /// TODO
+                /// Handle error: entry path outside of the output directory
+                /// Output to console
+                std::cout << "Error: Refusing to extract unsafe entry path: " << path << "\n";
+                return false;
+            }
+            selected.push_back(i);
+        }
+
+        // Directories are created up front, the workers only create files
+        std::set<std::filesystem::path> directories;
+        directories.insert(in_outDir);
+        for (size_t index : selected) {
+            directories.insert((in_outDir / reader.GetEntryPath(index)).parent_path());
+        }
+        for (const std::filesystem::path& directory : directories) {
+            std::error_code ec;
+            std::filesystem::create_directories(directory, ec);
+            if (ec) {
+                /// TODO
+                /// Handle error: failed to create directory
+                /// Output to console
+                std::cout << "Error: Failed to create directory: " << directory.string() << "\n";
+                return false;
+            }
+        }
+
+        // Large entries are cut in slices, their file is created at its final size first
+        std::vector<ExtractTask> tasks;
+        uint64_t totalSize = 0;
+        for (size_t index : selected) {
+            uint64_t size = reader.GetEntrySize(index);
+            totalSize += size;
+
+            if (size <= FLK_EXTRACT_SLICE_SIZE || !CanSlice(reader, index)) {
+                tasks.push_back({ index, 0, size, false });
+                continue;
+            }
+
+            std::filesystem::path outPath = in_outDir / reader.GetEntryPath(index);
+            OutputFile file = OpenOutput(outPath, true);
+            bool created = file != FLK_INVALID_OUTPUT && ResizeOutput(file, size);
+            if (file != FLK_INVALID_OUTPUT) {
+                created = CloseOutput(file) && created;
+            }
+            if (!created) {
+                /// TODO
+                /// Handle error: failed to create output file
+                /// Output to console
+                std::cout << "Error: Failed to create output file: " << outPath.string() << "\n";
+                return false;
+            }
+
+            for (uint64_t offset = 0; offset < size; offset += FLK_EXTRACT_SLICE_SIZE) {
+                tasks.push_back({ index, offset, std::min(FLK_EXTRACT_SLICE_SIZE, size - offset), true });
+            }
+        }
+
+        size_t workerCount = in_options.jobCount != 0 ? in_options.jobCount : std::thread::hardware_concurrency();
+        workerCount = std::clamp<size_t>(workerCount, 1, std::max<size_t>(tasks.size(), 1));
+
+        std::atomic<size_t> nextTask { 0 };
+        std::atomic<bool> failed { false };
+        auto worker = [&]() {
+            // Decoders are not thread safe, each worker keeps its own
+            io::FrameReader frameReader;
+            io::SolidBlockCache solidCache;
+
+            while (!failed.load(std::memory_order_relaxed)) {
+                size_t taskIndex = nextTask.fetch_add(1, std::memory_order_relaxed);
+                if (taskIndex >= tasks.size()) {
+                    break;
+                }
+
+                const ExtractTask& task = tasks[taskIndex];
+                std::filesystem::path outPath = in_outDir / reader.GetEntryPath(task.entry);
+                if (!RunTask(reader, task, outPath, frameReader, solidCache)) {
+                    /// TODO
+                    /// Handle error: failed to extract entry
+                    /// Output to console
+                    std::cout << "Error: Failed to extract " << reader.GetEntryPath(task.entry) << "\n";
+                    failed = true;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t w = 1; w < workerCount; w++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        if (failed) {
+            return false;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        std::cout << "Successfully extracted " << selected.size() << " of " << reader.GetEntryCount() << " files ("
+            << (totalSize >> 20) << " MiB) to " << in_outDir.string() << " in " << seconds << " s\n";
+        return true;
+    }
+
+    bool FLKExtractor::MatchesFilter(std::string_view in_path, std::string_view in_pattern) {
+        // Greedy wildcard match, backtracking to the last '*' on a mismatch
+        size_t p = 0;
+        size_t s = 0;
+        size_t star = std::string_view::npos;
+        size_t starMatch = 0;
+
+        while (s < in_path.size()) {
+            if (p < in_pattern.size() && (in_pattern[p] == '?' || in_pattern[p] == in_path[s])) {
+                p++;
+                s++;
+            }
+            else if (p < in_pattern.size() && in_pattern[p] == '*') {
+                star = p++;
+                starMatch = s;
+            }
+            else if (star != std::string_view::npos) {
+                p = star + 1;
+                s = ++starMatch;
+            }
+            else {
+                return false;
+            }
+        }
+
+        while (p < in_pattern.size() && in_pattern[p] == '*') {
+            p++;
+        }
+        return p == in_pattern.size();
+    }
+
+    // Private methods
+    // ---------------------------------------------------------------------------
+    bool FLKExtractor::IsSafePath(std::string_view in_path) {
+        if (in_path.empty() || in_path.front() == '/' || in_path.find(':') != std::string_view::npos ||
+            in_path.find('\\') != std::string_view::npos) {
+            return false;
+        }
+
+        // Drive letters, UNC shares and rooted paths would replace the output directory
+        std::filesystem::path path(in_path);
+        if (path.has_root_name() || path.has_root_directory()) {
+            return false;
+        }
+
+        size_t begin = 0;
+        while (begin <= in_path.size()) {
+            size_t end = std::min(in_path.find('/', begin), in_path.size());
+            if (in_path.substr(begin, end - begin) == "..") {
+                return false;
+            }
+            begin = end + 1;
+        }
+
+        return true;
+    }
+
+    bool FLKExtractor::CanSlice(const io::FLKArchiveReader& in_reader, size_t in_index) {
+        const FLKEntryInfo& info = in_reader.GetEntryInfo(in_index);
+        if (info.solidBlock != FLK_NOT_SOLID) {
+            return false;
+        }
+
+        return in_reader.IsStoredInPlace(in_index) || info.frameCount > 1 || info.chunkCount > 1;
+    }
+
+    bool FLKExtractor::RunTask(const io::FLKArchiveReader& in_reader,
+        const ExtractTask& in_task,
+        const std::filesystem::path& in_outPath,
+        io::FrameReader& io_frameReader,
+        io::SolidBlockCache& io_solidCache) {
+        OutputFile file = OpenOutput(in_outPath, !in_task.sliced);
+        if (file == FLK_INVALID_OUTPUT) {
+            std::cout << "Error: Failed to create output file: " << in_outPath.string() << "\n";
+            return false;
+        }
+
+        uint64_t writeOffset = in_task.offset;
+        FLKDataSink write = [file, &writeOffset](const uint8_t* in_data, size_t in_size) {
+            if (!WriteAt(file, in_data, in_size, writeOffset)) {
+                return false;
+            }
+            writeOffset += in_size;
+            return true;
+        };
+
+        bool success = true;
+        const FLKEntryRecord& entry = in_reader.GetEntry(in_task.entry);
+        const FLKEntryInfo& info = in_reader.GetEntryInfo(in_task.entry);
+        io::FLK_PACKED_ENTRY packed = in_reader.GetPackedEntry(in_task.entry);
+
+        if (in_task.length == 0) {
+            // Empty file, nothing to decode
+        }
+        else if (info.solidBlock != FLK_NOT_SOLID) {
+            const FLKSolidBlock& block = in_reader.GetSolidBlock(info.solidBlock);
+            const uint8_t* data = nullptr;
+            success = io_solidCache.ReadEntry(info.solidBlock, block, packed.archiveData + block.offset,
+                info.solidOffset, entry.baseSize, packed.session, data) &&
+                write(data + in_task.offset, static_cast<size_t>(in_task.length));
+        }
+        else {
+            success = io_frameReader.ReadRange(packed, in_task.offset, in_task.length, write);
+        }
+
+        success = CloseOutput(file) && success;
+        return success;
+    }
+
+} // namespace flakpak
@@ -2,23 +2,94 @@
 
 #include <flakpak/zstd_Compressor.hpp>
 #include <flakpak/xccp20_Encryptor.hpp>
+#include <flakpak/xccp20_KeySession.hpp>
 #include <flakpak/flak_PasswordHandler.hpp>
 #include <flakpak/flak_PathCompressor.hpp>
+#include <flakpak/flak_PackPipeline.hpp>
+#include <flakpak/flak_FLKWriter.hpp>
+#include <flakpak/flak_MappedFile.hpp>
+#include <flakpak/flak_ContentChunker.hpp>
+#include <flakpak/flak_PathIndex.hpp>
+#include <flakpak/xxh3_Hash.hpp>
+
+#include <libsodium/sodium.h>
 
 #include <memory>
 #include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <map>
+#include <cctype>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <string_view>
 
 using namespace flakpak::data_types;
 
 namespace flakpak {
-	bool FLKPacker::PackUncompressedAndUnencrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath) {
-		// Validate input directory
+    static constexpr uint64_t FLK_DICTIONARY_MAX_ENTRY_SIZE = 128 << 10;    // Larger entries are compressed without a dictionary
+    static constexpr size_t FLK_DICTIONARY_SAMPLE_BUDGET = 8 << 20;         // Sample bytes used to train one dictionary
+    static constexpr size_t FLK_DICTIONARY_MIN_SAMPLES = 8;                 // Groups with fewer entries get no dictionary
+    static constexpr size_t FLK_DICTIONARY_HOLDOUT_STRIDE = 5;              // Every 5th entry of a group is left out of training to measure the gain
+    static constexpr size_t FLK_DICTIONARY_SAMPLE_RATIO = 16;               // Dictionary capacity is 1/16th of the sample bytes...
+    static constexpr size_t FLK_DICTIONARY_MIN_CAPACITY = 1 << 10;          // ...but at least 1 KiB
+    static constexpr size_t FLK_DICTIONARY_MAX_CAPACITY = 112640;           // ...and at most the zstd default (110 KiB)
+    static constexpr uint64_t FLK_SOLID_ENTRY_RATIO = 4;                    // Solid entries are at most 1/4th of the block size
+    static constexpr uint64_t FLK_CODEC_MIN_GAIN_RATIO = 32;                // Compression must save 1/32nd of the size to be kept
+    static constexpr size_t FLK_CODEC_SAMPLE_SIZE = 16 << 10;               // Bytes per sample when estimating compressibility...
+    static constexpr size_t FLK_CODEC_SAMPLE_COUNT = 4;                     // ...taken at evenly spaced offsets
+    static constexpr double FLK_CODEC_LOW_ENTROPY = 6.0;                    // Bits per byte under which data always compresses
+    static constexpr int FLK_CODEC_TRIAL_LEVEL = 1;                         // zstd level of the trial compression
+
+    // Formats that are already compressed, zstd gains next to nothing on them
+    static constexpr const char* FLK_STORED_EXTENSIONS[] = {
+        ".png", ".jpg", ".jpeg", ".gif", ".webp", ".avif",
+        ".ogg", ".opus", ".mp3", ".m4a", ".aac", ".flac",
+        ".mp4", ".m4v", ".webm", ".mkv", ".mov", ".bik", ".bk2",
+        ".zip", ".gz", ".bz2", ".xz", ".zst", ".7z", ".rar", ".lz4", ".br",
+        ".glb", ".flk",
+    };
+
+	bool FLKPacker::PackUncompressedAndUnencrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, size_t in_jobCount) {
+        FLK_PACK_OPTIONS options;
+        options.jobCount = in_jobCount;
+
+        return PackDirectory(in_dirPath, in_outPath, options);
+	}
+    bool FLKPacker::PackCompressedAndUnencrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, int in_compressionLevel, size_t in_jobCount) {
+        FLK_PACK_OPTIONS options;
+        options.compress = true;
+        options.compressionLevel = in_compressionLevel;
+        options.jobCount = in_jobCount;
+
+        return PackDirectory(in_dirPath, in_outPath, options);
+    }
+
+    bool FLKPacker::PackUncompressedAndEncrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, size_t in_jobCount) {
+        FLK_PACK_OPTIONS options;
+        options.encrypt = true;
+        options.jobCount = in_jobCount;
+
+        return PackDirectory(in_dirPath, in_outPath, options);
+    }
+
+    bool FLKPacker::PackCompressedAndEncrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, int in_compressionLevel, size_t in_jobCount) {
+        FLK_PACK_OPTIONS options;
+        options.compress = true;
+        options.encrypt = true;
+        options.compressionLevel = in_compressionLevel;
+        options.jobCount = in_jobCount;
+
+        return PackDirectory(in_dirPath, in_outPath, options);
+    }
+
+    bool FLKPacker::PackDirectory(const std::filesystem::path& in_dirPath, const std::filesystem::path& in_outPath, const FLK_PACK_OPTIONS& in_options) {
+        // Validate input directory
         if (!std::filesystem::exists(in_dirPath) || !std::filesystem::is_directory(in_dirPath)) {
             /// TODO
-			/// Handle error: invalid input directory
-			/// Output to console
-			std::cout << "Error: Invalid input directory.\n";
+            /// Handle error: invalid input directory
+            /// Output to console
+            std::cout << "Error: Invalid input directory.\n";
             return false;
         }
 
@@ -27,511 +98,1337 @@ namespace flakpak {
         /// TODO
         /// If debug flag enabled output to console the file count
 
-        if (fileCount > MAX_FLK_HEADER_ENTRIES) {
-			/// TODO
-			/// Handle error: too many files
+        // Only the version 1 header has a fixed number of entries
+        if (in_options.formatVersion == FLK_FORMAT_VERSION_1 && fileCount > MAX_FLK_HEADER_ENTRIES) {
+            /// TODO
+            /// Handle error: too many files
             /// Output to console
-			std::cout << "Error: Too many files in directory. Maximum allowed is " << MAX_FLK_HEADER_ENTRIES << ".\n";
+            std::cout << "Error: Too many files in directory. Maximum allowed is " << MAX_FLK_HEADER_ENTRIES << " with format version 1, use --format 2 for larger archives.\n";
+            return false;
+        }
+        if (fileCount > std::numeric_limits<uint32_t>::max()) {
+            std::cout << "Error: Too many files in directory.\n";
             return false;
         }
 
-        // Initialize header
-        auto header = std::make_unique<data_types::FLKHeader>();
+        if ((in_options.blobAlignment & (in_options.blobAlignment - 1)) != 0) {
+            /// TODO
+            /// Handle error: invalid alignment
+            /// Output to console
+            std::cout << "Error: Blob alignment must be a power of two.\n";
+            return false;
+        }
 
-        std::vector<std::vector<uint8_t>> blobs;
-        size_t entryIndex = 0;
+        if (in_options.compress && !compression::zstd::ZstdStreamCompressor::ValidateParams(in_options.zstdParams)) {
+            return false;
+        }
 
-        // Process files
-        for (auto& entry : std::filesystem::recursive_directory_iterator(in_dirPath)) {
-            if (!std::filesystem::is_regular_file(entry)) continue;
+        // Scan and validate every file before doing any work
+        std::vector<FLK_PACK_JOB> jobs;
+        if (!CollectPackJobs(in_dirPath, in_options, jobs)) {
+            return false;
+        }
 
-            std::filesystem::path rel = std::filesystem::relative(entry.path(), in_dirPath);
-            std::string relPathStr = rel.string();
-            auto fileSize = std::filesystem::file_size(entry.path());
+        // Known compressed formats are stored as is
+        for (auto& job : jobs) {
+            job.codec = SelectCodec(job, in_options);
+        }
 
-            if (!ValidateFLKConstraints(relPathStr, fileSize)) {
-                return false;
-            }
+        // Identical files are packed once, later copies share the blob of the first.
+        // Blobs carry their own subkey id and nonce, so sharing one is fine encrypted.
+        if (in_options.deduplicate) {
+            size_t duplicateCount = FindDuplicates(jobs);
 
             /// TODO
-			/// If debug flag enabled output to console the file being processed
-            std::cout << "Processing: " << relPathStr << "\n";
+            /// If debug flag enabled output to console the duplicate count
+            if (duplicateCount > 0) {
+                std::cout << "Deduplicated " << duplicateCount << " identical files\n";
+            }
+        }
 
-            try {
-                // Read file data directly
-                auto fileData = ReadFileData(entry.path());
+        // Small entries are grouped into solid blocks, each block is packed
+        // as a single blob like a regular entry
+        std::vector<std::vector<size_t>> solidBlocks;
+        if (in_options.compress && in_options.solidBlockSize > 0) {
+            BuildSolidBlocks(jobs, in_options, solidBlocks);
+        }
 
-                // Fill entry
-                data_types::FLKEntry& flkEntry = header->entries[entryIndex];
-                std::strncpy(flkEntry.path, relPathStr.c_str(), MAX_FILE_PATH_LENGTH - 1);
-                flkEntry.path[MAX_FILE_PATH_LENGTH - 1] = '\0';
-                flkEntry.baseSize = fileSize;
-                flkEntry.packedSize = fileSize;
+        // Larger entries become lists of chunks, each distinct chunk is packed once
+        std::vector<FLK_CHUNK_JOB> chunkJobs;
+        std::vector<std::vector<uint32_t>> entryChunks(jobs.size());
+        // Checksums of the original and packed bytes of every entry
+        std::vector<FLKEntryChecksum> entryChecksums(jobs.size());
+        if (in_options.chunkSize > 0) {
+            if (!BuildChunkStore(jobs, in_options, chunkJobs, entryChunks, entryChecksums)) {
+                return false;
+            }
+        }
 
-                blobs.push_back(std::move(fileData));
-                entryIndex++;
+        // Packing units: the solid blocks first, then the chunks and every entry stored on its own
+        std::vector<size_t> looseJobs;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (jobs[i].solidBlock == FLK_NOT_SOLID && jobs[i].duplicateOf == FLK_NOT_DUPLICATE && !jobs[i].chunked) {
+                looseJobs.push_back(i);
             }
-            catch (const std::exception& ex) {
-				/// TODO
-				/// Handle error: file processing failed
-				/// Output to console
-                std::cerr << "Error processing file " << relPathStr << ": " << ex.what() << "\n";
+        }
+        size_t firstChunkUnit = solidBlocks.size();
+        size_t firstLooseUnit = firstChunkUnit + chunkJobs.size();
+        std::vector<FLKSolidBlock> solidBlockTable(solidBlocks.size());
+        std::vector<FLKChunk> chunkTable(chunkJobs.size());
+        std::vector<uint64_t> chunkChecksums(chunkJobs.size());
+        // Seek tables of the entries split into frames
+        std::vector<std::vector<FLKFrame>> entryFrames(jobs.size());
+        // Codec every entry was packed with, solid members keep the one of the job
+        std::vector<uint32_t> entryCodecs(jobs.size());
+        for (size_t i = 0; i < jobs.size(); i++) {
+            entryCodecs[i] = jobs[i].codec;
+        }
+
+        // Dictionaries are trained before packing, every entry of a group
+        // is compressed with the prepared CDict of its group
+        std::vector<std::unique_ptr<compression::zstd::ZstdDictionary>> dictionaries;
+        if (in_options.compress && in_options.trainDictionaries) {
+            if (!TrainDictionaries(jobs, in_options, dictionaries)) {
                 return false;
             }
         }
 
-        OptimizeUnusedEntries(header.get(), static_cast<uint32_t>(entryIndex));
+        // Location and sizes of every entry, written to the header once everything is packed
+        std::vector<FLKEntryRecord> entries(jobs.size());
 
-        header->entryCount = static_cast<uint32_t>(entryIndex);
+        pipeline::PackPipeline packPipeline(in_options.jobCount);
 
-        // Calculate offsets
-        uint64_t currentOffset = sizeof(data_types::FLKHeader);
-        for (uint32_t i = 0; i < header->entryCount; i++) {
-            header->entries[i].offset = currentOffset;
-            currentOffset += blobs[i].size();
+        // One compressor/encryptor per worker so no state is shared across
+        // threads, the last pair belongs to the committer (large entries)
+        size_t committerIndex = packPipeline.GetWorkerCount();
+        std::vector<compression::zstd::ZstdStreamCompressor> compressors(committerIndex + 1);
+        std::vector<encryption::xccp20::XChaCha20Poly1305StreamEncryptor> encryptors(committerIndex + 1);
+        for (auto& compressor : compressors) {
+            compressor.SetLargeInputParams(in_options.zstdParams);
         }
 
-        // Generate output path
-        std::filesystem::path outputPath = in_outPath;
-
-        // Write file
-        std::vector<uint8_t> emptySalt;
-        if (!WriteFLKFile(outputPath, header.get(), blobs, emptySalt)) {
-            return false;
-        }
+        // Stretch the password once for the whole archive, entries only
+        // derive a cheap subkey from the session master key
+        encryption::xccp20::XChaCha20Poly1305KeySession keySession;
+        size_t headerRegionSize = sizeof(data_types::FLKHeader);
+        uint32_t saltLen = 0;
+        if (in_options.encrypt) {
+            uint32_t expectedMs = 0;
+            FLKKdfParams kdfParams = in_options.kdfTargetMs > 0
+                ? encryption::xccp20::XChaCha20Poly1305KeySession::Calibrate(in_options.kdfTargetMs, expectedMs)
+                : encryption::xccp20::XChaCha20Poly1305KeySession::GetDefaultParams();
 
-		/// TODO
-		/// If debug flag enabled output to console the summary
-        std::cout << "Successfully packed " << header->entryCount << " files to " << outputPath.string() << "\n";
-		return true;
-	}
-    bool FLKPacker::PackCompressedAndUnencrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, int in_compressionLevel) {
-        // Validate input directory
-        if (!std::filesystem::exists(in_dirPath) || !std::filesystem::is_directory(in_dirPath)) {
             /// TODO
-            /// Handle error: invalid input directory
-            /// Output to console
-            return false;
-        }
+            /// If debug flag enabled output to console the KDF limits
+            if (in_options.kdfTargetMs > 0) {
+                std::cout << "KDF: Argon2id calibrated to " << kdfParams.opsLimit << " passes, "
+                    << (kdfParams.memLimit >> 20) << " MiB, about " << expectedMs << " ms (target "
+                    << in_options.kdfTargetMs << " ms)\n";
+                if (expectedMs < in_options.kdfTargetMs / 2) {
+                    std::cout << "KDF: Target not reachable within the Argon2id bounds, using the largest limits\n";
+                }
+            }
 
-        // Count files
-        size_t fileCount = CountFilesInDirectory(in_dirPath);
-        /// TODO
-        /// If debug flag enabled output to console the file count
+            if (!keySession.Create(encryption::GetPassword(), kdfParams)) {
+                return false;
+            }
 
-        if (fileCount > MAX_FLK_HEADER_ENTRIES) {
-            /// TODO
-            /// Handle error: too many files
-            /// Output to console
+            saltLen = static_cast<uint32_t>(keySession.GetSalt().size());
+            headerRegionSize += keySession.GetSalt().size() + sizeof(FLKKdfParams);
+        }
+
+        // Blobs are streamed to disk as they are committed. Seekable outputs
+        // reserve the header region now and patch it once every offset is
+        // known, stdout and pipes get the header in the trailer instead.
+        // Version 2 headers grow with the entries and always go to the trailer.
+        io::FLKArchiveWriter writer;
+        bool streamed = in_options.formatVersion == FLK_FORMAT_VERSION_2 || in_options.stream ||
+            io::FLKArchiveWriter::RequiresStream(in_outPath);
+        bool opened = streamed
+            ? writer.OpenStream(in_outPath, in_options.formatVersion)
+            : writer.Open(in_outPath, headerRegionSize);
+        if (!opened) {
             return false;
         }
+        writer.SetAlignment(in_options.blobAlignment);
 
-        // Initialize header
-        auto header = std::make_unique<data_types::FLKHeader>();
+        // Dictionaries go first so a reader has them before the entries
+        for (size_t i = 0; i < dictionaries.size(); i++) {
+            if (!WriteSection(writer, FLK_SECTION_DICTIONARY, static_cast<uint32_t>(i + 1), dictionaries[i]->GetData(),
+                in_options.encrypt ? &keySession : nullptr, encryptors[committerIndex])) {
+                writer.Abort();
+                return false;
+            }
+        }
 
-		// Initialize compression library
-        auto compressor = std::make_unique<compression::zstd::ZstdCompressor>();
+        auto getDictionary = [&dictionaries](const FLK_PACK_JOB& in_job) -> const compression::zstd::ZstdDictionary* {
+            return in_job.dictionaryId != FLK_NO_DICTIONARY ? dictionaries[in_job.dictionaryId - 1].get() : nullptr;
+        };
 
-        std::vector<std::vector<uint8_t>> blobs;
-        size_t entryIndex = 0;
+        // Runs on the workers: read, compress and encrypt a single file or solid block
+        auto processEntry = [&](size_t in_workerIndex, size_t in_unitIndex, FLK_PACK_RESULT& out_result) -> bool {
+            try {
+                FLKDataSink sink = [&out_result](const uint8_t* in_data, size_t in_size) {
+                    out_result.data.insert(out_result.data.end(), in_data, in_data + in_size);
+                    return true;
+                };
+
+                // The blob is hashed while it is still hot in the cache
+                auto hashBlob = [&out_result](bool in_success) {
+                    out_result.packedChecksum = checksum::xxh3::Xxh3Hasher::Hash(out_result.data.data(), out_result.data.size());
+                    return in_success;
+                };
+
+                if (in_unitIndex < firstChunkUnit) {
+                    return hashBlob(PackSolidBlock(jobs, solidBlocks[in_unitIndex], in_options, keySession,
+                        compressors[in_workerIndex], encryptors[in_workerIndex], sink, out_result.baseSize, out_result.memberChecksums, out_result.error));
+                }
+                if (in_unitIndex < firstLooseUnit) {
+                    const FLK_CHUNK_JOB& chunk = chunkJobs[in_unitIndex - firstChunkUnit];
+                    out_result.baseSize = chunk.size;
+                    return hashBlob(PackChunk(jobs, chunk, in_options, keySession,
+                        compressors[in_workerIndex], encryptors[in_workerIndex], sink, out_result.codec, out_result.error));
+                }
 
-        // Process files
-        for (auto& entry : std::filesystem::recursive_directory_iterator(in_dirPath)) {
-            if (!std::filesystem::is_regular_file(entry)) continue;
+                const FLK_PACK_JOB& job = jobs[looseJobs[in_unitIndex - firstLooseUnit]];
 
-            std::filesystem::path rel = std::filesystem::relative(entry.path(), in_dirPath);
-            std::string relPathStr = rel.string();
-            auto fileSize = std::filesystem::file_size(entry.path());
+                // Large entries are packed by the committer straight into the archive
+                out_result.baseSize = job.fileSize;
+                if (job.streamed) {
+                    return true;
+                }
 
-            std::string compressedPath = pathcom::PathCompressor::CompressPath(relPathStr);
+                if (!in_options.compress || job.codec == FLK_CODEC_STORED) {
+                    out_result.data.reserve(in_options.encrypt
+                        ? encryption::xccp20::XChaCha20Poly1305StreamEncryptor::GetEncryptedSize(job.fileSize)
+                        : job.fileSize);
+                }
 
-            if (compressedPath.length() >= MAX_FILE_PATH_LENGTH) {
-                std::cerr << "Error: Compressed path too long: " << relPathStr
-                    << " -> " << compressedPath << " (" << compressedPath.length() << " chars)\n";
-                return false;
+                return hashBlob(PackEntryData(job, in_options, keySession, getDictionary(job),
+                    compressors[in_workerIndex], encryptors[in_workerIndex], sink, out_result.frames, out_result.codec,
+                    out_result.baseChecksum, out_result.error));
             }
-
-            if (!ValidateFLKConstraints(relPathStr, fileSize)) {
+            catch (const std::exception& ex) {
+                out_result.error = ex.what();
                 return false;
             }
+        };
+
+        // Fills the header entry of a file, the location of its data is set by the caller
+        auto fillEntry = [&](size_t in_jobIndex) -> FLKEntryRecord& {
+            const FLK_PACK_JOB& job = jobs[in_jobIndex];
 
             /// TODO
             /// If debug flag enabled output to console the file being processed
-            std::cout << "Processing: " << relPathStr << "\n";
+            if (job.entryPath != job.relPath) {
+                std::cout << "Processing: " << job.relPath << " -> " << job.entryPath << " (saved " << (job.relPath.length() - job.entryPath.length()) << " bytes)\n";
+            }
+            else {
+                std::cout << "Processing: " << job.relPath << "\n";
+            }
 
-            try {
-				// Compress the data in place to save memory
-                auto compressionResult = compressor->CompressData(entry.path(), in_compressionLevel);
+            FLKEntryRecord& flkEntry = entries[in_jobIndex];
+            flkEntry.baseSize = job.fileSize;
+
+            return flkEntry;
+        };
+
+        // Runs on this thread in unit order: fill the entries and write the blob
+        auto commitEntry = [&](size_t in_unitIndex, FLK_PACK_RESULT& in_result) -> bool {
+            if (in_unitIndex < firstChunkUnit) {
+                if (in_result.failed) {
+                    /// TODO
+                    /// Handle error: block processing failed
+                    /// Output to console
+                    std::cerr << "Error processing solid block " << in_unitIndex << ": " << in_result.error << "\n";
+                    return false;
+                }
+
+                // Every member points at the shared block blob
+                FLKSolidBlock& block = solidBlockTable[in_unitIndex];
+                block.packedSize = in_result.data.size();
+                block.baseSize = in_result.baseSize;
+                if (!writer.AppendBlob(in_result.data.data(), in_result.data.size(), block.offset)) {
+                    return false;
+                }
 
-                // Fill entry
-                FLKEntry& flkEntry = header->entries[entryIndex];
-                
-				OptimizePathPadding(flkEntry.path, compressedPath);
-                flkEntry.baseSize = compressionResult.originalSize;
-                flkEntry.packedSize = compressionResult.data.size();
+                const std::vector<size_t>& members = solidBlocks[in_unitIndex];
+                for (size_t m = 0; m < members.size(); m++) {
+                    FLKEntryRecord& flkEntry = fillEntry(members[m]);
+                    flkEntry.offset = block.offset;
+                    flkEntry.packedSize = block.packedSize;
+                    entryChecksums[members[m]] = { in_result.memberChecksums[m], in_result.packedChecksum };
+                }
+                return true;
+            }
+
+            if (in_unitIndex < firstLooseUnit) {
+                const FLK_CHUNK_JOB& chunkJob = chunkJobs[in_unitIndex - firstChunkUnit];
+                if (in_result.failed) {
+                    /// TODO
+                    /// Handle error: chunk processing failed
+                    /// Output to console
+                    std::cerr << "Error processing file " << jobs[chunkJob.jobIndex].relPath << ": " << in_result.error << "\n";
+                    return false;
+                }
 
-                blobs.push_back(std::move(compressionResult.data));
-                entryIndex++;
+                FLKChunk& chunk = chunkTable[in_unitIndex - firstChunkUnit];
+                chunk.packedSize = in_result.data.size();
+                chunk.baseSize = chunkJob.size;
+                chunk.codec = in_result.codec;
+                chunkChecksums[in_unitIndex - firstChunkUnit] = in_result.packedChecksum;
+                return writer.AppendBlob(in_result.data.data(), in_result.data.size(), chunk.offset);
             }
-            catch (const std::exception& ex) {
+
+            size_t jobIndex = looseJobs[in_unitIndex - firstLooseUnit];
+            const FLK_PACK_JOB& job = jobs[jobIndex];
+
+            if (in_result.failed) {
                 /// TODO
                 /// Handle error: file processing failed
                 /// Output to console
-                std::cerr << "Error processing file " << relPathStr << ": " << ex.what() << "\n";
+                std::cerr << "Error processing file " << job.relPath << ": " << in_result.error << "\n";
                 return false;
             }
+
+            FLKEntryRecord& flkEntry = fillEntry(jobIndex);
+
+            if (job.streamed) {
+                if (!writer.AlignBlob()) {
+                    return false;
+                }
+                flkEntry.offset = writer.GetCurrentOffset();
+
+                checksum::xxh3::Xxh3Hasher packedHasher;
+                FLKDataSink sink = [&writer, &packedHasher](const uint8_t* in_data, size_t in_size) {
+                    packedHasher.Update(in_data, in_size);
+                    return writer.AppendData(in_data, in_size);
+                };
+                std::string error;
+                if (!PackEntryData(job, in_options, keySession, getDictionary(job),
+                    compressors[committerIndex], encryptors[committerIndex], sink, entryFrames[jobIndex], entryCodecs[jobIndex],
+                    entryChecksums[jobIndex].base, error)) {
+                    /// TODO
+                    /// Handle error: file processing failed
+                    /// Output to console
+                    std::cerr << "Error processing file " << job.relPath << ": " << error << "\n";
+                    return false;
+                }
+
+                flkEntry.packedSize = writer.GetCurrentOffset() - flkEntry.offset;
+                entryChecksums[jobIndex].packed = packedHasher.Digest();
+                return true;
+            }
+
+            flkEntry.packedSize = in_result.data.size();
+            entryChecksums[jobIndex] = { in_result.baseChecksum, in_result.packedChecksum };
+            entryFrames[jobIndex] = std::move(in_result.frames);
+            entryCodecs[jobIndex] = in_result.codec;
+            return writer.AppendBlob(in_result.data.data(), in_result.data.size(), flkEntry.offset);
+        };
+
+        if (!packPipeline.Run(firstLooseUnit + looseJobs.size(), processEntry, commitEntry)) {
+            writer.Abort();
+            return false;
         }
 
-        OptimizeUnusedEntries(header.get(), static_cast<uint32_t>(entryIndex));
+        // Chunked entries start at their first chunk, the packed size counts every chunk they use
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (!jobs[i].chunked) {
+                continue;
+            }
 
-        header->entryCount = static_cast<uint32_t>(entryIndex);
+            FLKEntryRecord& flkEntry = fillEntry(i);
+            flkEntry.offset = chunkTable[entryChunks[i].front()].offset;
+            flkEntry.packedSize = 0;
+            checksum::xxh3::Xxh3Hasher packedHasher;
+            for (uint32_t chunkIndex : entryChunks[i]) {
+                flkEntry.packedSize += chunkTable[chunkIndex].packedSize;
 
-        // Calculate offsets
-        uint64_t currentOffset = sizeof(data_types::FLKHeader);
-        for (uint32_t i = 0; i < header->entryCount; i++) {
-            header->entries[i].offset = currentOffset;
-            currentOffset += blobs[i].size();
+                std::array<uint8_t, sizeof(uint64_t)> chunkChecksum {};
+                for (size_t b = 0; b < chunkChecksum.size(); b++) {
+                    chunkChecksum[b] = static_cast<uint8_t>(chunkChecksums[chunkIndex] >> (8 * b));
+                }
+                packedHasher.Update(chunkChecksum.data(), chunkChecksum.size());
+            }
+            entryChecksums[i].packed = packedHasher.Digest();
+            // Every chunk has its own codec
+            entryCodecs[i] = FLK_CODEC_ARCHIVE;
         }
 
-        // Generate output path
-        std::filesystem::path outputPath = in_outPath;
+        // Copies point at the blob of their first occurrence, which is packed by now
+        for (size_t i = 0; i < jobs.size(); i++) {
+            size_t source = jobs[i].duplicateOf;
+            if (source == FLK_NOT_DUPLICATE) {
+                continue;
+            }
 
-        // Write file
-        std::vector<uint8_t> emptySalt;
-        if (!WriteFLKFile(outputPath, header.get(), blobs, emptySalt)) {
-            return false;
+            FLKEntryRecord& flkEntry = fillEntry(i);
+            flkEntry.offset = entries[source].offset;
+            flkEntry.packedSize = entries[source].packedSize;
+            entryCodecs[i] = entryCodecs[source];
+            entryChecksums[i] = entryChecksums[source];
         }
 
-        /// TODO
-        /// If debug flag enabled output to console the summary
-        std::cout << "Successfully packed " << header->entryCount << " files to " << outputPath.string() << "\n";
-        return true;
-    }
+        if (!solidBlockTable.empty()) {
+            std::vector<uint8_t> payload(solidBlockTable.size() * sizeof(FLKSolidBlock));
+            std::memcpy(payload.data(), solidBlockTable.data(), payload.size());
 
-    bool FLKPacker::PackUncompressedAndEncrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath) {
-        // Validate input directory
-        if (!std::filesystem::exists(in_dirPath) || !std::filesystem::is_directory(in_dirPath)) {
-            /// TODO
-            /// Handle error: invalid input directory
-            /// Output to console
-            return false;
+            if (!WriteSection(writer, FLK_SECTION_SOLID_BLOCKS, 0, payload, nullptr, encryptors[committerIndex])) {
+                writer.Abort();
+                return false;
+            }
         }
 
-        // Count files
-        size_t fileCount = CountFilesInDirectory(in_dirPath);
-        /// TODO
-        /// If debug flag enabled output to console the file count
+        // Seek tables of every framed entry, back to back in entry order
+        std::vector<FLKFrame> frameTable;
+        std::vector<uint32_t> firstFrames(jobs.size(), 0);
+        for (size_t i = 0; i < jobs.size(); i++) {
+            firstFrames[i] = static_cast<uint32_t>(frameTable.size());
+            frameTable.insert(frameTable.end(), entryFrames[i].begin(), entryFrames[i].end());
+        }
+        if (!frameTable.empty()) {
+            std::vector<uint8_t> payload(frameTable.size() * sizeof(FLKFrame));
+            std::memcpy(payload.data(), frameTable.data(), payload.size());
 
-        if (fileCount > MAX_FLK_HEADER_ENTRIES) {
-            /// TODO
-            /// Handle error: too many files
-            /// Output to console
-            return false;
+            if (!WriteSection(writer, FLK_SECTION_FRAMES, 0, payload, nullptr, encryptors[committerIndex])) {
+                writer.Abort();
+                return false;
+            }
+        }
+
+        // Chunk store and the chunk list of every chunked entry, back to back in entry order
+        std::vector<uint32_t> chunkRefs;
+        std::vector<uint32_t> firstChunks(jobs.size(), 0);
+        for (size_t i = 0; i < jobs.size(); i++) {
+            firstChunks[i] = static_cast<uint32_t>(chunkRefs.size());
+            chunkRefs.insert(chunkRefs.end(), entryChunks[i].begin(), entryChunks[i].end());
+        }
+        if (!chunkTable.empty()) {
+            std::vector<uint8_t> payload(chunkTable.size() * sizeof(FLKChunk));
+            std::memcpy(payload.data(), chunkTable.data(), payload.size());
+            std::vector<uint8_t> refsPayload(chunkRefs.size() * sizeof(uint32_t));
+            std::memcpy(refsPayload.data(), chunkRefs.data(), refsPayload.size());
+
+            if (!WriteSection(writer, FLK_SECTION_CHUNKS, 0, payload, nullptr, encryptors[committerIndex]) ||
+                !WriteSection(writer, FLK_SECTION_CHUNK_REFS, 0, refsPayload, nullptr, encryptors[committerIndex])) {
+                writer.Abort();
+                return false;
+            }
         }
 
-        // Initialize header
-        auto header = std::make_unique<data_types::FLKHeader>();
+        bool mixedCodecs = in_options.compress &&
+            std::find(entryCodecs.begin(), entryCodecs.end(), FLK_CODEC_STORED) != entryCodecs.end();
+
+        // Per-entry dictionary ids, solid locations, seek tables, codecs and chunk lists, only needed when used
+        if (!dictionaries.empty() || !solidBlocks.empty() || !frameTable.empty() || mixedCodecs || !chunkTable.empty()) {
+            FLKEntryInfoTable table;
+            table.stride = sizeof(FLKEntryInfo);
+            table.count = static_cast<uint32_t>(jobs.size());
+
+            std::vector<uint8_t> payload(sizeof(FLKEntryInfoTable) + jobs.size() * sizeof(FLKEntryInfo));
+            std::memcpy(payload.data(), &table, sizeof(table));
+            for (size_t i = 0; i < jobs.size(); i++) {
+                // Copies share everything with the entry they point at
+                size_t source = jobs[i].duplicateOf != FLK_NOT_DUPLICATE ? jobs[i].duplicateOf : i;
+
+                FLKEntryInfo info;
+                info.dictionaryId = jobs[source].dictionaryId;
+                info.solidBlock = jobs[source].solidBlock;
+                info.solidOffset = jobs[source].solidOffset;
+                info.firstFrame = firstFrames[source];
+                info.frameCount = static_cast<uint32_t>(entryFrames[source].size());
+                info.codec = entryCodecs[source];
+                info.firstChunk = firstChunks[source];
+                info.chunkCount = static_cast<uint32_t>(entryChunks[source].size());
+                std::memcpy(payload.data() + sizeof(FLKEntryInfoTable) + i * sizeof(FLKEntryInfo), &info, sizeof(info));
+            }
 
-		// Initialize encryption library
-        auto encryptor = std::make_unique<encryption::xccp20::XChaCha20Poly1305Encryptor>();
+            if (!WriteSection(writer, FLK_SECTION_ENTRY_INFO, 0, payload, nullptr, encryptors[committerIndex])) {
+                writer.Abort();
+                return false;
+            }
+        }
 
-        std::vector<std::vector<uint8_t>> blobs;
-        std::vector<uint8_t> globalSalt;
-        bool firstFile = true;
-        size_t entryIndex = 0;
+        // Perfect hash of the entry paths, readers resolve a path without building a table
+        if (!jobs.empty()) {
+            std::vector<std::string> paths;
+            paths.reserve(jobs.size());
+            for (const auto& job : jobs) {
+                std::string path = job.relPath;
+                std::replace(path.begin(), path.end(), '\\', '/');
+                paths.push_back(std::move(path));
+            }
 
-        // Process files
-        for (auto& entry : std::filesystem::recursive_directory_iterator(in_dirPath)) {
-            if (!std::filesystem::is_regular_file(entry)) continue;
+            std::vector<uint8_t> payload;
+            if (!pathcom::PathIndex::Build(paths, payload) ||
+                !WriteSection(writer, FLK_SECTION_PATH_INDEX, 0, payload, nullptr, encryptors[committerIndex])) {
+                writer.Abort();
+                return false;
+            }
+        }
+
+        // Checksums are encrypted with the archive, they would tell which files it holds
+        if (!jobs.empty()) {
+            FLKChecksumTable table;
+            table.stride = sizeof(FLKEntryChecksum);
+            table.count = static_cast<uint32_t>(jobs.size());
+
+            std::vector<uint8_t> payload(sizeof(FLKChecksumTable) + entryChecksums.size() * sizeof(FLKEntryChecksum));
+            std::memcpy(payload.data(), &table, sizeof(table));
+            std::memcpy(payload.data() + sizeof(FLKChecksumTable), entryChecksums.data(), entryChecksums.size() * sizeof(FLKEntryChecksum));
 
-            std::filesystem::path rel = std::filesystem::relative(entry.path(), in_dirPath);
-            std::string relPathStr = rel.string();
-            auto fileSize = std::filesystem::file_size(entry.path());
+            if (!WriteSection(writer, FLK_SECTION_CHECKSUMS, 0, payload,
+                in_options.encrypt ? &keySession : nullptr, encryptors[committerIndex])) {
+                writer.Abort();
+                return false;
+            }
+        }
 
-            if (!ValidateFLKConstraints(relPathStr, fileSize)) {
+        uint32_t archiveFlags = 0;
+        if (in_options.compress) {
+            archiveFlags |= FLK_FLAG_COMPRESSED;
+            if (in_options.formatVersion == FLK_FORMAT_VERSION_1) {
+                archiveFlags |= FLK_FLAG_COMPRESSED_PATHS;
+            }
+        }
+        if (in_options.encrypt) {
+            archiveFlags |= FLK_FLAG_ENCRYPTED | FLK_FLAG_CHUNKED_ENCRYPTION;
+        }
+        if (!solidBlocks.empty()) {
+            archiveFlags |= FLK_FLAG_SOLID;
+        }
+        if (!frameTable.empty()) {
+            archiveFlags |= FLK_FLAG_FRAMED;
+        }
+        if (mixedCodecs) {
+            archiveFlags |= FLK_FLAG_ENTRY_CODECS;
+        }
+        if (!chunkTable.empty()) {
+            archiveFlags |= FLK_FLAG_CHUNKED;
+        }
+        if (!jobs.empty()) {
+            archiveFlags |= FLK_FLAG_PATH_INDEX | FLK_FLAG_CHECKSUMS;
+        }
+
+        // Header region: header, then the global salt and KDF parameters (if encrypted),
+        // then the entry and string tables of version 2 archives
+        std::vector<uint8_t> headerRegion;
+        std::vector<uint8_t> tables;
+        if (in_options.formatVersion == FLK_FORMAT_VERSION_1) {
+            auto header = std::make_unique<data_types::FLKHeader>();
+            header->saltLen = saltLen;
+            BuildHeaderV1(jobs, entries, in_options, *header);
+
+            const uint8_t* headerData = reinterpret_cast<const uint8_t*>(header.get());
+            headerRegion.assign(headerData, headerData + sizeof(data_types::FLKHeader));
+        }
+        else {
+            FLKHeaderV2 header;
+            header.saltLen = saltLen;
+            if (!BuildEntryTables(jobs, entries, in_options, compressors[committerIndex], header, tables)) {
+                writer.Abort();
                 return false;
             }
 
-            /// TODO
-            /// If debug flag enabled output to console the file being processed
-            std::cout << "Processing: " << relPathStr << "\n";
+            const uint8_t* headerData = reinterpret_cast<const uint8_t*>(&header);
+            headerRegion.assign(headerData, headerData + sizeof(FLKHeaderV2));
+        }
+        if (in_options.encrypt) {
+            const auto& salt = keySession.GetSalt();
+            const auto& kdfParams = keySession.GetParams();
+            const uint8_t* kdfData = reinterpret_cast<const uint8_t*>(&kdfParams);
+            headerRegion.insert(headerRegion.end(), salt.begin(), salt.end());
+            headerRegion.insert(headerRegion.end(), kdfData, kdfData + sizeof(FLKKdfParams));
+        }
+        headerRegion.insert(headerRegion.end(), tables.begin(), tables.end());
 
-            try {
-				// Read file data directly and encrypt
-                auto fileData = ReadFileData(entry.path());
-                auto encryptionResult = encryptor->EncryptData(fileData, encryption::GetPassword());
-
-				// Store the salt from the first file as global salt
-                if (firstFile) {
-                    globalSalt = encryptionResult.salt;
-                    firstFile = false;
-                }
+        // Write the header with the final offsets and sizes
+        if (!writer.Finalize(headerRegion.data(), headerRegion.size(), archiveFlags)) {
+            return false;
+        }
 
-                // Fill entry
-                FLKEntry& flkEntry = header->entries[entryIndex];
-                std::strncpy(flkEntry.path, relPathStr.c_str(), MAX_FILE_PATH_LENGTH - 1);
-                flkEntry.path[MAX_FILE_PATH_LENGTH - 1] = '\0';
-                flkEntry.baseSize = fileSize;
-                flkEntry.packedSize = encryptionResult.data.size();
+        /// TODO
+        /// If debug flag enabled output to console the summary
+        if (in_options.blobAlignment > 1) {
+            uint64_t archiveSize = writer.GetCurrentOffset();
+            std::cout << "Alignment padding: " << writer.GetPaddingSize() << " bytes ("
+                << (archiveSize > 0 ? 100.0 * writer.GetPaddingSize() / archiveSize : 0.0) << "% of the archive)\n";
+        }
+        std::cout << "Successfully packed " << jobs.size() << " files to " << in_outPath.string() << "\n";
+        return true;
+    }
 
-                blobs.push_back(std::move(encryptionResult.data));
-                entryIndex++;
+    size_t FLKPacker::CountFilesInDirectory(const std::filesystem::path& in_dirPath) {
+        size_t count = 0;
+        for (auto& entry : std::filesystem::recursive_directory_iterator(in_dirPath)) {
+            if (std::filesystem::is_regular_file(entry)) {
+                count++;
             }
-            catch (const std::exception& ex) {
-                /// TODO
-                /// Handle error: file processing failed
-                /// Output to console
-                std::cerr << "Error processing file " << relPathStr << ": " << ex.what() << "\n";
+        }
+        return count;
+    }
+
+    bool FLKPacker::CollectPackJobs(const std::filesystem::path& in_dirPath, const FLK_PACK_OPTIONS& in_options, std::vector<FLK_PACK_JOB>& out_jobs) {
+        out_jobs.clear();
+
+        for (auto& entry : std::filesystem::recursive_directory_iterator(in_dirPath)) {
+            if (!std::filesystem::is_regular_file(entry)) continue;
+
+            FLK_PACK_JOB job;
+            job.sourcePath = entry.path();
+            job.relPath = std::filesystem::relative(entry.path(), in_dirPath).string();
+            job.fileSize = std::filesystem::file_size(entry.path());
+
+            // Only version 1 compressed archives store substitution-compressed
+            // paths, version 2 archives share path strings in the string table
+            if (in_options.formatVersion == FLK_FORMAT_VERSION_2) {
+                std::replace(job.relPath.begin(), job.relPath.end(), '\\', '/');
+                job.entryPath = job.relPath;
+            }
+            else if (in_options.compress) {
+                job.entryPath = pathcom::PathCompressor::CompressPath(job.relPath);
+
+                if (job.entryPath.length() >= MAX_FILE_PATH_LENGTH) {
+                    std::cerr << "Error: Compressed path too long: " << job.relPath
+                        << " -> " << job.entryPath << " (" << job.entryPath.length() << " chars)\n";
+                    return false;
+                }
+            }
+            else {
+                job.entryPath = job.relPath;
+            }
+
+            if (in_options.formatVersion == FLK_FORMAT_VERSION_1 && !ValidateFLKConstraints(job.relPath)) {
                 return false;
             }
+
+            // Too large to hold in memory while waiting for the committer
+            job.streamed = job.fileSize > FLK_STREAM_ENTRY_THRESHOLD;
+
+            out_jobs.push_back(std::move(job));
         }
 
-        OptimizeUnusedEntries(header.get(), static_cast<uint32_t>(entryIndex));
+        // Directory iteration order is unspecified, sort so every run
+        // (serial or parallel) produces the same entry order
+        std::sort(out_jobs.begin(), out_jobs.end(), [](const FLK_PACK_JOB& in_a, const FLK_PACK_JOB& in_b) {
+            return in_a.relPath < in_b.relPath;
+        });
 
-        header->entryCount = static_cast<uint32_t>(entryIndex);
-        header->saltLen = static_cast<uint32_t>(globalSalt.size());
+        return true;
+    }
 
-        // Calculate offsets
-        uint64_t currentOffset = sizeof(data_types::FLKHeader);
-        for (uint32_t i = 0; i < header->entryCount; i++) {
-            header->entries[i].offset = currentOffset;
-            currentOffset += blobs[i].size();
+    bool FLKPacker::PackEntryData(const FLK_PACK_JOB& in_job,
+        const FLK_PACK_OPTIONS& in_options,
+        const encryption::xccp20::XChaCha20Poly1305KeySession& in_session,
+        const compression::zstd::ZstdDictionary* in_dictionary,
+        compression::zstd::ZstdStreamCompressor& in_compressor,
+        encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor,
+        const FLKDataSink& in_sink,
+        std::vector<FLKFrame>& out_frames,
+        uint32_t& out_codec,
+        uint64_t& out_baseChecksum,
+        std::string& out_error) {
+        // The file is mapped and handed to zstd/libsodium in place
+        io::MappedFile file;
+        if (!file.Open(in_job.sourcePath)) {
+            out_error = "failed to open file";
+            return false;
         }
+        // The size was recorded when scanning, the entry would not match its header
+        if (file.GetSize() != in_job.fileSize) {
+            out_error = "file changed while packing";
+            return false;
+        }
+        out_baseChecksum = checksum::xxh3::Xxh3Hasher::Hash(file.GetData(), file.GetSize());
+
+        // Data that does not compress is stored, readers then use it as is
+        out_codec = in_job.codec;
+        if (in_options.compress && in_options.detectCodec) {
+            bool compress = IsWorthCompressing(file.GetData(), file.GetSize(), in_job.codec == FLK_CODEC_STORED, in_compressor);
+            out_codec = compress ? FLK_CODEC_ZSTD : FLK_CODEC_STORED;
+        }
+
+        FLK_PACK_OPTIONS entryOptions = in_options;
+        entryOptions.compress = in_options.compress && out_codec != FLK_CODEC_STORED;
 
-        // Generate output path
-        std::filesystem::path outputPath = in_outPath;
+        // Split into frames when there is something to decode per frame
+        bool framed = entryOptions.frameSize > 0 && (entryOptions.compress || entryOptions.encrypt) &&
+            file.GetSize() > entryOptions.frameSize;
+        if (framed) {
+            return PackFrames(file.GetData(), file.GetSize(), entryOptions, in_session, in_dictionary,
+                in_compressor, in_encryptor, in_sink, out_frames, out_error);
+        }
 
-        // Write file
-        std::vector<uint8_t> emptySalt;
-        if (!WriteFLKFile(outputPath, header.get(), blobs, emptySalt)) {
+        // One-shot entries fall back to stored once the compressed size is known
+        bool stored = false;
+        if (!PackData(file.GetData(), file.GetSize(), in_job.streamed, entryOptions, in_session, in_dictionary,
+            in_compressor, in_encryptor, in_sink, out_error, entryOptions.compress && in_options.detectCodec ? &stored : nullptr)) {
             return false;
         }
+        if (stored) {
+            out_codec = FLK_CODEC_STORED;
+        }
 
-        /// TODO
-        /// If debug flag enabled output to console the summary
-        std::cout << "Successfully packed " << header->entryCount << " files to " << outputPath.string() << "\n";
         return true;
     }
 
-    bool FLKPacker::PackCompressedAndEncrypted(std::filesystem::path in_dirPath, std::filesystem::path in_outPath, int in_compressionLevel) {
-        // Validate input directory
-        if (!std::filesystem::exists(in_dirPath) || !std::filesystem::is_directory(in_dirPath)) {
-            /// TODO
-            /// Handle error: invalid input directory
-            /// Output to console
+    bool FLKPacker::PackFrames(const uint8_t* in_data, uint64_t in_size,
+        const FLK_PACK_OPTIONS& in_options,
+        const encryption::xccp20::XChaCha20Poly1305KeySession& in_session,
+        const compression::zstd::ZstdDictionary* in_dictionary,
+        compression::zstd::ZstdStreamCompressor& in_compressor,
+        encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor,
+        const FLKDataSink& in_sink,
+        std::vector<FLKFrame>& out_frames,
+        std::string& out_error) {
+        out_frames.clear();
+
+        uint64_t packedOffset = 0;
+        FLKDataSink countingSink = [&packedOffset, &in_sink](const uint8_t* in_piece, size_t in_pieceSize) {
+            packedOffset += in_pieceSize;
+            return in_sink(in_piece, in_pieceSize);
+        };
+
+        // Every frame is a complete zstd frame (and secretstream) of its own,
+        // only one frame of output is held in memory at a time
+        for (uint64_t baseOffset = 0; baseOffset < in_size; baseOffset += in_options.frameSize) {
+            FLKFrame frame;
+            frame.baseOffset = baseOffset;
+            frame.packedOffset = packedOffset;
+            out_frames.push_back(frame);
+
+            uint64_t frameSize = std::min<uint64_t>(in_options.frameSize, in_size - baseOffset);
+            if (!PackData(in_data + baseOffset, frameSize, false, in_options, in_session, in_dictionary,
+                in_compressor, in_encryptor, countingSink, out_error)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool FLKPacker::PackChunk(const std::vector<FLK_PACK_JOB>& in_jobs,
+        const FLK_CHUNK_JOB& in_chunk,
+        const FLK_PACK_OPTIONS& in_options,
+        const encryption::xccp20::XChaCha20Poly1305KeySession& in_session,
+        compression::zstd::ZstdStreamCompressor& in_compressor,
+        encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor,
+        const FLKDataSink& in_sink,
+        uint32_t& out_codec,
+        std::string& out_error) {
+        const FLK_PACK_JOB& job = in_jobs[in_chunk.jobIndex];
+
+        io::MappedFile file;
+        if (!file.Open(job.sourcePath)) {
+            out_error = "failed to open file";
             return false;
         }
+        if (file.GetSize() != job.fileSize) {
+            out_error = "file changed while packing";
+            return false;
+        }
+        const uint8_t* data = file.GetData() + in_chunk.offset;
 
-        // Count files
-        size_t fileCount = CountFilesInDirectory(in_dirPath);
-        /// TODO
-        /// If debug flag enabled output to console the file count
+        // Chunks of compressed formats are usually stored, like whole entries
+        out_codec = in_options.compress ? FLK_CODEC_ZSTD : FLK_CODEC_ARCHIVE;
+        if (in_options.compress && in_options.detectCodec &&
+            !IsWorthCompressing(data, in_chunk.size, job.codec == FLK_CODEC_STORED, in_compressor)) {
+            out_codec = FLK_CODEC_STORED;
+        }
 
-        if (fileCount > MAX_FLK_HEADER_ENTRIES) {
-            /// TODO
-            /// Handle error: too many files
-            /// Output to console
+        FLK_PACK_OPTIONS chunkOptions = in_options;
+        chunkOptions.compress = out_codec == FLK_CODEC_ZSTD;
+
+        bool stored = false;
+        if (!PackData(data, in_chunk.size, false, chunkOptions, in_session, nullptr,
+            in_compressor, in_encryptor, in_sink, out_error, chunkOptions.compress && in_options.detectCodec ? &stored : nullptr)) {
             return false;
         }
+        if (stored) {
+            out_codec = FLK_CODEC_STORED;
+        }
 
-        // Initialize header
-        auto header = std::make_unique<data_types::FLKHeader>();
+        return true;
+    }
 
-		// Initialize compression library
-		auto compressor = std::make_unique<compression::zstd::ZstdCompressor>();
-		// Initialize encryption library
-		auto encryptor = std::make_unique<encryption::xccp20::XChaCha20Poly1305Encryptor>();
+    bool FLKPacker::PackSolidBlock(const std::vector<FLK_PACK_JOB>& in_jobs,
+        const std::vector<size_t>& in_members,
+        const FLK_PACK_OPTIONS& in_options,
+        const encryption::xccp20::XChaCha20Poly1305KeySession& in_session,
+        compression::zstd::ZstdStreamCompressor& in_compressor,
+        encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor,
+        const FLKDataSink& in_sink,
+        uint64_t& out_baseSize,
+        std::vector<uint64_t>& out_memberChecksums,
+        std::string& out_error) {
+        // Members are laid out back to back at the offsets assigned by BuildSolidBlocks
+        std::vector<uint8_t> block;
+        out_memberChecksums.clear();
+        for (size_t jobIndex : in_members) {
+            const FLK_PACK_JOB& job = in_jobs[jobIndex];
+
+            io::MappedFile file;
+            if (!file.Open(job.sourcePath)) {
+                out_error = "failed to open file " + job.relPath;
+                return false;
+            }
+            if (file.GetSize() != job.fileSize || block.size() != job.solidOffset) {
+                out_error = "file changed while packing: " + job.relPath;
+                return false;
+            }
 
-        std::vector<std::vector<uint8_t>> blobs;
-        std::vector<uint8_t> globalSalt;
-        bool firstFile = true;
-        size_t entryIndex = 0;
+            block.insert(block.end(), file.GetData(), file.GetData() + file.GetSize());
+            out_memberChecksums.push_back(checksum::xxh3::Xxh3Hasher::Hash(file.GetData(), file.GetSize()));
+        }
 
-        // Process files
-        for (auto& entry : std::filesystem::recursive_directory_iterator(in_dirPath)) {
-            if (!std::filesystem::is_regular_file(entry)) continue;
+        out_baseSize = block.size();
+        return PackData(block.data(), block.size(), false, in_options, in_session, nullptr,
+            in_compressor, in_encryptor, in_sink, out_error);
+    }
 
-            std::filesystem::path rel = std::filesystem::relative(entry.path(), in_dirPath);
-            std::string relPathStr = rel.string();
-            auto fileSize = std::filesystem::file_size(entry.path());
+    bool FLKPacker::PackData(const uint8_t* in_data, uint64_t in_size, bool in_incremental,
+        const FLK_PACK_OPTIONS& in_options,
+        const encryption::xccp20::XChaCha20Poly1305KeySession& in_session,
+        const compression::zstd::ZstdDictionary* in_dictionary,
+        compression::zstd::ZstdStreamCompressor& in_compressor,
+        encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor,
+        const FLKDataSink& in_sink,
+        std::string& out_error,
+        bool* out_stored) {
+        // Chain: data -> compressor -> encryptor -> sink
+        FLKDataSink encryptSink = [&](const uint8_t* in_piece, size_t in_pieceSize) {
+            return in_encryptor.Push(in_piece, in_pieceSize, in_sink);
+        };
+        const FLKDataSink& packedSink = in_options.encrypt ? encryptSink : in_sink;
+
+        FLKDataSink compressSink = [&](const uint8_t* in_piece, size_t in_pieceSize) {
+            return in_compressor.Push(in_piece, in_pieceSize, packedSink);
+        };
+        const FLKDataSink& inputSink = in_options.compress ? compressSink : packedSink;
+
+        if (in_options.encrypt && !in_encryptor.Begin(in_session, in_sink)) {
+            out_error = "encryption failed";
+            return false;
+        }
 
-            std::string compressedPath = pathcom::PathCompressor::CompressPath(relPathStr);
+        if (in_options.compress && !in_incremental) {
+            // The whole frame reaches the sink at once, it is replaced by the
+            // original data when it does not save enough
+            FLKDataSink frameSink = [&](const uint8_t* in_frame, size_t in_frameSize) {
+                if (out_stored && !PaysOff(in_size, in_frameSize)) {
+                    *out_stored = true;
+                    return packedSink(in_data, static_cast<size_t>(in_size));
+                }
+                return packedSink(in_frame, in_frameSize);
+            };
 
-            if (compressedPath.length() >= MAX_FILE_PATH_LENGTH) {
-                std::cerr << "Error: Compressed path too long: " << relPathStr
-                    << " -> " << compressedPath << " (" << compressedPath.length() << " chars)\n";
+            // Fits in memory: a single ZSTD_compress2 call into a presized buffer
+            if (!in_compressor.Compress(in_data, static_cast<size_t>(in_size), in_options.compressionLevel, frameSink, in_dictionary)) {
+                out_error = "compression failed";
+                return false;
+            }
+        }
+        else {
+            if (in_options.compress && !in_compressor.Begin(in_options.compressionLevel, in_size, in_dictionary)) {
+                out_error = "compression failed";
                 return false;
             }
 
-            if (!ValidateFLKConstraints(relPathStr, fileSize)) {
+            // The whole input is pushed at once, zstd and the encryptor walk
+            // it in place and only buffer their own output
+            if (in_size > 0 && !inputSink(in_data, static_cast<size_t>(in_size))) {
+                out_error = "failed to pack file data";
                 return false;
             }
 
-            /// TODO
-            /// If debug flag enabled output to console the file being processed
-            std::cout << "Processing: " << relPathStr << " -> " << compressedPath << " (saved " << (relPathStr.length() - compressedPath.length()) << " bytes)\n";
+            if (in_options.compress && !in_compressor.End(packedSink)) {
+                out_error = "compression failed";
+                return false;
+            }
+        }
 
-            try {
-				// Compress and then encrypt the data in place to save memory
-                auto compressionResult = compressor->CompressData(entry.path(), in_compressionLevel);
-                auto encryptionResult = encryptor->EncryptData(compressionResult.data, encryption::GetPassword());
-
-				// Store the salt from the first file as global salt
-                if (firstFile) {
-                    globalSalt = encryptionResult.salt;
-                    firstFile = false;
+        if (in_options.encrypt && !in_encryptor.End(in_sink)) {
+            out_error = "encryption failed";
+            return false;
+        }
+
+        return true;
+    }
+
+    size_t FLKPacker::FindDuplicates(std::vector<FLK_PACK_JOB>& io_jobs) {
+        if (sodium_init() < 0) {
+            return 0;
+        }
+
+        // Only files sharing their size with another one can be identical
+        std::map<uint64_t, std::vector<size_t>> sizeGroups;
+        for (size_t i = 0; i < io_jobs.size(); i++) {
+            sizeGroups[io_jobs[i].fileSize].push_back(i);
+        }
+
+        size_t duplicateCount = 0;
+        for (const auto& [size, members] : sizeGroups) {
+            if (members.size() < 2) {
+                continue;
+            }
+
+            // Members are in job order, the first job with a digest owns the blob
+            std::map<std::array<uint8_t, crypto_generichash_BYTES>, size_t> firstCopies;
+            for (size_t jobIndex : members) {
+                std::array<uint8_t, crypto_generichash_BYTES> digest {};
+                if (size > 0) {
+                    io::MappedFile file;
+                    if (!file.Open(io_jobs[jobIndex].sourcePath)) {
+                        // Reported when the entry gets packed
+                        continue;
+                    }
+                    crypto_generichash(digest.data(), digest.size(), file.GetData(), file.GetSize(), nullptr, 0);
                 }
 
-				// Fill entry
-                FLKEntry& flkEntry = header->entries[entryIndex];
+                auto [firstCopy, inserted] = firstCopies.emplace(digest, jobIndex);
+                if (!inserted) {
+                    io_jobs[jobIndex].duplicateOf = firstCopy->second;
+                    duplicateCount++;
+                }
+            }
+        }
+
+        return duplicateCount;
+    }
+
+    bool FLKPacker::BuildChunkStore(std::vector<FLK_PACK_JOB>& io_jobs,
+        const FLK_PACK_OPTIONS& in_options,
+        std::vector<FLK_CHUNK_JOB>& out_chunks,
+        std::vector<std::vector<uint32_t>>& out_entryChunks,
+        std::vector<FLKEntryChecksum>& io_entryChecksums) {
+        out_chunks.clear();
+        out_entryChunks.assign(io_jobs.size(), {});
 
-                OptimizePathPadding(flkEntry.path, compressedPath);
-                //std::strncpy(flkEntry.path, relPathStr.c_str(), MAX_FILE_PATH_LENGTH - 1);
-                //flkEntry.path[MAX_FILE_PATH_LENGTH - 1] = '\0';
-                
-                flkEntry.baseSize = compressionResult.originalSize;
-                flkEntry.packedSize = encryptionResult.data.size();
+        if (sodium_init() < 0) {
+            std::cout << "Error: Failed to initialize libsodium.\n";
+            return false;
+        }
 
-                blobs.push_back(std::move(encryptionResult.data));
-                entryIndex++;
+        dedup::ContentChunker chunker(in_options.chunkSize);
+        std::map<std::array<uint8_t, crypto_generichash_BYTES>, uint32_t> chunkIndices;
+        std::vector<uint32_t> chunkSizes;
+        uint64_t chunkedBytes = 0;
+        uint64_t storedBytes = 0;
+
+        for (size_t i = 0; i < io_jobs.size(); i++) {
+            FLK_PACK_JOB& job = io_jobs[i];
+            // Small entries, solid members and copies are packed as they are
+            if (job.fileSize <= chunker.GetAverageSize() || job.solidBlock != FLK_NOT_SOLID || job.duplicateOf != FLK_NOT_DUPLICATE) {
+                continue;
             }
-            catch (const std::exception& ex) {
+
+            io::MappedFile file;
+            if (!file.Open(job.sourcePath)) {
                 /// TODO
-                /// Handle error: file processing failed
+                /// Handle error: failed to open file
                 /// Output to console
-                std::cerr << "Error processing file " << relPathStr << ": " << ex.what() << "\n";
+                std::cout << "Error: Failed to open file: " << job.relPath << "\n";
                 return false;
             }
-        }
 
-        OptimizeUnusedEntries(header.get(), static_cast<uint32_t>(entryIndex));
+            chunker.Split(file.GetData(), file.GetSize(), chunkSizes);
+            io_entryChecksums[i].base = checksum::xxh3::Xxh3Hasher::Hash(file.GetData(), file.GetSize());
 
-        header->entryCount = static_cast<uint32_t>(entryIndex);
-        header->saltLen = static_cast<uint32_t>(globalSalt.size());
+            uint64_t offset = 0;
+            for (uint32_t size : chunkSizes) {
+                std::array<uint8_t, crypto_generichash_BYTES> digest {};
+                crypto_generichash(digest.data(), digest.size(), file.GetData() + offset, size, nullptr, 0);
 
-        // Calculate offsets
-        uint64_t currentOffset = sizeof(data_types::FLKHeader);
-        for (uint32_t i = 0; i < header->entryCount; i++) {
-            header->entries[i].offset = currentOffset;
-            currentOffset += blobs[i].size();
-        }
-
-        // Generate output path
-        std::filesystem::path outputPath = in_outPath;
+                auto [chunk, inserted] = chunkIndices.emplace(digest, static_cast<uint32_t>(out_chunks.size()));
+                if (inserted) {
+                    out_chunks.push_back({ i, offset, size });
+                    storedBytes += size;
+                }
+                out_entryChunks[i].push_back(chunk->second);
+                offset += size;
+            }
 
-        // Write file
-        std::vector<uint8_t> emptySalt;
-        if (!WriteFLKFile(outputPath, header.get(), blobs, emptySalt)) {
-            return false;
+            // Chunks are small packing units, the entry is never streamed whole
+            job.chunked = true;
+            job.streamed = false;
+            chunkedBytes += job.fileSize;
         }
 
         /// TODO
-        /// If debug flag enabled output to console the summary
-        std::cout << "Successfully packed " << header->entryCount << " files to " << outputPath.string() << "\n";
+        /// If debug flag enabled output to console the chunk store summary
+        if (chunkedBytes > 0) {
+            std::cout << "Chunk store: " << out_chunks.size() << " distinct chunks, "
+                << (storedBytes >> 10) << " KiB out of " << (chunkedBytes >> 10) << " KiB\n";
+        }
+
         return true;
     }
 
-    std::vector<uint8_t> FLKPacker::ReadFileData(const std::filesystem::path& in_filePath) {
-        std::ifstream file(in_filePath, std::ios::binary | std::ios::ate);
-        if (!file) {
-            /// TODO Change this to output to console instead
-			std::cout << "Failed to open file: " << in_filePath.string() << "\n";
+    void FLKPacker::BuildSolidBlocks(std::vector<FLK_PACK_JOB>& io_jobs,
+        const FLK_PACK_OPTIONS& in_options,
+        std::vector<std::vector<size_t>>& out_blocks) {
+        out_blocks.clear();
+
+        // Entries up to a quarter of the block size are grouped, so reading
+        // one of them never decodes much more than a block
+        uint64_t maxEntrySize = in_options.solidBlockSize / FLK_SOLID_ENTRY_RATIO;
+        std::vector<size_t> candidates;
+        for (size_t i = 0; i < io_jobs.size(); i++) {
+            const FLK_PACK_JOB& job = io_jobs[i];
+            if (!job.streamed && job.fileSize <= maxEntrySize && job.codec != FLK_CODEC_STORED && job.duplicateOf == FLK_NOT_DUPLICATE) {
+                candidates.push_back(i);
+            }
         }
 
-        auto fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
+        // Similar files end up next to each other in the same window
+        std::stable_sort(candidates.begin(), candidates.end(), [&io_jobs](size_t in_a, size_t in_b) {
+            std::string groupA = GetEntryGroup(io_jobs[in_a], FLK_DICTIONARY_GROUPING::EXTENSION);
+            std::string groupB = GetEntryGroup(io_jobs[in_b], FLK_DICTIONARY_GROUPING::EXTENSION);
+            return groupA != groupB ? groupA < groupB : io_jobs[in_a].relPath < io_jobs[in_b].relPath;
+        });
+
+        uint64_t blockSize = 0;
+        for (size_t jobIndex : candidates) {
+            if (out_blocks.empty() || blockSize >= in_options.solidBlockSize) {
+                out_blocks.emplace_back();
+                blockSize = 0;
+            }
 
-        std::vector<uint8_t> data(fileSize);
-        file.read(reinterpret_cast<char*>(data.data()), fileSize);
+            FLK_PACK_JOB& job = io_jobs[jobIndex];
+            job.solidBlock = static_cast<uint32_t>(out_blocks.size() - 1);
+            job.solidOffset = blockSize;
 
-        if (!file) {
-            /// TODO Change this to output to console instead
-			std::cout << "Failed to read file: " << in_filePath.string() << "\n";
+            out_blocks.back().push_back(jobIndex);
+            blockSize += job.fileSize;
         }
-
-        return data;
     }
-    size_t FLKPacker::CountFilesInDirectory(const std::filesystem::path& in_dirPath) {
-        size_t count = 0;
-        for (auto& entry : std::filesystem::recursive_directory_iterator(in_dirPath)) {
-            if (std::filesystem::is_regular_file(entry)) {
-                count++;
+
+    bool FLKPacker::TrainDictionaries(std::vector<FLK_PACK_JOB>& io_jobs,
+        const FLK_PACK_OPTIONS& in_options,
+        std::vector<std::unique_ptr<compression::zstd::ZstdDictionary>>& out_dictionaries) {
+        out_dictionaries.clear();
+
+        // Only small entries are grouped, larger ones compress fine on their own
+        // and entries of solid blocks already share their compression window
+        std::map<std::string, std::vector<size_t>> groups;
+        for (size_t i = 0; i < io_jobs.size(); i++) {
+            const FLK_PACK_JOB& job = io_jobs[i];
+            if (job.fileSize > 0 && job.fileSize <= FLK_DICTIONARY_MAX_ENTRY_SIZE && job.solidBlock == FLK_NOT_SOLID &&
+                job.codec != FLK_CODEC_STORED && job.duplicateOf == FLK_NOT_DUPLICATE && !job.chunked) {
+                groups[GetEntryGroup(job, in_options.dictionaryGrouping)].push_back(i);
             }
         }
-        return count;
-    }
 
-    bool FLKPacker::ValidateFLKConstraints(const std::string& in_relPath, size_t in_fileSize) {
-        if (in_relPath.length() >= MAX_FILE_PATH_LENGTH) {
+        compression::zstd::ZstdStreamCompressor compressor;
+        for (const auto& [group, members] : groups) {
+            if (members.size() < FLK_DICTIONARY_MIN_SAMPLES) {
+                continue;
+            }
+
+            // Samples are stored back to back, as expected by ZDICT_trainFromBuffer.
+            // A dictionary always fits the samples it was trained on, so the
+            // held out entries are the only fair measure of its gain
+            std::vector<uint8_t> samples;
+            std::vector<size_t> sampleSizes;
+            std::vector<uint8_t> heldOut;
+            std::vector<size_t> heldOutSizes;
+            uint64_t groupSize = 0;
+            for (size_t k = 0; k < members.size(); k++) {
+                const FLK_PACK_JOB& job = io_jobs[members[k]];
+                groupSize += job.fileSize;
+
+                bool holdOut = k % FLK_DICTIONARY_HOLDOUT_STRIDE == FLK_DICTIONARY_HOLDOUT_STRIDE - 1;
+                std::vector<uint8_t>& buffer = holdOut ? heldOut : samples;
+                std::vector<size_t>& bufferSizes = holdOut ? heldOutSizes : sampleSizes;
+                if (buffer.size() + job.fileSize > FLK_DICTIONARY_SAMPLE_BUDGET) {
+                    continue;
+                }
+
+                io::MappedFile file;
+                if (!file.Open(job.sourcePath)) {
+                    return false;
+                }
+                buffer.insert(buffer.end(), file.GetData(), file.GetData() + file.GetSize());
+                bufferSizes.push_back(static_cast<size_t>(file.GetSize()));
+            }
+
+            size_t capacity = std::clamp<size_t>(samples.size() / FLK_DICTIONARY_SAMPLE_RATIO,
+                FLK_DICTIONARY_MIN_CAPACITY, FLK_DICTIONARY_MAX_CAPACITY);
+
+            auto dictionary = std::make_unique<compression::zstd::ZstdDictionary>();
+            if (!dictionary->Train(samples, sampleSizes, capacity)) {
+                /// TODO
+                /// If debug flag enabled output to console the skipped group
+                std::cout << "Dictionary: not enough samples for group '" << group << "', skipped\n";
+                continue;
+            }
+            if (!dictionary->PrepareCompression(in_options.compressionLevel)) {
+                std::cout << "Error: Failed to prepare dictionary for group: " << group << "\n";
+                return false;
+            }
+
+            // The dictionary is stored in the archive, keep it only if the gain
+            // on the held out entries, scaled to the group, beats its own size
+            uint64_t plainSize = 0;
+            uint64_t dictionarySize = 0;
+            FLKDataSink countPlain = [&plainSize](const uint8_t*, size_t in_size) { plainSize += in_size; return true; };
+            FLKDataSink countDictionary = [&dictionarySize](const uint8_t*, size_t in_size) { dictionarySize += in_size; return true; };
+            size_t sampleOffset = 0;
+            for (size_t sampleSize : heldOutSizes) {
+                const uint8_t* sample = heldOut.data() + sampleOffset;
+                if (!compressor.Compress(sample, sampleSize, in_options.compressionLevel, countPlain) ||
+                    !compressor.Compress(sample, sampleSize, in_options.compressionLevel, countDictionary, dictionary.get())) {
+                    std::cout << "Error: Failed to evaluate dictionary for group: " << group << "\n";
+                    return false;
+                }
+                sampleOffset += sampleSize;
+            }
+            double groupGain = heldOut.empty() || dictionarySize >= plainSize ? 0.0
+                : static_cast<double>(plainSize - dictionarySize) * static_cast<double>(groupSize) / static_cast<double>(heldOut.size());
+            if (groupGain <= static_cast<double>(dictionary->GetData().size())) {
+                /// TODO
+                /// If debug flag enabled output to console the skipped group
+                std::cout << "Dictionary: no gain for group '" << group << "', skipped\n";
+                continue;
+            }
+
+            uint32_t dictionaryId = static_cast<uint32_t>(out_dictionaries.size() + 1);
+            for (size_t jobIndex : members) {
+                io_jobs[jobIndex].dictionaryId = dictionaryId;
+            }
+
             /// TODO
-			/// Handle error: file path too long
-            /// Output to console
-			std::cout << "Error: File path too long: " << in_relPath << "\n";
+            /// If debug flag enabled output to console the trained dictionary
+            std::cout << "Dictionary " << dictionaryId << ": group '" << group << "', " << members.size() << " entries, "
+                << dictionary->GetData().size() << " bytes, held out entries " << plainSize << " -> " << dictionarySize << " bytes\n";
+
+            out_dictionaries.push_back(std::move(dictionary));
+        }
+
+        return true;
+    }
+
+    uint32_t FLKPacker::SelectCodec(const FLK_PACK_JOB& in_job, const FLK_PACK_OPTIONS& in_options) {
+        if (!in_options.compress) {
+            return FLK_CODEC_ARCHIVE;
+        }
+        if (!in_options.detectCodec) {
+            return FLK_CODEC_ZSTD;
+        }
+
+        std::string extension = GetEntryGroup(in_job, FLK_DICTIONARY_GROUPING::EXTENSION);
+        bool compressedFormat = std::any_of(std::begin(FLK_STORED_EXTENSIONS), std::end(FLK_STORED_EXTENSIONS),
+            [&extension](const char* in_extension) {
+                return extension == in_extension;
+            });
+
+        return compressedFormat ? FLK_CODEC_STORED : FLK_CODEC_ZSTD;
+    }
+
+    bool FLKPacker::IsWorthCompressing(const uint8_t* in_data, uint64_t in_size, bool in_compressedFormat,
+        compression::zstd::ZstdStreamCompressor& in_compressor) {
+        // Small entries are sampled whole
+        size_t sampleCount = FLK_CODEC_SAMPLE_COUNT;
+        size_t sampleSize = FLK_CODEC_SAMPLE_SIZE;
+        if (in_size <= FLK_CODEC_SAMPLE_SIZE * FLK_CODEC_SAMPLE_COUNT) {
+            // Cheaper to compress once and check the result
+            if (!in_compressedFormat) {
+                return true;
+            }
+            sampleCount = 1;
+            sampleSize = static_cast<size_t>(in_size);
+        }
+        if (sampleSize == 0) {
             return false;
         }
+        uint64_t stride = sampleCount > 1 ? (in_size - sampleSize) / (sampleCount - 1) : 0;
+
+        // Order-0 entropy of the samples, low entropy data always compresses
+        std::array<uint64_t, 256> histogram {};
+        for (size_t sample = 0; sample < sampleCount; sample++) {
+            const uint8_t* data = in_data + sample * stride;
+            for (size_t i = 0; i < sampleSize; i++) {
+                histogram[data[i]]++;
+            }
+        }
 
-        // Check file size constraint
-        if (in_fileSize > MAX_FILE_SIZE) {
-            /// TODO
-			/// Handle error: file too large
-            /// Output to console
-			std::cout << "Error: File too large: " << in_relPath << "\n";
+        double entropy = 0.0;
+        double total = static_cast<double>(sampleSize * sampleCount);
+        for (uint64_t count : histogram) {
+            if (count > 0) {
+                double probability = count / total;
+                entropy -= probability * std::log2(probability);
+            }
+        }
+        if (entropy < FLK_CODEC_LOW_ENTROPY) {
+            return true;
+        }
+        // Known compressed formats are trusted once the entropy agrees
+        if (in_compressedFormat) {
             return false;
         }
 
-		return true;
+        // High entropy can still hide repetitions, a fast trial settles it
+        uint64_t compressedSize = 0;
+        FLKDataSink countSink = [&compressedSize](const uint8_t*, size_t in_size) {
+            compressedSize += in_size;
+            return true;
+        };
+        for (size_t sample = 0; sample < sampleCount; sample++) {
+            if (!in_compressor.Compress(in_data + sample * stride, sampleSize, FLK_CODEC_TRIAL_LEVEL, countSink)) {
+                return true;
+            }
+        }
+
+        return PaysOff(sampleSize * sampleCount, compressedSize);
     }
 
-    bool FLKPacker::WriteFLKFile(const std::filesystem::path& in_outPath,
-        data_types::FLKHeader* in_header,
-        const std::vector<std::vector<uint8_t>>& in_fileBlobs,
-        const std::vector<uint8_t>& in_globalSalt) {
+    bool FLKPacker::PaysOff(uint64_t in_size, uint64_t in_compressedSize) {
+        return in_compressedSize + in_size / FLK_CODEC_MIN_GAIN_RATIO < in_size;
+    }
 
-        std::ofstream out(in_outPath, std::ios::binary);
-        if (!out) {
-            /// TODO
-			/// Handle error: failed to create output file
-			/// Output to console
-			std::cout << "Error: Failed to create output file: " << in_outPath.string() << "\n";
+    std::string FLKPacker::GetEntryGroup(const FLK_PACK_JOB& in_job, FLK_DICTIONARY_GROUPING in_grouping) {
+        std::filesystem::path relPath(in_job.relPath);
+
+        if (in_grouping == FLK_DICTIONARY_GROUPING::DIRECTORY) {
+            return relPath.parent_path().generic_string();
+        }
+
+        std::string extension = relPath.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char in_c) {
+            return static_cast<char>(std::tolower(in_c));
+        });
+        return extension;
+    }
+
+    bool FLKPacker::WriteSection(io::FLKArchiveWriter& in_writer,
+        uint32_t in_type, uint32_t in_id,
+        const std::vector<uint8_t>& in_payload,
+        const encryption::xccp20::XChaCha20Poly1305KeySession* in_session,
+        encryption::xccp20::XChaCha20Poly1305StreamEncryptor& in_encryptor) {
+        if (!in_session) {
+            return in_writer.AppendSection(in_type, in_id, 0, in_payload.data(), in_payload.size());
+        }
+
+        // Sealed like an entry blob, with its own subkey id
+        std::vector<uint8_t> sealed;
+        sealed.reserve(encryption::xccp20::XChaCha20Poly1305StreamEncryptor::GetEncryptedSize(in_payload.size()));
+        FLKDataSink sink = [&sealed](const uint8_t* in_data, size_t in_size) {
+            sealed.insert(sealed.end(), in_data, in_data + in_size);
+            return true;
+        };
+
+        if (!in_encryptor.Begin(*in_session, sink) ||
+            !in_encryptor.Push(in_payload.data(), in_payload.size(), sink) ||
+            !in_encryptor.End(sink)) {
             return false;
         }
 
-        // Write header
-        out.write(reinterpret_cast<const char*>(in_header), sizeof(data_types::FLKHeader));
-        if (!out.good()) {
+        return in_writer.AppendSection(in_type, in_id, FLK_SECTION_FLAG_ENCRYPTED, sealed.data(), sealed.size());
+    }
+
+    void FLKPacker::BuildHeaderV1(const std::vector<FLK_PACK_JOB>& in_jobs,
+        const std::vector<FLKEntryRecord>& in_entries,
+        const FLK_PACK_OPTIONS& in_options,
+        FLKHeader& out_header) {
+        for (size_t i = 0; i < in_jobs.size(); i++) {
+            FLKEntry& flkEntry = out_header.entries[i];
+            if (in_options.compress) {
+                OptimizePathPadding(flkEntry.path, in_jobs[i].entryPath);
+            }
+            else {
+                std::strncpy(flkEntry.path, in_jobs[i].entryPath.c_str(), MAX_FILE_PATH_LENGTH - 1);
+                flkEntry.path[MAX_FILE_PATH_LENGTH - 1] = '\0';
+            }
+            flkEntry.offset = in_entries[i].offset;
+            flkEntry.baseSize = in_entries[i].baseSize;
+            flkEntry.packedSize = in_entries[i].packedSize;
+        }
+
+        out_header.entryCount = static_cast<uint32_t>(in_jobs.size());
+        OptimizeUnusedEntries(&out_header, out_header.entryCount);
+    }
+
+    bool FLKPacker::BuildEntryTables(const std::vector<FLK_PACK_JOB>& in_jobs,
+        std::vector<FLKEntryRecord> in_entries,
+        const FLK_PACK_OPTIONS& in_options,
+        compression::zstd::ZstdStreamCompressor& in_compressor,
+        FLKHeaderV2& io_header,
+        std::vector<uint8_t>& out_tables) {
+        // Every distinct directory and file name is stored once, offset 0 is the empty string
+        std::vector<char> strings(1, '\0');
+        std::map<std::string, uint32_t, std::less<>> stringOffsets { { std::string(), 0 } };
+        auto addString = [&](std::string_view in_string) -> uint32_t {
+            auto it = stringOffsets.find(in_string);
+            if (it != stringOffsets.end()) {
+                return it->second;
+            }
+
+            uint32_t offset = static_cast<uint32_t>(strings.size());
+            strings.insert(strings.end(), in_string.begin(), in_string.end());
+            strings.push_back('\0');
+            stringOffsets.emplace(std::string(in_string), offset);
+            return offset;
+        };
+
+        for (size_t i = 0; i < in_jobs.size(); i++) {
+            std::string_view path = in_jobs[i].entryPath;
+            size_t separator = path.rfind('/');
+
+            in_entries[i].directory = separator != std::string_view::npos ? addString(path.substr(0, separator)) : 0;
+            in_entries[i].name = addString(separator != std::string_view::npos ? path.substr(separator + 1) : path);
+        }
+
+        if (strings.size() > std::numeric_limits<uint32_t>::max()) {
             /// TODO
-			/// Handle error: failed to write header
-			/// Output to console
-			std::cout << "Error: Failed to write header to file: " << in_outPath.string() << "\n";
+            /// Handle error: string table too large
+            /// Output to console
+            std::cout << "Error: Too many entry paths for the string table.\n";
             return false;
         }
 
-        // Write salt if present
-        if (!in_globalSalt.empty()) {
-            out.write(reinterpret_cast<const char*>(in_globalSalt.data()), in_globalSalt.size());
-            if (!out.good()) {
-                /// TODO
-				/// Handle error: failed to write salt
-				/// Output to console
-				std::cout << "Error: Failed to write salt to file: " << in_outPath.string() << "\n";
+        std::vector<uint8_t> plain(in_entries.size() * sizeof(FLKEntryRecord) + strings.size());
+        std::memcpy(plain.data(), in_entries.data(), in_entries.size() * sizeof(FLKEntryRecord));
+        std::memcpy(plain.data() + in_entries.size() * sizeof(FLKEntryRecord), strings.data(), strings.size());
+
+        io_header.entryCount = static_cast<uint32_t>(in_entries.size());
+        io_header.stringTableSize = static_cast<uint32_t>(strings.size());
+
+        // Both tables are compressed together when it saves space, they are read in one go
+        out_tables.clear();
+        if (in_options.compress) {
+            FLKDataSink sink = [&out_tables](const uint8_t* in_data, size_t in_size) {
+                out_tables.assign(in_data, in_data + in_size);
+                return true;
+            };
+            if (!in_compressor.Compress(plain.data(), plain.size(), in_options.compressionLevel, sink)) {
                 return false;
             }
         }
 
-        // Write data blobs
-        for (size_t i = 0; i < in_fileBlobs.size(); i++) {
-            out.write(reinterpret_cast<const char*>(in_fileBlobs[i].data()), in_fileBlobs[i].size());
-            if (!out.good()) {
-                /// TODO
-				/// Handle error: failed to write blob data
-				/// Output to console
-				std::cout << "Error: Failed to write blob data to file: " << in_outPath.string() << "\n";
-                return false;
-            }
+        if (in_options.compress && PaysOff(plain.size(), out_tables.size())) {
+            io_header.tableCodec = FLK_CODEC_ZSTD;
+        }
+        else {
+            io_header.tableCodec = FLK_CODEC_STORED;
+            out_tables = std::move(plain);
         }
+        io_header.tableSize = out_tables.size();
 
-        out.flush();
-        return out.good();
+        return true;
+    }
+
+    bool FLKPacker::ValidateFLKConstraints(const std::string& in_relPath) {
+        if (in_relPath.length() >= MAX_FILE_PATH_LENGTH) {
+            /// TODO
+			/// Handle error: file path too long
+            /// Output to console
+			std::cout << "Error: File path too long: " << in_relPath << "\n";
+            return false;
+        }
+
+		return true;
     }
 
     void FLKPacker::OptimizePathPadding(char* out_entryPath, const std::string& in_actualPath) {
@@ -0,0 +1,756 @@
+#include <flakpak/flak_FLKReader.hpp>
+#include <flakpak/flak_PathCompressor.hpp>
+#include <flakpak/xccp20_Encryptor.hpp>
+
+#include <zstd/zstd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+
+using namespace flakpak::data_types;
+
+namespace flakpak::io {
+	// Size of the fixed part of the FLKHeader, before the entry array
+	static constexpr size_t FLK_HEADER_FIELDS_SIZE = offsetof(FLKHeader, entries);
+	// Most a compressed entry table may expand, real tables stay far below
+	static constexpr uint64_t FLK_TABLE_MAX_EXPANSION = 1024;
+
+	// Whether [in_offset, in_offset + in_size) fits in in_limit bytes
+	static bool IsInRange(uint64_t in_offset, uint64_t in_size, uint64_t in_limit) {
+		return in_offset <= in_limit && in_size <= in_limit - in_offset;
+	}
+
+	// Lookup key of a path, separators are always '/'
+	static std::string NormalizePath(std::string in_path) {
+		std::replace(in_path.begin(), in_path.end(), '\\', '/');
+		return in_path;
+	}
+
+	bool FLKArchiveReader::Open(const std::filesystem::path& in_path, const std::string& in_password) {
+		Close();
+
+		// Entries are looked up in any order, no sequential read-ahead
+		if (!m_file.Open(in_path, FLK_MAP_ACCESS::NORMAL)) {
+			/// TODO
+			/// Handle error: failed to map archive
+			/// Output to console
+			std::cout << "Error: Failed to open archive: " << in_path.string() << "\n";
+			return false;
+		}
+		m_path = in_path;
+
+		if (!Load(in_password)) {
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void FLKArchiveReader::Close() {
+		m_file.Close();
+		m_path.clear();
+		m_footer = FLKFooter();
+		m_legacy = false;
+		m_contentVersion = 0;
+		m_entries.clear();
+		m_entryInfos.clear();
+		m_paths.clear();
+		m_index.clear();
+		m_pathIndex.Clear();
+		m_session.reset();
+		m_dictionaries.clear();
+		m_solidBlocks.clear();
+		m_frames.clear();
+		m_chunks.clear();
+		m_chunkRefs.clear();
+		m_checksums.clear();
+		m_solidCache.Clear();
+	}
+
+	size_t FLKArchiveReader::FindEntry(std::string_view in_path) const {
+		std::string normalized;
+		if (in_path.find('\\') != std::string_view::npos) {
+			normalized = NormalizePath(std::string(in_path));
+			in_path = normalized;
+		}
+
+		if (m_pathIndex.IsLoaded()) {
+			// The index only matches hashes, a path missing from the archive can share one
+			size_t index = m_pathIndex.Find(in_path);
+			return (index != FLK_ENTRY_NOT_FOUND && m_paths[index] == in_path) ? index : FLK_ENTRY_NOT_FOUND;
+		}
+
+		auto it = m_index.find(in_path);
+		return it != m_index.end() ? it->second : FLK_ENTRY_NOT_FOUND;
+	}
+
+	bool FLKArchiveReader::ReadEntry(size_t in_index, std::vector<uint8_t>& io_buffer, const uint8_t*& out_data) {
+		const FLKEntryRecord& entry = m_entries[in_index];
+		const FLKEntryInfo& info = m_entryInfos[in_index];
+
+		if (IsStoredInPlace(in_index)) {
+			out_data = m_file.GetData() + entry.offset;
+			return true;
+		}
+
+		if (info.solidBlock != FLK_NOT_SOLID) {
+			const FLKSolidBlock& block = m_solidBlocks[info.solidBlock];
+			return m_solidCache.ReadEntry(info.solidBlock, block, m_file.GetData() + block.offset,
+				info.solidOffset, entry.baseSize, m_session.get(), out_data);
+		}
+
+		io_buffer.resize(static_cast<size_t>(entry.baseSize));
+		if (!m_frameReader.ReadInto(GetPackedEntry(in_index), io_buffer)) {
+			return false;
+		}
+
+		out_data = io_buffer.data();
+		return true;
+	}
+
+	bool FLKArchiveReader::ReadEntryInto(size_t in_index, std::span<uint8_t> out_data) {
+		const FLKEntryRecord& entry = m_entries[in_index];
+		const FLKEntryInfo& info = m_entryInfos[in_index];
+
+		if (info.solidBlock == FLK_NOT_SOLID) {
+			return m_frameReader.ReadInto(GetPackedEntry(in_index), out_data);
+		}
+
+		if (out_data.size() < entry.baseSize) {
+			/// TODO
+			/// Handle error: output buffer too small
+			/// Output to console
+			std::cout << "Error: Output buffer is smaller than the entry.\n";
+			return false;
+		}
+
+		const FLKSolidBlock& block = m_solidBlocks[info.solidBlock];
+		const uint8_t* data = nullptr;
+		if (!m_solidCache.ReadEntry(info.solidBlock, block, m_file.GetData() + block.offset,
+			info.solidOffset, entry.baseSize, m_session.get(), data)) {
+			return false;
+		}
+
+		if (entry.baseSize != 0) {
+			std::memcpy(out_data.data(), data, static_cast<size_t>(entry.baseSize));
+		}
+		return true;
+	}
+
+	bool FLKArchiveReader::ReadRange(size_t in_index, uint64_t in_offset, uint64_t in_length, const FLKDataSink& in_sink) {
+		const FLKEntryRecord& entry = m_entries[in_index];
+		const FLKEntryInfo& info = m_entryInfos[in_index];
+
+		if (info.solidBlock == FLK_NOT_SOLID) {
+			return m_frameReader.ReadRange(GetPackedEntry(in_index), in_offset, in_length, in_sink);
+		}
+
+		if (!IsInRange(in_offset, in_length, entry.baseSize)) {
+			/// TODO
+			/// Handle error: range outside of the entry
+			/// Output to console
+			std::cout << "Error: Read range is outside of the entry.\n";
+			return false;
+		}
+
+		// Solid members are small, the whole block is decoded once and cached
+		const FLKSolidBlock& block = m_solidBlocks[info.solidBlock];
+		const uint8_t* data = nullptr;
+		if (!m_solidCache.ReadEntry(info.solidBlock, block, m_file.GetData() + block.offset,
+			info.solidOffset, entry.baseSize, m_session.get(), data)) {
+			return false;
+		}
+
+		return in_length == 0 || in_sink(data + in_offset, static_cast<size_t>(in_length));
+	}
+
+	bool FLKArchiveReader::IsOpen() const {
+		return m_file.IsOpen();
+	}
+	uint32_t FLKArchiveReader::GetFlags() const {
+		return m_footer.flags;
+	}
+	uint32_t FLKArchiveReader::GetContentVersion() const {
+		return m_contentVersion;
+	}
+	size_t FLKArchiveReader::GetEntryCount() const {
+		return m_entries.size();
+	}
+	const std::string& FLKArchiveReader::GetEntryPath(size_t in_index) const {
+		return m_paths[in_index];
+	}
+	uint64_t FLKArchiveReader::GetEntrySize(size_t in_index) const {
+		return m_entries[in_index].baseSize;
+	}
+	const FLKEntryRecord& FLKArchiveReader::GetEntry(size_t in_index) const {
+		return m_entries[in_index];
+	}
+	const FLKEntryInfo& FLKArchiveReader::GetEntryInfo(size_t in_index) const {
+		return m_entryInfos[in_index];
+	}
+
+	bool FLKArchiveReader::IsStoredInPlace(size_t in_index) const {
+		const FLKEntryInfo& info = m_entryInfos[in_index];
+		bool compressed = (m_footer.flags & FLK_FLAG_COMPRESSED) && info.codec != FLK_CODEC_STORED;
+
+		return !m_session && !compressed && info.solidBlock == FLK_NOT_SOLID && info.chunkCount == 0;
+	}
+
+	FLK_PACKED_ENTRY FLKArchiveReader::GetPackedEntry(size_t in_index) const {
+		const FLKEntryRecord& entry = m_entries[in_index];
+		const FLKEntryInfo& info = m_entryInfos[in_index];
+
+		FLK_PACKED_ENTRY packed;
+		packed.packedData = m_file.GetData() + entry.offset;
+		packed.packedSize = entry.packedSize;
+		packed.baseSize = entry.baseSize;
+		packed.frames = info.frameCount != 0 ? m_frames.data() + info.firstFrame : nullptr;
+		packed.frameCount = info.frameCount;
+		packed.compressed = (m_footer.flags & FLK_FLAG_COMPRESSED) && info.codec != FLK_CODEC_STORED;
+		packed.session = m_session.get();
+		packed.archiveData = m_file.GetData();
+		packed.chunks = m_chunks.data();
+		if (info.chunkCount != 0) {
+			packed.chunkRefs = m_chunkRefs.data() + info.firstChunk;
+			packed.chunkCount = info.chunkCount;
+		}
+		if (info.dictionaryId != FLK_NO_DICTIONARY) {
+			packed.dictionary = m_dictionaries.at(info.dictionaryId).get();
+		}
+
+		return packed;
+	}
+
+	const FLKSolidBlock& FLKArchiveReader::GetSolidBlock(uint32_t in_blockIndex) const {
+		return m_solidBlocks[in_blockIndex];
+	}
+	bool FLKArchiveReader::HasChecksums() const {
+		return !m_checksums.empty();
+	}
+	const FLKEntryChecksum* FLKArchiveReader::GetEntryChecksum(size_t in_index) const {
+		return m_checksums.empty() ? nullptr : &m_checksums[in_index];
+	}
+	const std::filesystem::path& FLKArchiveReader::GetPath() const {
+		return m_path;
+	}
+
+	// Private methods
+	// ---------------------------------------------------------------------------
+	bool FLKArchiveReader::Load(const std::string& in_password) {
+		return LoadHeader(in_password) && LoadSections() && ValidateEntries() && BuildIndex();
+	}
+
+	bool FLKArchiveReader::LoadHeader(const std::string& in_password) {
+		const uint8_t* data = m_file.GetData();
+		uint64_t size = m_file.GetSize();
+
+		FLKFooter footer;
+		if (size >= sizeof(FLKFooter)) {
+			std::memcpy(&m_footer, data + size - sizeof(FLKFooter), sizeof(FLKFooter));
+		}
+		if (size < sizeof(FLKFooter) || m_footer.magic != footer.magic) {
+			// Archives packed before the footer existed only hold an FLKHeader at byte 0
+			return LoadLegacyHeader();
+		}
+
+		// Both header versions start with the same fields, FLKHeaderV2 is the smallest
+		if (!IsInRange(m_footer.headerOffset, sizeof(FLKHeaderV2), size - sizeof(FLKFooter))) {
+			/// TODO
+			/// Handle error: header outside of the file
+			/// Output to console
+			std::cout << "Error: Corrupted archive, the header is outside of the file.\n";
+			return false;
+		}
+
+		FLKHeaderV2 header;
+		std::memcpy(&header, data + m_footer.headerOffset, sizeof(header));
+		constexpr std::array<char, 4> headerMagic { {'F', 'L', 'K', '\0'} };
+		bool knownVersion = header.version == FLK_FORMAT_VERSION_1 || header.version == FLK_FORMAT_VERSION_2;
+		if (header.magic != headerMagic || !knownVersion) {
+			/// TODO
+			/// Handle error: unknown header
+			/// Output to console
+			std::cout << "Error: Unsupported FLK header (version " << static_cast<int>(header.version) << ").\n";
+			return false;
+		}
+
+		if (m_footer.flags & FLK_FLAG_STREAMED) {
+			FLKStreamPreamble preamble;
+			if (size >= sizeof(preamble)) {
+				std::memcpy(&preamble, data, sizeof(preamble));
+			}
+			if (size < sizeof(preamble) || preamble.magic != FLKStreamPreamble().magic || preamble.version != header.version) {
+				/// TODO
+				/// Handle error: unknown preamble
+				/// Output to console
+				std::cout << "Error: Unsupported streamed FLK preamble.\n";
+				return false;
+			}
+		}
+
+		m_contentVersion = header.contentVersion;
+
+		// Salt and KDF parameters follow the header of encrypted archives
+		uint64_t headerEnd = m_footer.headerOffset + (header.version == FLK_FORMAT_VERSION_1 ? sizeof(FLKHeader) : sizeof(FLKHeaderV2));
+		if ((m_footer.flags & FLK_FLAG_ENCRYPTED) && !OpenSession(headerEnd, header.saltLen, in_password)) {
+			return false;
+		}
+		if (m_footer.flags & FLK_FLAG_ENCRYPTED) {
+			headerEnd += header.saltLen + sizeof(FLKKdfParams);
+		}
+
+		bool loaded = header.version == FLK_FORMAT_VERSION_1
+			? LoadEntriesV1()
+			: LoadEntriesV2(header, headerEnd);
+		m_entryInfos.assign(m_entries.size(), FLKEntryInfo());
+
+		return loaded;
+	}
+
+	bool FLKArchiveReader::LoadLegacyHeader() {
+		const uint8_t* data = m_file.GetData();
+		uint64_t size = m_file.GetSize();
+
+		// The header is read in place, like the one of LoadEntriesV1()
+		const FLKHeader* header = size >= sizeof(FLKHeader) ? reinterpret_cast<const FLKHeader*>(data) : nullptr;
+		constexpr std::array<char, 4> headerMagic { {'F', 'L', 'K', '\0'} };
+		if (header == nullptr || header->magic != headerMagic || header->version != FLK_FORMAT_VERSION_1 ||
+			header->entryCount > MAX_FLK_HEADER_ENTRIES) {
+			/// TODO
+			/// Handle error: missing footer
+			/// Output to console
+			std::cout << "Error: Not an FLK archive (footer not found).\n";
+			return false;
+		}
+		if (header->saltLen != 0) {
+			/// TODO
+			/// Handle error: legacy encrypted archive
+			/// Output to console
+			std::cout << "Error: Encrypted archive without footer, it was packed before the key salts were stored "
+				"and its entries cannot be decrypted. Repack it from the source files.\n";
+			return false;
+		}
+
+		// These archives have no flags, compressed ones are recognised by their entries
+		// and always use PathCompressor paths
+		m_legacy = true;
+		m_footer = FLKFooter();
+		m_footer.headerSize = sizeof(FLKHeader);
+		if (HasLegacyCompressedEntries()) {
+			m_footer.flags = FLK_FLAG_COMPRESSED | FLK_FLAG_COMPRESSED_PATHS;
+		}
+		m_contentVersion = header->contentVersion;
+
+		bool loaded = LoadEntriesV1();
+		m_entryInfos.assign(m_entries.size(), FLKEntryInfo());
+
+		return loaded;
+	}
+
+	bool FLKArchiveReader::HasLegacyCompressedEntries() const {
+		const uint8_t* data = m_file.GetData();
+		const FLKHeader* header = reinterpret_cast<const FLKHeader*>(data);
+
+		// Every compressed entry is exactly one zstd frame (streamed, so its size is
+		// usually unknown), stored files almost never are all whole zstd frames
+		for (uint32_t i = 0; i < header->entryCount; i++) {
+			FLKEntry entry;
+			std::memcpy(&entry, data + FLK_HEADER_FIELDS_SIZE + i * sizeof(FLKEntry), sizeof(entry));
+			if (!IsInRange(entry.offset, entry.packedSize, m_file.GetSize())) {
+				return false;
+			}
+
+			const uint8_t* blob = data + entry.offset;
+			size_t blobSize = static_cast<size_t>(entry.packedSize);
+			unsigned long long contentSize = ZSTD_getFrameContentSize(blob, blobSize);
+			if (ZSTD_findFrameCompressedSize(blob, blobSize) != blobSize ||
+				(contentSize != entry.baseSize && contentSize != ZSTD_CONTENTSIZE_UNKNOWN)) {
+				return false;
+			}
+		}
+
+		return header->entryCount != 0;
+	}
+
+	bool FLKArchiveReader::OpenSession(uint64_t in_saltOffset, uint32_t in_saltLen, const std::string& in_password) {
+		const uint8_t* data = m_file.GetData();
+
+		if (in_saltLen != FLK_SALT_SIZE || !IsInRange(in_saltOffset, in_saltLen + sizeof(FLKKdfParams), m_file.GetSize())) {
+			/// TODO
+			/// Handle error: missing salt
+			/// Output to console
+			std::cout << "Error: Corrupted archive, invalid salt.\n";
+			return false;
+		}
+		if (in_password.empty()) {
+			/// TODO
+			/// Handle error: no password
+			/// Output to console
+			std::cout << "Error: The archive is encrypted, a password is required.\n";
+			return false;
+		}
+
+		std::vector<uint8_t> salt(data + in_saltOffset, data + in_saltOffset + in_saltLen);
+		FLKKdfParams params;
+		std::memcpy(&params, data + in_saltOffset + in_saltLen, sizeof(params));
+
+		m_session = std::make_unique<encryption::xccp20::XChaCha20Poly1305KeySession>();
+		return m_session->Open(in_password, salt, params);
+	}
+
+	bool FLKArchiveReader::LoadEntriesV1() {
+		const uint8_t* data = m_file.GetData();
+
+		uint64_t headerLimit = m_legacy ? m_file.GetSize() : m_file.GetSize() - sizeof(FLKFooter);
+		if (!IsInRange(m_footer.headerOffset, sizeof(FLKHeader), headerLimit)) {
+			std::cout << "Error: Corrupted archive, the header is outside of the file.\n";
+			return false;
+		}
+
+		// The header is read in place, only the used entries are copied
+		const FLKHeader* header = reinterpret_cast<const FLKHeader*>(data + m_footer.headerOffset);
+		if (header->entryCount > MAX_FLK_HEADER_ENTRIES) {
+			std::cout << "Error: Corrupted archive, too many entries.\n";
+			return false;
+		}
+
+		bool compressedPaths = m_footer.flags & FLK_FLAG_COMPRESSED_PATHS;
+		m_entries.resize(header->entryCount);
+		m_paths.reserve(header->entryCount);
+		for (uint32_t i = 0; i < header->entryCount; i++) {
+			FLKEntry entry;
+			std::memcpy(&entry, data + m_footer.headerOffset + FLK_HEADER_FIELDS_SIZE + i * sizeof(FLKEntry), sizeof(entry));
+			m_entries[i].offset = entry.offset;
+			m_entries[i].baseSize = entry.baseSize;
+			m_entries[i].packedSize = entry.packedSize;
+
+			std::string path(entry.path, strnlen(entry.path, MAX_FILE_PATH_LENGTH));
+			if (compressedPaths) {
+				path = pathcom::PathCompressor::DecompressPath(path);
+			}
+			m_paths.push_back(NormalizePath(std::move(path)));
+		}
+
+		return true;
+	}
+
+	bool FLKArchiveReader::LoadEntriesV2(const FLKHeaderV2& in_header, uint64_t in_tablesOffset) {
+		const uint8_t* data = m_file.GetData();
+
+		uint64_t entryTableSize = static_cast<uint64_t>(in_header.entryCount) * sizeof(FLKEntryRecord);
+		uint64_t plainSize = entryTableSize + in_header.stringTableSize;
+		if (!IsInRange(in_tablesOffset, in_header.tableSize, m_file.GetSize()) || in_header.stringTableSize == 0 ||
+			(in_header.tableCodec != FLK_CODEC_STORED && in_header.tableCodec != FLK_CODEC_ZSTD) ||
+			(in_header.tableCodec == FLK_CODEC_STORED && in_header.tableSize != plainSize)) {
+			/// TODO
+			/// Handle error: corrupted entry table
+			/// Output to console
+			std::cout << "Error: Corrupted archive, invalid entry table.\n";
+			return false;
+		}
+
+		// Compressed tables are a single zstd frame holding both tables. Its
+		// content size must match the header before anything is allocated
+		const uint8_t* tables = data + in_tablesOffset;
+		std::vector<uint8_t> unpacked;
+		if (in_header.tableCodec == FLK_CODEC_ZSTD) {
+			unsigned long long contentSize = ZSTD_getFrameContentSize(tables, static_cast<size_t>(in_header.tableSize));
+			if (contentSize != plainSize || plainSize > in_header.tableSize * FLK_TABLE_MAX_EXPANSION) {
+				std::cout << "Error: Corrupted archive, invalid entry table.\n";
+				return false;
+			}
+
+			FLKDataSink append = [&unpacked, plainSize](const uint8_t* in_data, size_t in_size) {
+				if (unpacked.size() + in_size > plainSize) {
+					return false;
+				}
+				unpacked.insert(unpacked.end(), in_data, in_data + in_size);
+				return true;
+			};
+
+			compression::zstd::ZstdStreamDecompressor decompressor;
+			if (!decompressor.Begin() || !decompressor.Push(tables, static_cast<size_t>(in_header.tableSize), append) ||
+				!decompressor.End() || unpacked.size() != plainSize) {
+				std::cout << "Error: Corrupted archive, invalid entry table.\n";
+				return false;
+			}
+			tables = unpacked.data();
+		}
+
+		const char* strings = reinterpret_cast<const char*>(tables + entryTableSize);
+		if (strings[in_header.stringTableSize - 1] != '\0') {
+			std::cout << "Error: Corrupted archive, invalid string table.\n";
+			return false;
+		}
+
+		m_entries.resize(in_header.entryCount);
+		std::memcpy(m_entries.data(), tables, static_cast<size_t>(entryTableSize));
+
+		m_paths.reserve(m_entries.size());
+		for (const FLKEntryRecord& entry : m_entries) {
+			if (entry.directory >= in_header.stringTableSize || entry.name >= in_header.stringTableSize) {
+				std::cout << "Error: Corrupted archive, invalid string table.\n";
+				return false;
+			}
+
+			std::string path = strings + entry.directory;
+			if (!path.empty()) {
+				path += '/';
+			}
+			path += strings + entry.name;
+			m_paths.push_back(NormalizePath(std::move(path)));
+		}
+
+		return true;
+	}
+
+	bool FLKArchiveReader::LoadSections() {
+		if (!(m_footer.flags & FLK_FLAG_SECTIONS)) {
+			return true;
+		}
+
+		const uint8_t* data = m_file.GetData();
+		uint64_t size = m_file.GetSize();
+
+		FLKSectionDirectory directory;
+		FLKSectionDirectory expected;
+		uint64_t directoryEnd = size - sizeof(FLKFooter);
+		if (directoryEnd >= sizeof(directory)) {
+			std::memcpy(&directory, data + directoryEnd - sizeof(directory), sizeof(directory));
+		}
+		if (directoryEnd < sizeof(directory) || directory.magic != expected.magic ||
+			!IsInRange(directory.offset, static_cast<uint64_t>(directory.count) * sizeof(FLKSection), directoryEnd - sizeof(directory))) {
+			/// TODO
+			/// Handle error: corrupted section directory
+			/// Output to console
+			std::cout << "Error: Corrupted archive, invalid section directory.\n";
+			return false;
+		}
+
+		encryption::xccp20::XChaCha20Poly1305StreamDecryptor decryptor;
+		std::vector<uint8_t> payload;
+		FLKDataSink append = [&payload](const uint8_t* in_data, size_t in_size) {
+			payload.insert(payload.end(), in_data, in_data + in_size);
+			return true;
+		};
+
+		for (uint32_t i = 0; i < directory.count; i++) {
+			FLKSection section;
+			std::memcpy(&section, data + directory.offset + i * sizeof(FLKSection), sizeof(section));
+
+			if (!IsInRange(section.offset, section.size, size)) {
+				std::cout << "Error: Corrupted archive, section outside of the file.\n";
+				return false;
+			}
+
+			payload.clear();
+			if (section.flags & FLK_SECTION_FLAG_ENCRYPTED) {
+				if (!m_session) {
+					std::cout << "Error: Corrupted archive, encrypted section in a plain archive.\n";
+					return false;
+				}
+
+				decryptor.Begin(*m_session);
+				if (!decryptor.Push(data + section.offset, static_cast<size_t>(section.size), append) || !decryptor.End(append)) {
+					/// TODO
+					/// Handle error: wrong password or corrupted section
+					/// Output to console
+					std::cout << "Error: Failed to decrypt the archive tables (wrong password?).\n";
+					return false;
+				}
+			}
+			else {
+				payload.assign(data + section.offset, data + section.offset + section.size);
+			}
+
+			if (!LoadSection(section, payload)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool FLKArchiveReader::LoadSection(const FLKSection& in_section, const std::vector<uint8_t>& in_payload) {
+		// Fixed-size record tables are copied as is
+		auto loadTable = [&in_payload](auto& out_table) {
+			using Record = typename std::decay_t<decltype(out_table)>::value_type;
+			out_table.resize(in_payload.size() / sizeof(Record));
+			std::memcpy(out_table.data(), in_payload.data(), out_table.size() * sizeof(Record));
+		};
+
+		switch (in_section.type) {
+		case FLK_SECTION_ENTRY_INFO: {
+			FLKEntryInfoTable table;
+			if (in_payload.size() >= sizeof(table)) {
+				std::memcpy(&table, in_payload.data(), sizeof(table));
+			}
+			if (in_payload.size() < sizeof(table) || table.stride == 0 || table.count > m_entries.size() ||
+				!IsInRange(sizeof(table), static_cast<uint64_t>(table.count) * table.stride, in_payload.size())) {
+				std::cout << "Error: Corrupted archive, invalid entry info table.\n";
+				return false;
+			}
+
+			// Older writers may use a shorter stride, missing fields keep their defaults
+			for (uint32_t i = 0; i < table.count; i++) {
+				std::memcpy(&m_entryInfos[i], in_payload.data() + sizeof(table) + i * table.stride,
+					std::min<size_t>(table.stride, sizeof(FLKEntryInfo)));
+			}
+			break;
+		}
+		case FLK_SECTION_DICTIONARY: {
+			auto dictionary = std::make_unique<compression::zstd::ZstdDictionary>();
+			dictionary->Load(in_payload);
+			if (!dictionary->PrepareDecompression()) {
+				return false;
+			}
+			m_dictionaries[in_section.id] = std::move(dictionary);
+			break;
+		}
+		case FLK_SECTION_SOLID_BLOCKS:
+			loadTable(m_solidBlocks);
+			break;
+		case FLK_SECTION_FRAMES:
+			loadTable(m_frames);
+			break;
+		case FLK_SECTION_CHUNKS:
+			loadTable(m_chunks);
+			break;
+		case FLK_SECTION_CHUNK_REFS:
+			loadTable(m_chunkRefs);
+			break;
+		case FLK_SECTION_PATH_INDEX:
+			if (!m_pathIndex.Load(in_payload, m_entries.size())) {
+				return false;
+			}
+			break;
+		case FLK_SECTION_CHECKSUMS: {
+			FLKChecksumTable table;
+			if (in_payload.size() >= sizeof(table)) {
+				std::memcpy(&table, in_payload.data(), sizeof(table));
+			}
+			if (in_payload.size() < sizeof(table) || table.stride < sizeof(FLKEntryChecksum) || table.count != m_entries.size() ||
+				!IsInRange(sizeof(table), static_cast<uint64_t>(table.count) * table.stride, in_payload.size())) {
+				std::cout << "Error: Corrupted archive, invalid checksum table.\n";
+				return false;
+			}
+			// Checksums of an unknown algorithm cannot be checked, the archive still reads fine
+			if (table.algorithm != FLK_CHECKSUM_XXH3_64) {
+				break;
+			}
+
+			m_checksums.resize(table.count);
+			for (uint32_t i = 0; i < table.count; i++) {
+				std::memcpy(&m_checksums[i], in_payload.data() + sizeof(table) + i * table.stride, sizeof(FLKEntryChecksum));
+			}
+			break;
+		}
+		default:
+			// Unknown sections are skipped
+			break;
+		}
+
+		return true;
+	}
+
+	bool FLKArchiveReader::BuildIndex() {
+		// Archives with a path index are searched through it
+		if (m_pathIndex.IsLoaded()) {
+			return true;
+		}
+
+		m_index.reserve(m_paths.size());
+		for (size_t i = 0; i < m_paths.size(); i++) {
+			m_index.emplace(m_paths[i], i);
+		}
+
+		return true;
+	}
+
+	bool FLKArchiveReader::ValidateEntries() const {
+		uint64_t size = m_file.GetSize();
+
+		for (const FLKChunk& chunk : m_chunks) {
+			if (!IsInRange(chunk.offset, chunk.packedSize, size)) {
+				std::cout << "Error: Corrupted archive, chunk outside of the file.\n";
+				return false;
+			}
+		}
+		for (const FLKSolidBlock& block : m_solidBlocks) {
+			if (!IsInRange(block.offset, block.packedSize, size)) {
+				std::cout << "Error: Corrupted archive, solid block outside of the file.\n";
+				return false;
+			}
+		}
+		for (uint32_t chunkRef : m_chunkRefs) {
+			if (chunkRef >= m_chunks.size()) {
+				std::cout << "Error: Corrupted archive, invalid chunk reference.\n";
+				return false;
+			}
+		}
+
+		// Every read after Open() relies on these checks
+		for (size_t i = 0; i < m_entries.size(); i++) {
+			const FLKEntryRecord& entry = m_entries[i];
+			const FLKEntryInfo& info = m_entryInfos[i];
+
+			bool valid = true;
+			if (info.solidBlock != FLK_NOT_SOLID) {
+				valid = info.solidBlock < m_solidBlocks.size() &&
+					IsInRange(info.solidOffset, entry.baseSize, m_solidBlocks[info.solidBlock].baseSize);
+			}
+			else if (info.chunkCount != 0) {
+				uint64_t chunkedSize = 0;
+				valid = IsInRange(info.firstChunk, info.chunkCount, m_chunkRefs.size());
+				for (uint32_t c = 0; valid && c < info.chunkCount; c++) {
+					chunkedSize += m_chunks[m_chunkRefs[info.firstChunk + c]].baseSize;
+				}
+				valid = valid && chunkedSize == entry.baseSize;
+			}
+			else {
+				valid = IsInRange(entry.offset, entry.packedSize, size) &&
+					IsInRange(info.firstFrame, info.frameCount, m_frames.size()) &&
+					IsValidSeekTable(entry, info) &&
+					(info.dictionaryId == FLK_NO_DICTIONARY || m_dictionaries.count(info.dictionaryId) != 0);
+				if (valid && IsStoredInPlace(i)) {
+					valid = entry.packedSize == entry.baseSize;
+				}
+			}
+
+			if (!valid) {
+				/// TODO
+				/// Handle error: entry outside of the archive data
+				/// Output to console
+				std::cout << "Error: Corrupted archive, invalid entry " << i << ".\n";
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool FLKArchiveReader::IsValidSeekTable(const FLKEntryRecord& in_entry, const FLKEntryInfo& in_info) const {
+		if (in_info.frameCount == 0) {
+			return true;
+		}
+
+		const FLKFrame* frames = m_frames.data() + in_info.firstFrame;
+		if (frames[0].baseOffset != 0 || frames[0].packedOffset != 0) {
+			return false;
+		}
+
+		for (uint32_t f = 1; f < in_info.frameCount; f++) {
+			if (frames[f].baseOffset <= frames[f - 1].baseOffset || frames[f].baseOffset >= in_entry.baseSize ||
+				frames[f].packedOffset <= frames[f - 1].packedOffset || frames[f].packedOffset >= in_entry.packedSize) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+} // namespace flakpak::io
@@ -0,0 +1,250 @@
+#include <flakpak/flak_FLKVerifier.hpp>
+
+#include <flakpak/flak_PasswordHandler.hpp>
+#include <flakpak/xxh3_Hash.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+using namespace flakpak::data_types;
+
+namespace flakpak {
+    static std::mutex s_reportMutex;
+
+    // Reports a failing entry, workers may report at the same time
+    static void ReportFailure(const io::FLKArchiveReader& in_reader, size_t in_index, const char* in_reason) {
+        std::lock_guard<std::mutex> lock(s_reportMutex);
+        /// TODO
+        /// Handle error: entry failed verification
+        /// Output to console
+        std::cout << "Error: " << in_reason << ": " << in_reader.GetEntryPath(in_index) << "\n";
+    }
+
+    bool FLKVerifier::VerifyArchive(const std::filesystem::path& in_archivePath, const FLK_VERIFY_OPTIONS& in_options) {
+        auto startTime = std::chrono::steady_clock::now();
+
+        // The password is only used when the archive is encrypted
+        io::FLKArchiveReader reader;
+        if (!reader.Open(in_archivePath, encryption::GetPassword())) {
+            return false;
+        }
+
+        if (!reader.HasChecksums() && !in_options.decode) {
+            /// TODO
+            /// Handle error: nothing to compare with
+            /// Output to console
+            std::cout << "Error: Archive has no checksums, use --decode to check that every entry decodes.\n";
+            return false;
+        }
+
+        size_t jobCount = in_options.jobCount != 0 ? in_options.jobCount : std::thread::hardware_concurrency();
+
+        size_t failedCount = 0;
+        uint64_t hashedSize = 0;
+        uint64_t decodedSize = 0;
+        if (reader.HasChecksums()) {
+            failedCount += VerifyPacked(reader, jobCount, hashedSize);
+        }
+        if (in_options.decode) {
+            failedCount += VerifyDecoded(reader, jobCount, decodedSize);
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        if (failedCount > 0) {
+            std::cout << "Verification failed: " << failedCount << " failed checks over " << reader.GetEntryCount() << " files\n";
+            return false;
+        }
+
+        std::cout << "Successfully verified " << reader.GetEntryCount() << " files (" << (hashedSize >> 20) << " MiB hashed";
+        if (in_options.decode) {
+            std::cout << ", " << (decodedSize >> 20) << " MiB decoded";
+        }
+        std::cout << ") in " << seconds << " s\n";
+        return true;
+    }
+
+    // Private methods
+    // ---------------------------------------------------------------------------
+    size_t FLKVerifier::VerifyPacked(const io::FLKArchiveReader& in_reader, size_t in_jobCount, uint64_t& out_hashedSize) {
+        // Every entry points at a blob, chunked entries at a list of chunk blobs
+        std::vector<PackedRegion> regions;
+        for (size_t i = 0; i < in_reader.GetEntryCount(); i++) {
+            io::FLK_PACKED_ENTRY packed = in_reader.GetPackedEntry(i);
+            if (packed.chunkRefs == nullptr) {
+                regions.push_back({ packed.packedData, packed.packedSize });
+                continue;
+            }
+            for (size_t c = 0; c < packed.chunkCount; c++) {
+                const FLKChunk& chunk = packed.chunks[packed.chunkRefs[c]];
+                regions.push_back({ packed.archiveData + chunk.offset, chunk.packedSize });
+            }
+        }
+
+        // Shared blobs are hashed once, in file order
+        std::sort(regions.begin(), regions.end());
+        regions.erase(std::unique(regions.begin(), regions.end()), regions.end());
+        auto findRegion = [&regions](const PackedRegion& in_region) {
+            return static_cast<size_t>(std::lower_bound(regions.begin(), regions.end(), in_region) - regions.begin());
+        };
+
+        out_hashedSize = 0;
+        for (const PackedRegion& region : regions) {
+            out_hashedSize += region.size;
+        }
+
+        std::vector<uint64_t> regionChecksums(regions.size());
+        std::atomic<size_t> nextRegion { 0 };
+        RunWorkers(std::min(in_jobCount, regions.size()), [&]() {
+            for (size_t r = nextRegion.fetch_add(1, std::memory_order_relaxed); r < regions.size();
+                r = nextRegion.fetch_add(1, std::memory_order_relaxed)) {
+                regionChecksums[r] = checksum::xxh3::Xxh3Hasher::Hash(regions[r].data, static_cast<size_t>(regions[r].size));
+            }
+        });
+
+        size_t failedCount = 0;
+        for (size_t i = 0; i < in_reader.GetEntryCount(); i++) {
+            io::FLK_PACKED_ENTRY packed = in_reader.GetPackedEntry(i);
+
+            uint64_t actual = 0;
+            if (packed.chunkRefs == nullptr) {
+                actual = regionChecksums[findRegion({ packed.packedData, packed.packedSize })];
+            }
+            else {
+                // Same construction as the packer, the chunk checksums in reference order
+                checksum::xxh3::Xxh3Hasher hasher;
+                for (size_t c = 0; c < packed.chunkCount; c++) {
+                    const FLKChunk& chunk = packed.chunks[packed.chunkRefs[c]];
+                    uint64_t chunkChecksum = regionChecksums[findRegion({ packed.archiveData + chunk.offset, chunk.packedSize })];
+
+                    std::array<uint8_t, sizeof(uint64_t)> bytes {};
+                    for (size_t b = 0; b < bytes.size(); b++) {
+                        bytes[b] = static_cast<uint8_t>(chunkChecksum >> (8 * b));
+                    }
+                    hasher.Update(bytes.data(), bytes.size());
+                }
+                actual = hasher.Digest();
+            }
+
+            if (actual != in_reader.GetEntryChecksum(i)->packed) {
+                ReportFailure(in_reader, i, "Packed data checksum mismatch");
+                failedCount++;
+            }
+        }
+
+        return failedCount;
+    }
+
+    size_t FLKVerifier::VerifyDecoded(const io::FLKArchiveReader& in_reader, size_t in_jobCount, uint64_t& out_decodedSize) {
+        // One task per solid block and per distinct blob, copies are checked
+        // against the bytes decoded for the first entry of their blob. Chunked
+        // entries starting with the same chunk are told apart by their chunk list.
+        std::vector<DecodeTask> tasks;
+        std::map<uint32_t, size_t> blockTasks;
+        std::map<std::tuple<PackedRegion, const uint32_t*, uint64_t>, size_t> blobTasks;
+        for (size_t i = 0; i < in_reader.GetEntryCount(); i++) {
+            const FLKEntryInfo& info = in_reader.GetEntryInfo(i);
+            io::FLK_PACKED_ENTRY packed = in_reader.GetPackedEntry(i);
+
+            size_t& taskIndex = info.solidBlock != FLK_NOT_SOLID
+                ? blockTasks.try_emplace(info.solidBlock, tasks.size()).first->second
+                : blobTasks.try_emplace({ { packed.packedData, packed.packedSize }, packed.chunkRefs, packed.baseSize }, tasks.size()).first->second;
+            if (taskIndex == tasks.size()) {
+                tasks.push_back({ info.solidBlock, {} });
+            }
+            tasks[taskIndex].entries.push_back(i);
+        }
+
+        std::atomic<size_t> nextTask { 0 };
+        std::atomic<size_t> failedCount { 0 };
+        std::atomic<uint64_t> decodedSize { 0 };
+        RunWorkers(std::min(in_jobCount, tasks.size()), [&]() {
+            // Decoders are not thread safe, each worker keeps its own
+            io::FrameReader frameReader;
+            io::SolidBlockCache solidCache(1);
+
+            for (size_t t = nextTask.fetch_add(1, std::memory_order_relaxed); t < tasks.size();
+                t = nextTask.fetch_add(1, std::memory_order_relaxed)) {
+                const DecodeTask& task = tasks[t];
+
+                // Checks the decoded bytes of every entry of the task
+                auto checkEntries = [&](size_t in_first, size_t in_last, bool in_decoded, uint64_t in_size, uint64_t in_checksum) {
+                    for (size_t e = in_first; e < in_last; e++) {
+                        size_t index = task.entries[e];
+                        const FLKEntryChecksum* expected = in_reader.GetEntryChecksum(index);
+
+                        const char* reason = nullptr;
+                        if (!in_decoded) {
+                            reason = "Failed to decode";
+                        }
+                        else if (in_size != in_reader.GetEntrySize(index)) {
+                            reason = "Decoded size does not match the entry size";
+                        }
+                        else if (expected && expected->base != in_checksum) {
+                            reason = "Decoded data checksum mismatch";
+                        }
+
+                        if (reason) {
+                            ReportFailure(in_reader, index, reason);
+                            failedCount.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                };
+
+                if (task.solidBlock != FLK_NOT_SOLID) {
+                    // The block is decompressed once, the members are views into it
+                    const FLKSolidBlock& block = in_reader.GetSolidBlock(task.solidBlock);
+                    for (size_t e = 0; e < task.entries.size(); e++) {
+                        size_t index = task.entries[e];
+                        io::FLK_PACKED_ENTRY packed = in_reader.GetPackedEntry(index);
+                        uint64_t size = in_reader.GetEntrySize(index);
+
+                        const uint8_t* data = nullptr;
+                        bool decoded = solidCache.ReadEntry(task.solidBlock, block, packed.archiveData + block.offset,
+                            in_reader.GetEntryInfo(index).solidOffset, size, packed.session, data);
+                        uint64_t checksum = decoded ? checksum::xxh3::Xxh3Hasher::Hash(data, static_cast<size_t>(size)) : 0;
+
+                        checkEntries(e, e + 1, decoded, size, checksum);
+                        decodedSize.fetch_add(decoded ? size : 0, std::memory_order_relaxed);
+                    }
+                    continue;
+                }
+
+                // Frames and chunks are decoded one by one, never the whole entry at once
+                io::FLK_PACKED_ENTRY packed = in_reader.GetPackedEntry(task.entries.front());
+                checksum::xxh3::Xxh3Hasher hasher;
+                uint64_t size = 0;
+                FLKDataSink hash = [&hasher, &size](const uint8_t* in_data, size_t in_size) {
+                    hasher.Update(in_data, in_size);
+                    size += in_size;
+                    return true;
+                };
+
+                bool decoded = packed.baseSize == 0 || frameReader.ReadRange(packed, 0, packed.baseSize, hash);
+                checkEntries(0, task.entries.size(), decoded, size, hasher.Digest());
+                decodedSize.fetch_add(size, std::memory_order_relaxed);
+            }
+        });
+
+        out_decodedSize = decodedSize;
+        return failedCount;
+    }
+
+    void FLKVerifier::RunWorkers(size_t in_workerCount, const std::function<void()>& in_worker) {
+        std::vector<std::thread> threads;
+        for (size_t w = 1; w < in_workerCount; w++) {
+            threads.emplace_back(in_worker);
+        }
+        in_worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+} // namespace flakpak
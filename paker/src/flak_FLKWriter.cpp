@@ -0,0 +1,289 @@
+#include <flakpak/flak_FLKWriter.hpp>
+
+#include <iostream>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+
+using namespace flakpak::data_types;
+
+namespace flakpak::io {
+	static constexpr size_t FLK_WRITE_BUFFER_SIZE = 1 << 20;
+
+	static std::FILE* OpenForWriting(const std::filesystem::path& in_path) {
+#ifdef _WIN32
+		return _wfopen(in_path.c_str(), L"wb");
+#else
+		return std::fopen(in_path.c_str(), "wb");
+#endif
+	}
+
+	FLKArchiveWriter::~FLKArchiveWriter() {
+		if (m_file) {
+			Abort();
+		}
+	}
+
+	bool FLKArchiveWriter::Open(const std::filesystem::path& in_outPath, size_t in_headerSize) {
+		m_file = OpenForWriting(in_outPath);
+		if (!m_file) {
+			/// TODO
+			/// Handle error: failed to create output file
+			/// Output to console
+			std::cout << "Error: Failed to create output file: " << in_outPath.string() << "\n";
+			return false;
+		}
+		std::setvbuf(m_file, nullptr, _IOFBF, FLK_WRITE_BUFFER_SIZE);
+
+		m_outPath = in_outPath;
+		m_streamed = false;
+		m_headerSize = in_headerSize;
+		m_currentOffset = 0;
+		m_sections.clear();
+		m_paddingSize = 0;
+
+		// Reserve the header region, it gets patched by Finalize()
+		std::vector<char> placeholder(in_headerSize, 0);
+		if (!Write(placeholder.data(), placeholder.size())) {
+			/// TODO
+			/// Handle error: failed to write header
+			/// Output to console
+			std::cout << "Error: Failed to write header to file: " << m_outPath.string() << "\n";
+			Abort();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool FLKArchiveWriter::OpenStream(const std::filesystem::path& in_outPath, uint8_t in_formatVersion) {
+		if (in_outPath == FLK_STDOUT_PATH) {
+#ifdef _WIN32
+			_setmode(_fileno(stdout), _O_BINARY);
+#endif
+			m_file = stdout;
+			m_isStdout = true;
+		}
+		else {
+			m_file = OpenForWriting(in_outPath);
+		}
+
+		if (!m_file) {
+			/// TODO
+			/// Handle error: failed to create output file
+			/// Output to console
+			std::cout << "Error: Failed to create output file: " << in_outPath.string() << "\n";
+			return false;
+		}
+		std::setvbuf(m_file, nullptr, _IOFBF, FLK_WRITE_BUFFER_SIZE);
+
+		m_outPath = in_outPath;
+		m_streamed = true;
+		m_headerSize = 0;
+		m_currentOffset = 0;
+		m_sections.clear();
+		m_paddingSize = 0;
+
+		FLKStreamPreamble preamble;
+		preamble.version = in_formatVersion;
+		if (!Write(&preamble, sizeof(preamble))) {
+			/// TODO
+			/// Handle error: failed to write header
+			/// Output to console
+			std::cout << "Error: Failed to write header to file: " << m_outPath.string() << "\n";
+			Abort();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool FLKArchiveWriter::AppendBlob(const uint8_t* in_data, size_t in_size, uint64_t& out_offset) {
+		if (!AlignBlob()) {
+			return false;
+		}
+		out_offset = m_currentOffset;
+
+		return AppendData(in_data, in_size);
+	}
+
+	bool FLKArchiveWriter::AppendData(const uint8_t* in_data, size_t in_size) {
+		if (!Write(in_data, in_size)) {
+			/// TODO
+			/// Handle error: failed to write blob data
+			/// Output to console
+			std::cout << "Error: Failed to write blob data to file: " << m_outPath.string() << "\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool FLKArchiveWriter::AlignBlob() {
+		if (m_alignment <= 1 || m_currentOffset % m_alignment == 0) {
+			return true;
+		}
+
+		std::vector<uint8_t> padding(static_cast<size_t>(m_alignment - m_currentOffset % m_alignment), FLK_PADDING_PATTERN);
+		if (!Write(padding.data(), padding.size())) {
+			/// TODO
+			/// Handle error: failed to write padding
+			/// Output to console
+			std::cout << "Error: Failed to write blob padding to file: " << m_outPath.string() << "\n";
+			return false;
+		}
+
+		m_paddingSize += padding.size();
+		return true;
+	}
+
+	bool FLKArchiveWriter::AppendSection(uint32_t in_type, uint32_t in_id, uint32_t in_flags, const uint8_t* in_data, size_t in_size) {
+		FLKSection section;
+		section.type = in_type;
+		section.id = in_id;
+		section.flags = in_flags;
+		section.size = in_size;
+		section.offset = m_currentOffset;
+
+		if (!AppendData(in_data, in_size)) {
+			return false;
+		}
+
+		m_sections.push_back(section);
+		return true;
+	}
+
+	bool FLKArchiveWriter::Finalize(const void* in_header, size_t in_size, uint32_t in_flags) {
+		FLKFooter footer;
+		footer.headerSize = in_size;
+		footer.flags = in_flags;
+
+		if (m_streamed) {
+			// Header goes to the trailer, right before the footer
+			footer.headerOffset = m_currentOffset;
+			footer.flags |= FLK_FLAG_STREAMED;
+
+			if (!Write(in_header, in_size)) {
+				/// TODO
+				/// Handle error: failed to write header
+				/// Output to console
+				std::cout << "Error: Failed to write header to file: " << m_outPath.string() << "\n";
+				return false;
+			}
+		}
+		else {
+			if (in_size > m_headerSize) {
+				std::cout << "Error: Header does not fit in the reserved region.\n";
+				return false;
+			}
+
+			// Footer is appended at the end, patch the header at byte 0 afterwards
+			footer.headerOffset = 0;
+		}
+
+		if (!m_sections.empty()) {
+			FLKSectionDirectory directory;
+			directory.offset = m_currentOffset;
+			directory.count = static_cast<uint32_t>(m_sections.size());
+			footer.flags |= FLK_FLAG_SECTIONS;
+
+			if (!Write(m_sections.data(), m_sections.size() * sizeof(FLKSection)) || !Write(&directory, sizeof(directory))) {
+				/// TODO
+				/// Handle error: failed to write section directory
+				/// Output to console
+				std::cout << "Error: Failed to write section directory to file: " << m_outPath.string() << "\n";
+				return false;
+			}
+		}
+
+		if (!Write(&footer, sizeof(footer))) {
+			/// TODO
+			/// Handle error: failed to write footer
+			/// Output to console
+			std::cout << "Error: Failed to write footer to file: " << m_outPath.string() << "\n";
+			return false;
+		}
+
+		if (!m_streamed) {
+			if (std::fseek(m_file, 0, SEEK_SET) != 0 || std::fwrite(in_header, 1, in_size, m_file) != in_size) {
+				/// TODO
+				/// Handle error: failed to write header
+				/// Output to console
+				std::cout << "Error: Failed to write header to file: " << m_outPath.string() << "\n";
+				return false;
+			}
+		}
+
+		bool success = std::fflush(m_file) == 0;
+		if (!m_isStdout) {
+			success = std::fclose(m_file) == 0 && success;
+		}
+		m_file = nullptr;
+
+		return success;
+	}
+
+	void FLKArchiveWriter::Abort() {
+		if (m_isStdout) {
+			std::fflush(m_file);
+			m_file = nullptr;
+			return;
+		}
+
+		if (m_file) {
+			std::fclose(m_file);
+			m_file = nullptr;
+		}
+
+		// Only regular files are removed, never pipes or devices
+		std::error_code ec;
+		if (std::filesystem::is_regular_file(m_outPath, ec)) {
+			std::filesystem::remove(m_outPath, ec);
+		}
+	}
+
+	void FLKArchiveWriter::SetAlignment(uint64_t in_alignment) {
+		m_alignment = in_alignment;
+	}
+
+	uint64_t FLKArchiveWriter::GetCurrentOffset() const {
+		return m_currentOffset;
+	}
+	bool FLKArchiveWriter::IsStreamed() const {
+		return m_streamed;
+	}
+	uint64_t FLKArchiveWriter::GetPaddingSize() const {
+		return m_paddingSize;
+	}
+
+	bool FLKArchiveWriter::RequiresStream(const std::filesystem::path& in_outPath) {
+		if (in_outPath == FLK_STDOUT_PATH) {
+			return true;
+		}
+
+		std::error_code ec;
+		auto status = std::filesystem::status(in_outPath, ec);
+		if (ec) {
+			return false;
+		}
+		return std::filesystem::is_fifo(status) || std::filesystem::is_character_file(status);
+	}
+
+	// Private methods
+	// ---------------------------------------------------------------------------
+	bool FLKArchiveWriter::Write(const void* in_data, size_t in_size) {
+		if (in_size == 0) {
+			return true;
+		}
+		if (std::fwrite(in_data, 1, in_size, m_file) != in_size) {
+			return false;
+		}
+
+		m_currentOffset += in_size;
+		return true;
+	}
+
+} // namespace flakpak::io
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include <flakpak/flak_FrameReader.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+
+using namespace flakpak::data_types;
+
+namespace flakpak::io {
+	bool FrameReader::ReadRange(const FLK_PACKED_ENTRY& in_entry, uint64_t in_offset, uint64_t in_length, const FLKDataSink& in_sink) {
+		if (in_offset > in_entry.baseSize || in_length > in_entry.baseSize - in_offset) {
+			/// TODO
+			/// Handle error: range outside of the entry
+			/// Output to console
+			std::cout << "Error: Read range is outside of the entry.\n";
+			return false;
+		}
+		if (in_length == 0) {
+			return true;
+		}
+
+		uint64_t end = in_offset + in_length;
+
+		if (in_entry.chunkRefs) {
+			return ReadChunks(in_entry, in_offset, end, in_sink);
+		}
+
+		// Stored as is, the range is a plain slice of the blob
+		if (!in_entry.compressed && !in_entry.session) {
+			return in_sink(in_entry.packedData + in_offset, static_cast<size_t>(in_length));
+		}
+
+		if (!in_entry.frames || in_entry.frameCount == 0) {
+			return DecodeFrame(in_entry, in_entry.compressed, in_entry.packedData, in_entry.packedSize, 0, in_offset, end, in_sink);
+		}
+
+		// Last frame starting at or before in_offset, the first frame starts at 0
+		const FLKFrame* framesEnd = in_entry.frames + in_entry.frameCount;
+		const FLKFrame* frame = std::upper_bound(in_entry.frames + 1, framesEnd, in_offset, [](uint64_t in_value, const FLKFrame& in_frame) {
+			return in_value < in_frame.baseOffset;
+		}) - 1;
+
+		for (; frame != framesEnd && frame->baseOffset < end; ++frame) {
+			uint64_t packedEnd = (frame + 1 != framesEnd) ? (frame + 1)->packedOffset : in_entry.packedSize;
+			if (frame->packedOffset > packedEnd || packedEnd > in_entry.packedSize) {
+				std::cout << "Error: Corrupted seek table.\n";
+				return false;
+			}
+
+			if (!DecodeFrame(in_entry, in_entry.compressed, in_entry.packedData + frame->packedOffset, packedEnd - frame->packedOffset,
+				frame->baseOffset, in_offset, end, in_sink)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool FrameReader::ReadInto(const FLK_PACKED_ENTRY& in_entry, std::span<uint8_t> out_data) {
+		if (out_data.size() < in_entry.baseSize) {
+			/// TODO
+			/// Handle error: output buffer too small
+			/// Output to console
+			std::cout << "Error: Output buffer is smaller than the entry.\n";
+			return false;
+		}
+		out_data = out_data.first(static_cast<size_t>(in_entry.baseSize));
+
+		if (in_entry.chunkRefs) {
+			size_t chunkOffset = 0;
+			for (size_t i = 0; i < in_entry.chunkCount; i++) {
+				const FLKChunk& chunk = in_entry.chunks[in_entry.chunkRefs[i]];
+				if (chunk.baseSize > out_data.size() - chunkOffset) {
+					std::cout << "Error: Failed to decode entry data.\n";
+					return false;
+				}
+
+				bool compressed = in_entry.compressed && chunk.codec != FLK_CODEC_STORED;
+				const uint8_t* chunkData = in_entry.chunkData ? in_entry.chunkData[i] : in_entry.archiveData + chunk.offset;
+				std::span<const uint8_t> packed(chunkData, static_cast<size_t>(chunk.packedSize));
+				if (!DecodeFrameInto(in_entry, compressed, packed, out_data.subspan(chunkOffset, static_cast<size_t>(chunk.baseSize)))) {
+					return false;
+				}
+				chunkOffset += static_cast<size_t>(chunk.baseSize);
+			}
+			return chunkOffset == out_data.size();
+		}
+
+		std::span<const uint8_t> packed(in_entry.packedData, static_cast<size_t>(in_entry.packedSize));
+		if (!in_entry.frames || in_entry.frameCount == 0) {
+			return DecodeFrameInto(in_entry, in_entry.compressed, packed, out_data);
+		}
+
+		for (size_t i = 0; i < in_entry.frameCount; i++) {
+			const FLKFrame& frame = in_entry.frames[i];
+			bool last = i + 1 == in_entry.frameCount;
+			uint64_t packedEnd = last ? in_entry.packedSize : in_entry.frames[i + 1].packedOffset;
+			uint64_t baseEnd = last ? in_entry.baseSize : in_entry.frames[i + 1].baseOffset;
+			if (frame.packedOffset > packedEnd || packedEnd > in_entry.packedSize || frame.baseOffset > baseEnd || baseEnd > in_entry.baseSize) {
+				std::cout << "Error: Corrupted seek table.\n";
+				return false;
+			}
+
+			if (!DecodeFrameInto(in_entry, in_entry.compressed,
+				packed.subspan(static_cast<size_t>(frame.packedOffset), static_cast<size_t>(packedEnd - frame.packedOffset)),
+				out_data.subspan(static_cast<size_t>(frame.baseOffset), static_cast<size_t>(baseEnd - frame.baseOffset)))) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Private methods
+	// ---------------------------------------------------------------------------
+	bool FrameReader::ReadChunks(const FLK_PACKED_ENTRY& in_entry, uint64_t in_begin, uint64_t in_end, const FLKDataSink& in_sink) {
+		// Chunk offsets in the entry are the running sum of the chunk sizes
+		uint64_t chunkOffset = 0;
+		for (size_t i = 0; i < in_entry.chunkCount && chunkOffset < in_end; i++) {
+			const FLKChunk& chunk = in_entry.chunks[in_entry.chunkRefs[i]];
+			uint64_t chunkEnd = chunkOffset + chunk.baseSize;
+
+			if (chunkEnd > in_begin) {
+				const uint8_t* packed = in_entry.chunkData ? in_entry.chunkData[i] : in_entry.archiveData + chunk.offset;
+				bool compressed = in_entry.compressed && chunk.codec != FLK_CODEC_STORED;
+
+				bool read = (!compressed && !in_entry.session)
+					? in_sink(packed + (std::max(in_begin, chunkOffset) - chunkOffset),
+						static_cast<size_t>(std::min(in_end, chunkEnd) - std::max(in_begin, chunkOffset)))
+					: DecodeFrame(in_entry, compressed, packed, chunk.packedSize, chunkOffset, in_begin, in_end, in_sink);
+				if (!read) {
+					return false;
+				}
+			}
+
+			chunkOffset = chunkEnd;
+		}
+
+		return true;
+	}
+
+	bool FrameReader::DecodeFrame(const FLK_PACKED_ENTRY& in_entry, bool in_compressed,
+		const uint8_t* in_packed, uint64_t in_packedSize,
+		uint64_t in_frameOffset, uint64_t in_begin, uint64_t in_end,
+		const FLKDataSink& in_sink) {
+		// Forwards the decoded bytes that fall in the range, and stops the
+		// decoder once the range is complete
+		uint64_t position = in_frameOffset;
+		bool complete = false;
+		bool sinkFailed = false;
+		FLKDataSink window = [&](const uint8_t* in_data, size_t in_size) {
+			uint64_t from = std::max(position, in_begin);
+			uint64_t to = std::min(position + in_size, in_end);
+			if (from < to && !in_sink(in_data + (from - position), static_cast<size_t>(to - from))) {
+				sinkFailed = true;
+				return false;
+			}
+
+			position += in_size;
+			complete = position >= in_end;
+			return !complete;
+		};
+		FLKDataSink decompress = [this, &window](const uint8_t* in_data, size_t in_size) {
+			return m_decompressor.Push(in_data, in_size, window);
+		};
+		const FLKDataSink& plain = in_compressed ? decompress : window;
+
+		if (in_compressed && !m_decompressor.Begin(in_entry.dictionary)) {
+			return false;
+		}
+
+		bool decoded = false;
+		if (in_entry.session) {
+			m_decryptor.Begin(*in_entry.session);
+			decoded = m_decryptor.Push(in_packed, static_cast<size_t>(in_packedSize), plain) && m_decryptor.End(plain);
+		}
+		else {
+			decoded = plain(in_packed, static_cast<size_t>(in_packedSize));
+		}
+		decoded = decoded && (!in_compressed || m_decompressor.End());
+
+		// Stopping early is how a complete range ends, not an error
+		if (complete && !sinkFailed) {
+			return true;
+		}
+		if (!decoded || sinkFailed) {
+			/// TODO
+			/// Handle error: corrupted frame
+			/// Output to console
+			std::cout << "Error: Failed to decode entry data.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool FrameReader::DecodeFrameInto(const FLK_PACKED_ENTRY& in_entry, bool in_compressed,
+		std::span<const uint8_t> in_packed, std::span<uint8_t> out_frame) {
+		size_t decodedSize = 0;
+		bool decoded = false;
+
+		if (!in_entry.session && !in_compressed) {
+			decoded = in_packed.size() == out_frame.size();
+			if (decoded && !out_frame.empty()) {
+				std::memcpy(out_frame.data(), in_packed.data(), out_frame.size());
+			}
+			decodedSize = out_frame.size();
+		}
+		else if (!in_entry.session) {
+			decoded = m_decompressor.DecompressInto(in_packed, out_frame, decodedSize, in_entry.dictionary);
+		}
+		else if (!in_compressed) {
+			decoded = m_decryptor.DecryptInto(*in_entry.session, in_packed, out_frame, decodedSize);
+		}
+		else {
+			// The plaintext of a frame is always smaller than its encrypted blob
+			if (m_scratch.size() < in_packed.size()) {
+				m_scratch.resize(in_packed.size());
+			}
+
+			size_t compressedSize = 0;
+			decoded = m_decryptor.DecryptInto(*in_entry.session, in_packed, m_scratch, compressedSize) &&
+				m_decompressor.DecompressInto(std::span<const uint8_t>(m_scratch.data(), compressedSize), out_frame, decodedSize, in_entry.dictionary);
+		}
+
+		if (!decoded || decodedSize != out_frame.size()) {
+			/// TODO
+			/// Handle error: corrupted frame
+			/// Output to console
+			std::cout << "Error: Failed to decode entry data.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+} // namespace flakpak::io
@@ -0,0 +1,132 @@
+#include <flakpak/flak_MappedFile.hpp>
+
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace flakpak::io {
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+	bool MappedFile::Open(const std::filesystem::path& in_path, FLK_MAP_ACCESS in_access) {
+		Close();
+
+#ifdef _WIN32
+		DWORD flags = FILE_ATTRIBUTE_NORMAL;
+		if (in_access == FLK_MAP_ACCESS::SEQUENTIAL) {
+			flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+		}
+		HANDLE file = CreateFileW(in_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, flags, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			/// TODO
+			/// Handle error: failed to open file
+			/// Output to console
+			std::cout << "Error: Failed to open file: " << in_path.string() << "\n";
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize)) {
+			CloseHandle(file);
+			std::cout << "Error: Failed to read file size: " << in_path.string() << "\n";
+			return false;
+		}
+		m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+		if (m_size > 0) {
+			// The view keeps the mapping alive, the file handle is not needed afterwards
+			m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (m_mapping) {
+				m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+			}
+		}
+		CloseHandle(file);
+#else
+		int fd = ::open(in_path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			/// TODO
+			/// Handle error: failed to open file
+			/// Output to console
+			std::cout << "Error: Failed to open file: " << in_path.string() << "\n";
+			return false;
+		}
+
+		struct stat fileStat;
+		if (::fstat(fd, &fileStat) != 0) {
+			::close(fd);
+			std::cout << "Error: Failed to read file size: " << in_path.string() << "\n";
+			return false;
+		}
+		m_size = static_cast<uint64_t>(fileStat.st_size);
+
+		if (m_size > 0) {
+			void* mapping = ::mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapping != MAP_FAILED) {
+				::madvise(mapping, static_cast<size_t>(m_size),
+					in_access == FLK_MAP_ACCESS::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_NORMAL);
+				m_data = static_cast<const uint8_t*>(mapping);
+			}
+		}
+		::close(fd);
+#endif
+
+		if (m_size > 0 && !m_data) {
+			/// TODO
+			/// Handle error: failed to map file
+			/// Output to console
+			std::cout << "Error: Failed to map file: " << in_path.string() << "\n";
+			Close();
+			return false;
+		}
+
+		m_open = true;
+		return true;
+	}
+
+	void MappedFile::Close() {
+#ifdef _WIN32
+		if (m_data) {
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping) {
+			CloseHandle(m_mapping);
+			m_mapping = nullptr;
+		}
+#else
+		if (m_data) {
+			::munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+		}
+#endif
+
+		m_data = nullptr;
+		m_size = 0;
+		m_open = false;
+	}
+
+	const uint8_t* MappedFile::GetData() const {
+		return m_data;
+	}
+	uint64_t MappedFile::GetSize() const {
+		return m_size;
+	}
+	bool MappedFile::IsOpen() const {
+		return m_open;
+	}
+
+} // namespace flakpak::io
@@ -0,0 +1,131 @@
+#include <flakpak/flak_PackPipeline.hpp>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <optional>
+#include <algorithm>
+
+
+using namespace flakpak::data_types;
+
+namespace flakpak::pipeline {
+	PackPipeline::PackPipeline(size_t in_workerCount) {
+		if (in_workerCount == 0) {
+			in_workerCount = std::thread::hardware_concurrency();
+		}
+		m_workerCount = std::max<size_t>(in_workerCount, 1);
+		m_maxInFlight = m_workerCount * 2;
+	}
+
+	bool PackPipeline::Run(size_t in_jobCount, const ProcessFn& in_process, const CommitFn& in_commit) {
+		if (in_jobCount == 0) {
+			return true;
+		}
+
+		// Serial run, no need to spawn anything
+		if (m_workerCount == 1 || in_jobCount == 1) {
+			for (size_t i = 0; i < in_jobCount; i++) {
+				FLK_PACK_RESULT result;
+				if (!in_process(0, i, result)) {
+					result.failed = true;
+				}
+				if (!in_commit(i, result)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Results are kept in a ring of m_maxInFlight slots, workers never get
+		// further ahead of the committer than that so memory stays bounded
+		std::vector<std::optional<FLK_PACK_RESULT>> slots(m_maxInFlight);
+		std::mutex slotsMutex;
+		std::condition_variable slotReady;
+		std::condition_variable slotFreed;
+		std::atomic<size_t> nextJob { 0 };
+		std::atomic<bool> aborted { false };
+		size_t committedCount = 0;
+
+		auto worker = [&](size_t in_workerIndex) {
+			while (!aborted.load(std::memory_order_relaxed)) {
+				size_t jobIndex = nextJob.fetch_add(1, std::memory_order_relaxed);
+				if (jobIndex >= in_jobCount) {
+					break;
+				}
+
+				{
+					std::unique_lock<std::mutex> lock(slotsMutex);
+					slotFreed.wait(lock, [&] {
+						return jobIndex < committedCount + m_maxInFlight || aborted.load(std::memory_order_relaxed);
+					});
+				}
+				if (aborted.load(std::memory_order_relaxed)) {
+					break;
+				}
+
+				FLK_PACK_RESULT result;
+				if (!in_process(in_workerIndex, jobIndex, result)) {
+					result.failed = true;
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(slotsMutex);
+					slots[jobIndex % m_maxInFlight] = std::move(result);
+				}
+				slotReady.notify_all();
+			}
+		};
+
+		size_t threadCount = std::min(m_workerCount, in_jobCount);
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount);
+		for (size_t i = 0; i < threadCount; i++) {
+			threads.emplace_back(worker, i);
+		}
+
+		// Ordered commit on the calling thread
+		bool success = true;
+		for (size_t i = 0; i < in_jobCount; i++) {
+			auto& slot = slots[i % m_maxInFlight];
+
+			FLK_PACK_RESULT result;
+			{
+				std::unique_lock<std::mutex> lock(slotsMutex);
+				slotReady.wait(lock, [&] { return slot.has_value(); });
+				result = std::move(*slot);
+				slot.reset();
+			}
+
+			bool committed = in_commit(i, result);
+			{
+				std::lock_guard<std::mutex> lock(slotsMutex);
+				committedCount = i + 1;
+			}
+			slotFreed.notify_all();
+
+			if (!committed) {
+				success = false;
+				break;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(slotsMutex);
+			aborted.store(true, std::memory_order_relaxed);
+		}
+		slotFreed.notify_all();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		return success;
+	}
+
+	size_t PackPipeline::GetWorkerCount() const {
+		return m_workerCount;
+	}
+
+} // namespace flakpak::pipeline
\ No newline at end of file
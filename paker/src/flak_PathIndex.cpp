@@ -0,0 +1,220 @@
+#include <flakpak/flak_PathIndex.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <iostream>
+
+
+using namespace flakpak::data_types;
+
+namespace flakpak::pathcom {
+	static constexpr uint64_t FLK_PATH_INDEX_SEED = 0x464C4B5041544831;	// "FLKPATH1"
+	static constexpr uint32_t FLK_PATH_INDEX_BUCKET_SIZE = 4;			// Average number of paths per bucket
+	static constexpr uint32_t FLK_PATH_INDEX_LOAD_PERCENT = 90;		// Paths per 100 slots, the free slots keep the last buckets cheap to place
+	static constexpr uint32_t FLK_PATH_INDEX_MAX_PILOT = 1 << 20;		// Pilots tried per bucket before changing the seed
+	static constexpr uint32_t FLK_PATH_INDEX_MAX_SEEDS = 16;			// Seeds tried before giving up
+
+	// splitmix64 finalizer
+	static uint64_t Mix(uint64_t in_value) {
+		in_value = (in_value ^ (in_value >> 30)) * 0xBF58476D1CE4E5B9;
+		in_value = (in_value ^ (in_value >> 27)) * 0x94D049BB133111EB;
+		return in_value ^ (in_value >> 31);
+	}
+
+	bool PathIndex::Build(const std::vector<std::string>& in_paths, std::vector<uint8_t>& out_payload) {
+		uint32_t pathCount = static_cast<uint32_t>(in_paths.size());
+		uint64_t wantedSlots = (static_cast<uint64_t>(pathCount) * 100 + FLK_PATH_INDEX_LOAD_PERCENT - 1) / FLK_PATH_INDEX_LOAD_PERCENT;
+		uint32_t slotCount = static_cast<uint32_t>(std::min<uint64_t>(wantedSlots, std::numeric_limits<uint32_t>::max()));
+		uint32_t bucketCount = std::max<uint32_t>(1, (pathCount + FLK_PATH_INDEX_BUCKET_SIZE - 1) / FLK_PATH_INDEX_BUCKET_SIZE);
+
+		std::vector<uint64_t> hashes(slotCount);
+		std::vector<uint32_t> pilots(bucketCount);
+		std::vector<uint32_t> entries(slotCount);
+		std::vector<std::vector<uint32_t>> buckets(bucketCount);
+		std::vector<uint32_t> bucketOrder(bucketCount);
+		std::vector<bool> taken(slotCount);
+		std::vector<uint32_t> slots;
+
+		for (uint32_t attempt = 0; attempt < FLK_PATH_INDEX_MAX_SEEDS; attempt++) {
+			uint64_t seed = FLK_PATH_INDEX_SEED + attempt;
+
+			for (auto& bucket : buckets) {
+				bucket.clear();
+			}
+			for (uint32_t i = 0; i < pathCount; i++) {
+				uint64_t hash = HashPath(in_paths[i], seed);
+				buckets[hash % bucketCount].push_back(i);
+			}
+
+			// Largest buckets first, they are the hardest to place
+			for (uint32_t b = 0; b < bucketCount; b++) {
+				bucketOrder[b] = b;
+			}
+			std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&buckets](uint32_t in_a, uint32_t in_b) {
+				return buckets[in_a].size() > buckets[in_b].size();
+			});
+
+			std::fill(taken.begin(), taken.end(), false);
+			std::fill(pilots.begin(), pilots.end(), 0);
+			std::fill(hashes.begin(), hashes.end(), 0);
+			std::fill(entries.begin(), entries.end(), FLK_PATH_INDEX_EMPTY_SLOT);
+			bool placed = true;
+
+			for (uint32_t b : bucketOrder) {
+				const std::vector<uint32_t>& bucket = buckets[b];
+				if (bucket.empty()) {
+					break;
+				}
+
+				bool found = false;
+				for (uint32_t pilot = 0; pilot < FLK_PATH_INDEX_MAX_PILOT && !found; pilot++) {
+					slots.clear();
+					found = true;
+					for (uint32_t path : bucket) {
+						uint32_t slot = GetSlot(HashPath(in_paths[path], seed), pilot, slotCount);
+						if (taken[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+							found = false;
+							break;
+						}
+						slots.push_back(slot);
+					}
+
+					if (found) {
+						pilots[b] = pilot;
+						for (size_t k = 0; k < bucket.size(); k++) {
+							taken[slots[k]] = true;
+							hashes[slots[k]] = HashPath(in_paths[bucket[k]], seed);
+							entries[slots[k]] = bucket[k];
+						}
+					}
+				}
+
+				if (!found) {
+					placed = false;
+					break;
+				}
+			}
+
+			if (!placed) {
+				continue;
+			}
+
+			FLKPathIndex header;
+			header.slotCount = slotCount;
+			header.bucketCount = bucketCount;
+			header.seed = seed;
+
+			out_payload.resize(sizeof(header) + slotCount * sizeof(uint64_t) + bucketCount * sizeof(uint32_t) + slotCount * sizeof(uint32_t));
+			uint8_t* out = out_payload.data();
+			std::memcpy(out, &header, sizeof(header));
+			out += sizeof(header);
+			std::memcpy(out, hashes.data(), hashes.size() * sizeof(uint64_t));
+			out += hashes.size() * sizeof(uint64_t);
+			std::memcpy(out, pilots.data(), pilots.size() * sizeof(uint32_t));
+			out += pilots.size() * sizeof(uint32_t);
+			std::memcpy(out, entries.data(), entries.size() * sizeof(uint32_t));
+			return true;
+		}
+
+		/// TODO
+		/// Handle error: no perfect hash found
+		/// Output to console
+		std::cout << "Error: Failed to build the path index.\n";
+		return false;
+	}
+
+	bool PathIndex::Load(const std::vector<uint8_t>& in_payload, size_t in_entryCount) {
+		Clear();
+
+		FLKPathIndex header;
+		if (in_payload.size() >= sizeof(header)) {
+			std::memcpy(&header, in_payload.data(), sizeof(header));
+		}
+
+		size_t expectedSize = sizeof(header) + static_cast<size_t>(header.slotCount) * (sizeof(uint64_t) + sizeof(uint32_t)) +
+			static_cast<size_t>(header.bucketCount) * sizeof(uint32_t);
+		if (in_payload.size() < sizeof(header) || header.slotCount < in_entryCount || header.bucketCount == 0 ||
+			in_payload.size() != expectedSize) {
+			/// TODO
+			/// Handle error: malformed path index
+			/// Output to console
+			std::cout << "Error: Corrupted archive, invalid path index.\n";
+			return false;
+		}
+
+		m_hashes.resize(header.slotCount);
+		m_pilots.resize(header.bucketCount);
+		m_entries.resize(header.slotCount);
+
+		const uint8_t* in = in_payload.data() + sizeof(header);
+		std::memcpy(m_hashes.data(), in, m_hashes.size() * sizeof(uint64_t));
+		in += m_hashes.size() * sizeof(uint64_t);
+		std::memcpy(m_pilots.data(), in, m_pilots.size() * sizeof(uint32_t));
+		in += m_pilots.size() * sizeof(uint32_t);
+		std::memcpy(m_entries.data(), in, m_entries.size() * sizeof(uint32_t));
+
+		// Every entry must own exactly one slot, the others are empty
+		std::vector<bool> seen(in_entryCount, false);
+		size_t usedSlots = 0;
+		for (uint32_t entry : m_entries) {
+			if (entry == FLK_PATH_INDEX_EMPTY_SLOT) {
+				continue;
+			}
+			if (entry >= in_entryCount || seen[entry]) {
+				std::cout << "Error: Corrupted archive, invalid path index.\n";
+				Clear();
+				return false;
+			}
+			seen[entry] = true;
+			usedSlots++;
+		}
+		if (usedSlots != in_entryCount) {
+			std::cout << "Error: Corrupted archive, invalid path index.\n";
+			Clear();
+			return false;
+		}
+
+		m_header = header;
+		return true;
+	}
+
+	void PathIndex::Clear() {
+		m_header = FLKPathIndex();
+		m_hashes.clear();
+		m_pilots.clear();
+		m_entries.clear();
+	}
+
+	size_t PathIndex::Find(std::string_view in_path) const {
+		if (m_header.slotCount == 0) {
+			return FLK_ENTRY_NOT_FOUND;
+		}
+
+		uint64_t hash = HashPath(in_path, m_header.seed);
+		uint32_t slot = GetSlot(hash, m_pilots[hash % m_header.bucketCount], m_header.slotCount);
+
+		if (m_hashes[slot] != hash || m_entries[slot] == FLK_PATH_INDEX_EMPTY_SLOT) {
+			return FLK_ENTRY_NOT_FOUND;
+		}
+		return m_entries[slot];
+	}
+
+	bool PathIndex::IsLoaded() const {
+		return m_header.bucketCount != 0;
+	}
+
+	uint64_t PathIndex::HashPath(std::string_view in_path, uint64_t in_seed) {
+		uint64_t hash = 0xCBF29CE484222325 ^ in_seed;
+		for (char c : in_path) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001B3;
+		}
+		return Mix(hash);
+	}
+
+	uint32_t PathIndex::GetSlot(uint64_t in_hash, uint32_t in_pilot, uint32_t in_slotCount) {
+		return static_cast<uint32_t>(Mix(in_hash ^ (in_pilot * 0x9E3779B97F4A7C15)) % in_slotCount);
+	}
+
+} // namespace flakpak::pathcom
@@ -0,0 +1,115 @@
+#include <flakpak/flak_SolidBlockCache.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+
+using namespace flakpak::data_types;
+
+namespace flakpak::io {
+	SolidBlockCache::SolidBlockCache(size_t in_capacity)
+		: m_blocks(std::max<size_t>(in_capacity, 1)) {
+	}
+
+	bool SolidBlockCache::ReadEntry(uint32_t in_blockIndex,
+		const FLKSolidBlock& in_block,
+		const uint8_t* in_packedBlock,
+		uint64_t in_offset,
+		uint64_t in_size,
+		const encryption::xccp20::XChaCha20Poly1305KeySession* in_session,
+		const uint8_t*& out_data) {
+		if (in_offset > in_block.baseSize || in_size > in_block.baseSize - in_offset) {
+			/// TODO
+			/// Handle error: entry outside of its block
+			/// Output to console
+			std::cout << "Error: Entry is outside of solid block " << in_blockIndex << ".\n";
+			return false;
+		}
+
+		auto cached = std::find_if(m_blocks.begin(), m_blocks.end(), [in_blockIndex](const CachedBlock& in_cached) {
+			return in_cached.index == in_blockIndex;
+		});
+
+		if (cached != m_blocks.end()) {
+			m_hits++;
+		}
+		else {
+			// Miss: reuse the least recently used slot (and its buffer)
+			m_misses++;
+			cached = std::min_element(m_blocks.begin(), m_blocks.end(), [](const CachedBlock& in_a, const CachedBlock& in_b) {
+				return in_a.lastUse < in_b.lastUse;
+			});
+
+			cached->index = FLK_NOT_SOLID;
+			if (!DecodeBlock(in_block, in_packedBlock, in_session, cached->data)) {
+				return false;
+			}
+			cached->index = in_blockIndex;
+		}
+
+		cached->lastUse = ++m_useCounter;
+		out_data = cached->data.data() + in_offset;
+		return true;
+	}
+
+	void SolidBlockCache::Clear() {
+		for (CachedBlock& cached : m_blocks) {
+			cached.index = FLK_NOT_SOLID;
+			cached.lastUse = 0;
+			cached.data.clear();
+			cached.data.shrink_to_fit();
+		}
+	}
+
+	uint64_t SolidBlockCache::GetHitCount() const {
+		return m_hits;
+	}
+	uint64_t SolidBlockCache::GetMissCount() const {
+		return m_misses;
+	}
+
+	// Private methods
+	// ---------------------------------------------------------------------------
+	bool SolidBlockCache::DecodeBlock(const FLKSolidBlock& in_block,
+		const uint8_t* in_packedBlock,
+		const encryption::xccp20::XChaCha20Poly1305KeySession* in_session,
+		std::vector<uint8_t>& out_data) {
+		out_data.clear();
+		out_data.reserve(static_cast<size_t>(in_block.baseSize));
+
+		FLKDataSink store = [&out_data, &in_block](const uint8_t* in_data, size_t in_size) {
+			if (out_data.size() + in_size > in_block.baseSize) {
+				return false;
+			}
+			out_data.insert(out_data.end(), in_data, in_data + in_size);
+			return true;
+		};
+		FLKDataSink decompress = [this, &store](const uint8_t* in_data, size_t in_size) {
+			return m_decompressor.Push(in_data, in_size, store);
+		};
+
+		// Solid blocks are always compressed, and encrypted like any blob
+		bool decoded = m_decompressor.Begin();
+		if (decoded && in_session) {
+			m_decryptor.Begin(*in_session);
+			decoded = m_decryptor.Push(in_packedBlock, static_cast<size_t>(in_block.packedSize), decompress) &&
+				m_decryptor.End(decompress);
+		}
+		else if (decoded) {
+			decoded = decompress(in_packedBlock, static_cast<size_t>(in_block.packedSize));
+		}
+		decoded = decoded && m_decompressor.End() && out_data.size() == in_block.baseSize;
+
+		if (!decoded) {
+			/// TODO
+			/// Handle error: corrupted solid block
+			/// Output to console
+			std::cout << "Error: Failed to decode solid block.\n";
+			out_data.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+} // namespace flakpak::io
@@ -1,6 +1,9 @@
 #include <flakpak/flak_PasswordHandler.hpp>
 #include <flakpak/flak_FLKDefinition.hpp>
 #include <flakpak/flak_FLKPacker.hpp>
+#include <flakpak/flak_FLKExtractor.hpp>
+#include <flakpak/flak_FLKVerifier.hpp>
+#include <flakpak/flak_FLKWriter.hpp>
 
 #include <flakpak/zstd_Compressor.hpp>
 #include <flakpak/xccp20_Encryptor.hpp>
@@ -15,10 +18,52 @@
 #include <string>
 #include <iomanip>
 #include <memory>
+#include <sstream>
+#include <algorithm>
 
 
 namespace fs = std::filesystem;
 
+// Parses a zstd parameter list like "wlog=27,strat=9" (the zstd CLI --zstd= syntax)
+static bool ParseZstdParams(const std::string& in_list, flakpak::data_types::FLK_ZSTD_PARAMS& io_params) {
+    using ZstdParams = flakpak::data_types::FLK_ZSTD_PARAMS;
+    const std::pair<const char*, int ZstdParams::*> names[] = {
+        { "windowLog", &ZstdParams::windowLog },       { "wlog", &ZstdParams::windowLog },
+        { "chainLog", &ZstdParams::chainLog },         { "clog", &ZstdParams::chainLog },
+        { "hashLog", &ZstdParams::hashLog },           { "hlog", &ZstdParams::hashLog },
+        { "searchLog", &ZstdParams::searchLog },       { "slog", &ZstdParams::searchLog },
+        { "minMatch", &ZstdParams::minMatch },         { "mml", &ZstdParams::minMatch },
+        { "targetLength", &ZstdParams::targetLength }, { "tlen", &ZstdParams::targetLength },
+        { "strategy", &ZstdParams::strategy },         { "strat", &ZstdParams::strategy },
+    };
+
+    std::stringstream list(in_list);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        size_t separator = item.find('=');
+        if (separator == std::string::npos) {
+            return false;
+        }
+
+        std::string name = item.substr(0, separator);
+        auto match = std::find_if(std::begin(names), std::end(names), [&name](const auto& in_name) {
+            return name == in_name.first;
+        });
+        if (match == std::end(names)) {
+            return false;
+        }
+
+        try {
+            io_params.*(match->second) = std::stoi(item.substr(separator + 1));
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     // --- CLI11 SETUP ---
     CLI::App app{ "PAK file packer tool" };
@@ -29,43 +74,208 @@ int main(int argc, char* argv[]) {
     uint32_t contentVersion = 0;
     bool useCompression = false;
     bool useEncryption = false;
+    size_t jobCount = 1;
+    bool useStream = false;
+    uint32_t kdfTargetMs = 0;
+    bool trainDictionaries = false;
+    std::string dictionaryGroup = "ext";
+    uint64_t solidBlockKiB = 0;
+    uint64_t frameKiB = 0;
+    bool compressAll = false;
+    bool noDedup = false;
+    uint64_t chunkKiB = 0;
+    int formatVersion = flakpak::FLK_FORMAT_VERSION_1;
+    uint64_t blobAlignment = 0;
+    flakpak::data_types::FLK_ZSTD_PARAMS zstdParams;
+    uint64_t largeInputMiB = zstdParams.largeInputThreshold >> 20;
+    int zstdJobMiB = 0;
+    std::string zstdParamList;
+    fs::path archivePath;
+    fs::path extractDir;
+    size_t extractJobCount = 0;
+    std::vector<std::string> extractFilters;
+    size_t verifyJobCount = 0;
+    bool verifyDecode = false;
 
+    // Packing keeps the bare syntax, input_dir and output are checked after parsing
     app.add_option("input_dir", inputDir, "Input directory to pack")
-        ->required()->check(CLI::ExistingDirectory);
+        ->check(CLI::ExistingDirectory);
+
+    app.add_option("output", outPath, "Output .flk file ('-' writes to stdout)");
+
+    auto* extractCommand = app.add_subcommand("extract", "Extract an archive into a directory");
+
+    extractCommand->add_option("archive", archivePath, "Archive to extract")
+        ->required()->check(CLI::ExistingFile);
+
+    extractCommand->add_option("output_dir", extractDir, "Directory receiving the extracted files")->required();
+
+    extractCommand->add_option("-j,--jobs", extractJobCount,
+        "Number of worker threads used to decode and write entries (0 = all cores)")->default_val(0);
+
+    extractCommand->add_option("-f,--filter", extractFilters,
+        "Only extract entries whose path matches this pattern ('*' and '?' wildcards), can be repeated");
 
-    app.add_option("output", outPath, "Output .flk file")->required();
+    auto* verifyCommand = app.add_subcommand("verify", "Check every entry of an archive against its stored checksums");
+
+    verifyCommand->add_option("archive", archivePath, "Archive to verify")
+        ->required()->check(CLI::ExistingFile);
+
+    verifyCommand->add_option("-j,--jobs", verifyJobCount,
+        "Number of worker threads used to hash and decode entries (0 = all cores)")->default_val(0);
+
+    verifyCommand->add_flag("--decode", verifyDecode,
+        "Also decode every entry and check its size and the checksum of the original file");
 
     app.add_option("-c,--compression", compressionLevel,
         "Compression level (1-22 for Zstd)")->default_val(3);
 
-    app.add_flag("--compress", useCompression, "Enable compression");
+    auto* compressFlag = app.add_flag("--compress", useCompression, "Enable compression");
     app.add_flag("--encrypt", useEncryption, "Enable encryption");
 
     app.add_option("--content-version", contentVersion,
         "Custom content version number")->default_val(0);
 
+    app.add_option("-j,--jobs", jobCount,
+        "Number of worker threads used to pack entries (0 = all cores)")->default_val(1);
+
+    app.add_flag("--stream", useStream,
+        "Write the header in the trailer so the archive is written in one pass (implied for stdout and pipes)");
+
+    app.add_option("--kdf-ms", kdfTargetMs,
+        "Calibrate the Argon2id key derivation to take about this many milliseconds (0 = default limits)")->default_val(0);
+
+    app.add_flag("--train-dict", trainDictionaries,
+        "Train zstd dictionaries for groups of small files and store them in the archive")->needs(compressFlag);
+
+    app.add_option("--dict-group", dictionaryGroup,
+        "How files are grouped when training dictionaries (ext or dir)")
+        ->default_val("ext")->check(CLI::IsMember({ "ext", "dir" }));
+
+    app.add_option("--solid", solidBlockKiB,
+        "Pack small files into shared compressed blocks of about this many KiB (0 = off)")
+        ->default_val(0)->needs(compressFlag);
+
+    app.add_option("--frame-size", frameKiB,
+        "Split larger files into independently decodable frames of this many KiB for random access (0 = off)")
+        ->default_val(0);
+
+    app.add_flag("--no-dedup", noDedup,
+        "Pack identical files separately instead of sharing a single copy");
+
+    app.add_option("--chunk", chunkKiB,
+        "Split files larger than this many KiB into content-defined chunks and store every distinct chunk once (0 = off)")
+        ->default_val(0)->check(CLI::Range(0, 1024));
+
+    app.add_option("--format", formatVersion,
+        "Archive format version: 1 (fixed 256 entry header at the start of the file) or 2 (variable entry table in the trailer, no entry or path length limit)")
+        ->default_val(formatVersion)->check(CLI::IsMember({ 1, 2 }));
+
+    app.add_option("--align", blobAlignment,
+        "Start every blob on a multiple of this many bytes, a power of two such as 4096 (0 = off)")
+        ->default_val(0)->check(CLI::Range(uint64_t(0), uint64_t(1) << 30));
+
+    app.add_flag("--compress-all", compressAll,
+        "Compress every file, even known compressed formats and files that do not shrink (stored otherwise)")
+        ->needs(compressFlag);
+
+    app.add_option("--zstd-workers", zstdParams.workerCount,
+        "zstd worker threads used for each large file (0 = compress it on a single thread)")
+        ->default_val(0)->needs(compressFlag);
+
+    app.add_option("--zstd-job-size", zstdJobMiB,
+        "MiB of input per zstd worker job (0 = zstd default)")
+        ->default_val(0)->check(CLI::Range(0, 1024))->needs(compressFlag);
+
+    app.add_flag("--long", zstdParams.longDistanceMatching,
+        "Enable zstd long distance matching for large files")->needs(compressFlag);
+
+    app.add_option("--zstd-params", zstdParamList,
+        "zstd parameters for large files, e.g. wlog=27,clog=24,hlog=25,slog=6,mml=5,tlen=64,strat=9")
+        ->needs(compressFlag);
+
+    app.add_option("--large-threshold", largeInputMiB,
+        "Files of at least this many MiB use the zstd workers, long distance matching and zstd parameters")
+        ->default_val(largeInputMiB)->needs(compressFlag);
+
     CLI11_PARSE(app, argc, argv);
 
-    // Call appropriate packing method based on flags
-    bool success = false;
+    if (*extractCommand) {
+        flakpak::FLK_EXTRACT_OPTIONS extractOptions;
+        extractOptions.jobCount = extractJobCount;
+        extractOptions.filters = extractFilters;
+
+        if (!flakpak::FLKExtractor::ExtractArchive(archivePath, extractDir, extractOptions)) {
+            std::cerr << "Extraction failed!\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (*verifyCommand) {
+        flakpak::FLK_VERIFY_OPTIONS verifyOptions;
+        verifyOptions.jobCount = verifyJobCount;
+        verifyOptions.decode = verifyDecode;
+
+        if (!flakpak::FLKVerifier::VerifyArchive(archivePath, verifyOptions)) {
+            std::cerr << "Verification failed!\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (inputDir.empty() || outPath.empty()) {
+        std::cerr << app.help();
+        return 1;
+    }
+
+    // The archive itself goes to stdout, keep the console output out of it
+    if (outPath == flakpak::io::FLK_STDOUT_PATH) {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    flakpak::FLK_PACK_OPTIONS packOptions;
+    packOptions.compress = useCompression;
+    packOptions.encrypt = useEncryption;
+    packOptions.compressionLevel = compressionLevel;
+    packOptions.jobCount = jobCount;
+    packOptions.stream = useStream;
+    packOptions.kdfTargetMs = kdfTargetMs;
+    packOptions.trainDictionaries = trainDictionaries;
+    packOptions.dictionaryGrouping = dictionaryGroup == "dir"
+        ? flakpak::FLK_DICTIONARY_GROUPING::DIRECTORY
+        : flakpak::FLK_DICTIONARY_GROUPING::EXTENSION;
+    packOptions.solidBlockSize = solidBlockKiB << 10;
+    packOptions.frameSize = frameKiB << 10;
+    packOptions.detectCodec = !compressAll;
+    packOptions.deduplicate = !noDedup;
+    packOptions.chunkSize = chunkKiB << 10;
+    packOptions.formatVersion = static_cast<uint8_t>(formatVersion);
+    packOptions.blobAlignment = blobAlignment;
+
+    if (!ParseZstdParams(zstdParamList, zstdParams)) {
+        std::cerr << "Invalid --zstd-params value: " << zstdParamList << "\n";
+        return 1;
+    }
+    zstdParams.largeInputThreshold = largeInputMiB << 20;
+    zstdParams.jobSize = zstdJobMiB << 20;
+    packOptions.zstdParams = zstdParams;
 
     if (!useCompression && !useEncryption) {
         std::cout << "Mode: Uncompressed + Unencrypted\n";
-        success = flakpak::FLKPacker::PackUncompressedAndUnencrypted(inputDir, outPath);
     }
     else if (useCompression && !useEncryption) {
         std::cout << "Mode: Compressed + Unencrypted (level " << compressionLevel << ")\n";
-        success = flakpak::FLKPacker::PackCompressedAndUnencrypted(inputDir, outPath, compressionLevel);
     }
     else if (!useCompression && useEncryption) {
         std::cout << "Mode: Uncompressed + Encrypted\n";
-        success = flakpak::FLKPacker::PackUncompressedAndEncrypted(inputDir, outPath);
     }
     else { // useCompression && useEncryption
         std::cout << "Mode: Compressed + Encrypted (level " << compressionLevel << ")\n";
-        success = flakpak::FLKPacker::PackCompressedAndEncrypted(inputDir, outPath, compressionLevel);
     }
 
+    bool success = flakpak::FLKPacker::PackDirectory(inputDir, outPath, packOptions);
+
     if (!success) {
         std::cerr << "Packing failed!\n";
         return 1;
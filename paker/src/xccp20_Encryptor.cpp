@@ -2,6 +2,7 @@
 
 #include <libsodium/sodium.h>
 #include <iostream>
+#include <algorithm>
 
 
 using namespace flakpak::data_types;
@@ -100,6 +101,128 @@ namespace flakpak::encryption::xccp20 {
 		return decryptedData;
 	}
 
+	FLK_ENCRYPTION_RESULT XChaCha20Poly1305Encryptor::EncryptData(const std::vector<uint8_t>& in_data,
+		const XChaCha20Poly1305KeySession& in_session) {
+		// Generate random nonce, its first bytes select the entry subkey
+		std::vector<uint8_t> nonce(crypto_aead_xchacha20poly1305_ietf_NPUBBYTES);
+		randombytes_buf(nonce.data(), nonce.size());
+
+		unsigned char key[crypto_aead_xchacha20poly1305_ietf_KEYBYTES];
+		in_session.DeriveSubkey(XChaCha20Poly1305KeySession::GetSubkeyId(nonce.data()), key);
+
+		// Encrypt straight after the nonce, no intermediate ciphertext buffer
+		std::vector<uint8_t> encryptedData(nonce.size() + in_data.size() + crypto_aead_xchacha20poly1305_ietf_ABYTES);
+		std::copy(nonce.begin(), nonce.end(), encryptedData.begin());
+		unsigned long long ciphertextLen = 0;
+
+		int result = crypto_aead_xchacha20poly1305_ietf_encrypt(
+			encryptedData.data() + nonce.size(), &ciphertextLen,
+			in_data.data(), in_data.size(),
+			nullptr, 0, nullptr,
+			nonce.data(), key
+		);
+		sodium_memzero(key, sizeof(key));
+		if (result != 0) {
+			/// TODO
+			/// Handle encryption error 
+			/// Output to console and close encryption process
+			std::cout << "Error: Encryption failed.\n";
+			return {};
+		}
+
+		encryptedData.resize(nonce.size() + ciphertextLen);
+
+		FLK_ENCRYPTION_RESULT encryptionResult;
+		encryptionResult.data = std::move(encryptedData);
+		encryptionResult.salt = in_session.GetSalt();
+		encryptionResult.nonce = std::move(nonce);
+
+		return encryptionResult;
+	}
+
+	std::vector<uint8_t> XChaCha20Poly1305Encryptor::DecryptData(const std::vector<uint8_t>& in_encryptedData,
+		const XChaCha20Poly1305KeySession& in_session) {
+		if (in_encryptedData.size() < crypto_aead_xchacha20poly1305_ietf_NPUBBYTES + crypto_aead_xchacha20poly1305_ietf_ABYTES) {
+			/// TODO
+			/// Handle error: Encrypted data too short
+			/// Output to console and close decryption process
+			std::cout << "Error: Encrypted data too short.\n";
+			return std::vector<uint8_t>();
+		}
+
+		// Extract nonce and ciphertext
+		const unsigned char* nonce = in_encryptedData.data();
+		const unsigned char* ciphertext = in_encryptedData.data() + crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+		size_t ciphertextLen = in_encryptedData.size() - crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+
+		unsigned char key[crypto_aead_xchacha20poly1305_ietf_KEYBYTES];
+		in_session.DeriveSubkey(XChaCha20Poly1305KeySession::GetSubkeyId(nonce), key);
+
+		// Decrypt
+		std::vector<uint8_t> decryptedData(ciphertextLen - crypto_aead_xchacha20poly1305_ietf_ABYTES);
+		unsigned long long decryptedLen = 0;
+		int result = crypto_aead_xchacha20poly1305_ietf_decrypt(
+			decryptedData.data(), &decryptedLen,
+			nullptr,
+			ciphertext, ciphertextLen,
+			nullptr, 0,
+			nonce, key
+		);
+		sodium_memzero(key, sizeof(key));
+
+		if (result != 0) {
+			/// TODO
+			/// Handle decryption error (e.g., authentication failure)
+			/// Output to console and close decryption process
+			std::cout << "Error: Decryption failed or data is tampered.\n";
+			return std::vector<uint8_t>();
+		}
+
+		decryptedData.resize(decryptedLen);
+		return decryptedData;
+	}
+
+	bool XChaCha20Poly1305Encryptor::DecryptInPlace(std::span<uint8_t> io_data,
+		const XChaCha20Poly1305KeySession& in_session,
+		std::span<uint8_t>& out_plain) {
+		if (io_data.size() < crypto_aead_xchacha20poly1305_ietf_NPUBBYTES + crypto_aead_xchacha20poly1305_ietf_ABYTES) {
+			/// TODO
+			/// Handle error: Encrypted data too short
+			/// Output to console and close decryption process
+			std::cout << "Error: Encrypted data too short.\n";
+			return false;
+		}
+
+		const unsigned char* nonce = io_data.data();
+		unsigned char* ciphertext = io_data.data() + crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+		size_t ciphertextLen = io_data.size() - crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+
+		unsigned char key[crypto_aead_xchacha20poly1305_ietf_KEYBYTES];
+		in_session.DeriveSubkey(XChaCha20Poly1305KeySession::GetSubkeyId(nonce), key);
+
+		// libsodium allows the message and the ciphertext to be the same buffer
+		unsigned long long decryptedLen = 0;
+		int result = crypto_aead_xchacha20poly1305_ietf_decrypt(
+			ciphertext, &decryptedLen,
+			nullptr,
+			ciphertext, ciphertextLen,
+			nullptr, 0,
+			nonce, key
+		);
+		sodium_memzero(key, sizeof(key));
+
+		if (result != 0) {
+			/// TODO
+			/// Handle decryption error (e.g., authentication failure)
+			/// Output to console and close decryption process
+			std::cout << "Error: Decryption failed or data is tampered.\n";
+			return false;
+		}
+
+		out_plain = io_data.subspan(crypto_aead_xchacha20poly1305_ietf_NPUBBYTES, static_cast<size_t>(decryptedLen));
+		return true;
+	}
+
 	size_t XChaCha20Poly1305Encryptor::GetNonceSize() const {
 		return crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
 	}
@@ -123,4 +246,315 @@ namespace flakpak::encryption::xccp20 {
 		);
 	}
 
+	// XChaCha20Poly1305StreamEncryptor
+	// ---------------------------------------------------------------------------
+	static constexpr size_t FLK_STREAM_CHUNK_OVERHEAD = crypto_secretstream_xchacha20poly1305_ABYTES;
+	static constexpr size_t FLK_STREAM_SUBKEY_ID_SIZE = sizeof(uint64_t);
+	static constexpr size_t FLK_STREAM_HEADER_SIZE = FLK_STREAM_SUBKEY_ID_SIZE + crypto_secretstream_xchacha20poly1305_HEADERBYTES;
+
+	XChaCha20Poly1305StreamEncryptor::XChaCha20Poly1305StreamEncryptor()
+		: m_state(std::make_unique<crypto_secretstream_xchacha20poly1305_state>()),
+		m_cipherChunk(FLK_ENCRYPTION_CHUNK_SIZE + FLK_STREAM_CHUNK_OVERHEAD) {
+		m_plainChunk.reserve(FLK_ENCRYPTION_CHUNK_SIZE);
+	}
+	XChaCha20Poly1305StreamEncryptor::~XChaCha20Poly1305StreamEncryptor() {
+		sodium_memzero(m_state.get(), sizeof(crypto_secretstream_xchacha20poly1305_state));
+	}
+
+	bool XChaCha20Poly1305StreamEncryptor::Begin(const XChaCha20Poly1305KeySession& in_session, const FLKDataSink& in_sink) {
+		// Random subkey identifier followed by the secretstream header
+		unsigned char header[FLK_STREAM_HEADER_SIZE];
+		randombytes_buf(header, FLK_STREAM_SUBKEY_ID_SIZE);
+
+		unsigned char key[crypto_secretstream_xchacha20poly1305_KEYBYTES];
+		in_session.DeriveSubkey(XChaCha20Poly1305KeySession::GetSubkeyId(header), key);
+
+		int result = crypto_secretstream_xchacha20poly1305_init_push(m_state.get(), header + FLK_STREAM_SUBKEY_ID_SIZE, key);
+		sodium_memzero(key, sizeof(key));
+		if (result != 0) {
+			/// TODO
+			/// Handle encryption error
+			/// Output to console and close encryption process
+			std::cout << "Error: Encryption failed.\n";
+			return false;
+		}
+
+		m_plainChunk.clear();
+		return in_sink(header, sizeof(header));
+	}
+
+	bool XChaCha20Poly1305StreamEncryptor::Push(const uint8_t* in_data, size_t in_size, const FLKDataSink& in_sink) {
+		while (in_size > 0) {
+			// Full chunks are encrypted straight from the caller's memory (a
+			// mapped file for instance) when nothing is buffered, as long as
+			// more data follows since the last chunk must carry the final tag
+			if (m_plainChunk.empty() && in_size > FLK_ENCRYPTION_CHUNK_SIZE) {
+				if (!EmitChunk(in_data, FLK_ENCRYPTION_CHUNK_SIZE, false, in_sink)) {
+					return false;
+				}
+				in_data += FLK_ENCRYPTION_CHUNK_SIZE;
+				in_size -= FLK_ENCRYPTION_CHUNK_SIZE;
+				continue;
+			}
+
+			size_t take = std::min(in_size, FLK_ENCRYPTION_CHUNK_SIZE - m_plainChunk.size());
+			m_plainChunk.insert(m_plainChunk.end(), in_data, in_data + take);
+			in_data += take;
+			in_size -= take;
+
+			if (m_plainChunk.size() == FLK_ENCRYPTION_CHUNK_SIZE && in_size > 0) {
+				bool emitted = EmitChunk(m_plainChunk.data(), m_plainChunk.size(), false, in_sink);
+				m_plainChunk.clear();
+				if (!emitted) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool XChaCha20Poly1305StreamEncryptor::End(const FLKDataSink& in_sink) {
+		bool emitted = EmitChunk(m_plainChunk.data(), m_plainChunk.size(), true, in_sink);
+		m_plainChunk.clear();
+		return emitted;
+	}
+
+	uint64_t XChaCha20Poly1305StreamEncryptor::GetEncryptedSize(uint64_t in_plainSize) {
+		uint64_t chunkCount = std::max<uint64_t>(1, (in_plainSize + FLK_ENCRYPTION_CHUNK_SIZE - 1) / FLK_ENCRYPTION_CHUNK_SIZE);
+		return FLK_STREAM_HEADER_SIZE + in_plainSize + chunkCount * FLK_STREAM_CHUNK_OVERHEAD;
+	}
+
+	bool XChaCha20Poly1305StreamEncryptor::EmitChunk(const uint8_t* in_data, size_t in_size, bool in_final, const FLKDataSink& in_sink) {
+		unsigned long long cipherLen = 0;
+		int result = crypto_secretstream_xchacha20poly1305_push(
+			m_state.get(),
+			m_cipherChunk.data(), &cipherLen,
+			in_data, in_size,
+			nullptr, 0,
+			in_final ? crypto_secretstream_xchacha20poly1305_TAG_FINAL : crypto_secretstream_xchacha20poly1305_TAG_MESSAGE
+		);
+		if (result != 0) {
+			/// TODO
+			/// Handle encryption error
+			/// Output to console and close encryption process
+			std::cout << "Error: Encryption failed.\n";
+			return false;
+		}
+
+		return in_sink(m_cipherChunk.data(), static_cast<size_t>(cipherLen));
+	}
+
+	// XChaCha20Poly1305StreamDecryptor
+	// ---------------------------------------------------------------------------
+	XChaCha20Poly1305StreamDecryptor::XChaCha20Poly1305StreamDecryptor()
+		: m_state(std::make_unique<crypto_secretstream_xchacha20poly1305_state>()),
+		m_plainChunk(FLK_ENCRYPTION_CHUNK_SIZE) {
+		m_cipherChunk.reserve(FLK_ENCRYPTION_CHUNK_SIZE + FLK_STREAM_CHUNK_OVERHEAD);
+	}
+	XChaCha20Poly1305StreamDecryptor::~XChaCha20Poly1305StreamDecryptor() {
+		sodium_memzero(m_state.get(), sizeof(crypto_secretstream_xchacha20poly1305_state));
+		sodium_memzero(m_key.data(), m_key.size());
+	}
+
+	void XChaCha20Poly1305StreamDecryptor::Begin(const XChaCha20Poly1305KeySession& in_session) {
+		m_session = &in_session;
+		m_cipherChunk.clear();
+		m_headerDone = false;
+		m_finished = false;
+	}
+
+	bool XChaCha20Poly1305StreamDecryptor::Push(const uint8_t* in_data, size_t in_size, const FLKDataSink& in_sink) {
+		while (in_size > 0) {
+			if (m_finished) {
+				/// TODO
+				/// Handle error: data after the final chunk
+				/// Output to console and close decryption process
+				std::cout << "Error: Decryption failed or data is tampered.\n";
+				return false;
+			}
+
+			size_t wanted = m_headerDone ? FLK_ENCRYPTION_CHUNK_SIZE + FLK_STREAM_CHUNK_OVERHEAD : FLK_STREAM_HEADER_SIZE;
+			size_t take = std::min(in_size, wanted - m_cipherChunk.size());
+			m_cipherChunk.insert(m_cipherChunk.end(), in_data, in_data + take);
+			in_data += take;
+			in_size -= take;
+
+			if (m_cipherChunk.size() < wanted) {
+				break;
+			}
+
+			if (!m_headerDone) {
+				if (!InitPull(m_cipherChunk.data())) {
+					return false;
+				}
+
+				m_cipherChunk.clear();
+				m_headerDone = true;
+			}
+			else if (!PullChunk(in_sink)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool XChaCha20Poly1305StreamDecryptor::End(const FLKDataSink& in_sink) {
+		if (!m_cipherChunk.empty() && m_headerDone && !PullChunk(in_sink)) {
+			return false;
+		}
+		if (!m_finished) {
+			/// TODO
+			/// Handle error: truncated stream
+			/// Output to console and close decryption process
+			std::cout << "Error: Decryption failed or data is truncated.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool XChaCha20Poly1305StreamDecryptor::DecryptInto(const XChaCha20Poly1305KeySession& in_session, std::span<const uint8_t> in_blob,
+		std::span<uint8_t> out_data, size_t& out_size) {
+		Begin(in_session);
+		out_size = 0;
+
+		if (in_blob.size() < FLK_STREAM_HEADER_SIZE || !InitPull(in_blob.data())) {
+			std::cout << "Error: Decryption failed or data is truncated.\n";
+			return false;
+		}
+		in_blob = in_blob.subspan(FLK_STREAM_HEADER_SIZE);
+
+		while (!in_blob.empty() && !m_finished) {
+			size_t cipherSize = std::min(in_blob.size(), FLK_ENCRYPTION_CHUNK_SIZE + FLK_STREAM_CHUNK_OVERHEAD);
+			if (cipherSize < FLK_STREAM_CHUNK_OVERHEAD || cipherSize - FLK_STREAM_CHUNK_OVERHEAD > out_data.size() - out_size) {
+				std::cout << "Error: Decryption failed or data is tampered.\n";
+				return false;
+			}
+
+			unsigned long long plainLen = 0;
+			unsigned char tag = 0;
+			int result = crypto_secretstream_xchacha20poly1305_pull(
+				m_state.get(),
+				out_data.data() + out_size, &plainLen, &tag,
+				in_blob.data(), cipherSize,
+				nullptr, 0
+			);
+			if (result != 0) {
+				std::cout << "Error: Decryption failed or data is tampered.\n";
+				return false;
+			}
+
+			out_size += static_cast<size_t>(plainLen);
+			m_finished = (tag == crypto_secretstream_xchacha20poly1305_TAG_FINAL);
+			in_blob = in_blob.subspan(cipherSize);
+		}
+
+		if (!m_finished || !in_blob.empty()) {
+			std::cout << "Error: Decryption failed or data is truncated.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool XChaCha20Poly1305StreamDecryptor::BeginPull(const XChaCha20Poly1305KeySession& in_session, std::span<const uint8_t> in_blob) {
+		Begin(in_session);
+		m_pullBlob = {};
+
+		if (in_blob.size() < FLK_STREAM_HEADER_SIZE || !InitPull(in_blob.data())) {
+			std::cout << "Error: Decryption failed or data is truncated.\n";
+			return false;
+		}
+
+		m_pullBlob = in_blob.subspan(FLK_STREAM_HEADER_SIZE);
+		m_headerDone = true;
+		return true;
+	}
+
+	bool XChaCha20Poly1305StreamDecryptor::PullNext(std::span<const uint8_t>& out_plain) {
+		out_plain = {};
+
+		// Only the final chunk can be empty, skip to it
+		while (out_plain.empty() && !m_finished) {
+			size_t cipherSize = std::min(m_pullBlob.size(), FLK_ENCRYPTION_CHUNK_SIZE + FLK_STREAM_CHUNK_OVERHEAD);
+			if (cipherSize < FLK_STREAM_CHUNK_OVERHEAD) {
+				/// TODO
+				/// Handle error: truncated stream
+				/// Output to console and close decryption process
+				std::cout << "Error: Decryption failed or data is truncated.\n";
+				return false;
+			}
+
+			unsigned long long plainLen = 0;
+			unsigned char tag = 0;
+			int result = crypto_secretstream_xchacha20poly1305_pull(
+				m_state.get(),
+				m_plainChunk.data(), &plainLen, &tag,
+				m_pullBlob.data(), cipherSize,
+				nullptr, 0
+			);
+			if (result != 0) {
+				std::cout << "Error: Decryption failed or data is tampered.\n";
+				return false;
+			}
+
+			m_finished = (tag == crypto_secretstream_xchacha20poly1305_TAG_FINAL);
+			m_pullBlob = m_pullBlob.subspan(cipherSize);
+			out_plain = std::span<const uint8_t>(m_plainChunk.data(), static_cast<size_t>(plainLen));
+		}
+
+		if (m_finished && !m_pullBlob.empty()) {
+			/// TODO
+			/// Handle error: data after the final chunk
+			/// Output to console and close decryption process
+			std::cout << "Error: Decryption failed or data is tampered.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	// Private methods
+	// ---------------------------------------------------------------------------
+	bool XChaCha20Poly1305StreamDecryptor::InitPull(const uint8_t* in_header) {
+		// Reading a blob again (random access, several ranges of one frame) skips the derivation
+		uint64_t keyId = XChaCha20Poly1305KeySession::GetSubkeyId(in_header);
+		if (m_keySession != m_session || m_keyId != keyId) {
+			m_session->DeriveSubkey(keyId, m_key.data());
+			m_keySession = m_session;
+			m_keyId = keyId;
+		}
+
+		if (crypto_secretstream_xchacha20poly1305_init_pull(m_state.get(), in_header + FLK_STREAM_SUBKEY_ID_SIZE, m_key.data()) != 0) {
+			std::cout << "Error: Decryption failed or data is tampered.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool XChaCha20Poly1305StreamDecryptor::PullChunk(const FLKDataSink& in_sink) {
+		unsigned long long plainLen = 0;
+		unsigned char tag = 0;
+		int result = crypto_secretstream_xchacha20poly1305_pull(
+			m_state.get(),
+			m_plainChunk.data(), &plainLen, &tag,
+			m_cipherChunk.data(), m_cipherChunk.size(),
+			nullptr, 0
+		);
+		m_cipherChunk.clear();
+		if (result != 0) {
+			/// TODO
+			/// Handle decryption error (e.g., authentication failure)
+			/// Output to console and close decryption process
+			std::cout << "Error: Decryption failed or data is tampered.\n";
+			return false;
+		}
+
+		m_finished = (tag == crypto_secretstream_xchacha20poly1305_TAG_FINAL);
+		return plainLen == 0 || in_sink(m_plainChunk.data(), static_cast<size_t>(plainLen));
+	}
+
 } // namespace flakpak::encryption
\ No newline at end of file
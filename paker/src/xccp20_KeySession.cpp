@@ -0,0 +1,186 @@
+#include <flakpak/xccp20_KeySession.hpp>
+
+#include <libsodium/sodium.h>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
+
+using namespace flakpak::data_types;
+
+namespace flakpak::encryption::xccp20 {
+	// Context used for crypto_kdf entry subkeys (must be 8 bytes)
+	static constexpr char FLK_SUBKEY_CONTEXT[crypto_kdf_CONTEXTBYTES] = { 'F', 'L', 'K', 'E', 'N', 'T', 'R', 'Y' };
+
+	static_assert(FLK_KEY_SIZE == crypto_kdf_KEYBYTES, "Master key must be a crypto_kdf key");
+	static_assert(FLK_KEY_SIZE == crypto_aead_xchacha20poly1305_ietf_KEYBYTES, "Subkeys must be XChaCha20-Poly1305 keys");
+	static_assert(FLK_SALT_SIZE == crypto_pwhash_SALTBYTES, "Salt must match the Argon2id salt size");
+	static_assert(FLK_KDF_MAX_MEMLIMIT == crypto_pwhash_MEMLIMIT_SENSITIVE, "Memory bound must match the SENSITIVE limit");
+
+	XChaCha20Poly1305KeySession::~XChaCha20Poly1305KeySession() {
+		sodium_memzero(m_masterKey.data(), m_masterKey.size());
+	}
+
+	// Public methods
+	// ---------------------------------------------------------------------------
+	bool XChaCha20Poly1305KeySession::Create(const std::string& in_password, const FLKKdfParams& in_params) {
+		if (sodium_init() < 0) {
+			std::cout << "Error: Failed to initialize libsodium.\n";
+			return false;
+		}
+
+		m_salt.resize(FLK_SALT_SIZE);
+		randombytes_buf(m_salt.data(), m_salt.size());
+		m_params = in_params;
+
+		return DeriveMasterKey(in_password);
+	}
+
+	bool XChaCha20Poly1305KeySession::Open(const std::string& in_password,
+		const std::vector<uint8_t>& in_salt,
+		const FLKKdfParams& in_params) {
+		if (sodium_init() < 0) {
+			std::cout << "Error: Failed to initialize libsodium.\n";
+			return false;
+		}
+
+		if (in_salt.size() != FLK_SALT_SIZE) {
+			/// TODO
+			/// Handle error: invalid salt
+			/// Output to console
+			std::cout << "Error: Invalid salt size.\n";
+			return false;
+		}
+
+		// The limits come from the archive, bound them before allocating
+		if (in_params.algorithm != crypto_pwhash_ALG_ARGON2ID13 ||
+			in_params.opsLimit < crypto_pwhash_OPSLIMIT_MIN || in_params.opsLimit > FLK_KDF_MAX_OPSLIMIT ||
+			in_params.memLimit < crypto_pwhash_MEMLIMIT_MIN || in_params.memLimit > FLK_KDF_MAX_MEMLIMIT) {
+			/// TODO
+			/// Handle error: KDF limits out of bounds
+			/// Output to console
+			std::cout << "Error: Invalid key derivation limits (" << in_params.opsLimit << " passes, "
+				<< (in_params.memLimit >> 20) << " MiB).\n";
+			return false;
+		}
+
+		m_salt = in_salt;
+		m_params = in_params;
+
+		return DeriveMasterKey(in_password);
+	}
+
+	void XChaCha20Poly1305KeySession::DeriveSubkey(uint64_t in_subkeyId, unsigned char* out_key) const {
+		crypto_kdf_derive_from_key(out_key, FLK_KEY_SIZE, in_subkeyId, FLK_SUBKEY_CONTEXT, m_masterKey.data());
+	}
+
+	bool XChaCha20Poly1305KeySession::IsValid() const {
+		return m_valid;
+	}
+	const std::vector<uint8_t>& XChaCha20Poly1305KeySession::GetSalt() const {
+		return m_salt;
+	}
+	const FLKKdfParams& XChaCha20Poly1305KeySession::GetParams() const {
+		return m_params;
+	}
+
+	uint64_t XChaCha20Poly1305KeySession::GetSubkeyId(const uint8_t* in_nonce) {
+		uint64_t subkeyId = 0;
+		for (size_t i = 0; i < sizeof(uint64_t); i++) {
+			subkeyId |= static_cast<uint64_t>(in_nonce[i]) << (i * 8);
+		}
+		return subkeyId;
+	}
+
+	FLKKdfParams XChaCha20Poly1305KeySession::GetDefaultParams() {
+		FLKKdfParams params;
+		params.opsLimit = crypto_pwhash_OPSLIMIT_MODERATE;
+		params.memLimit = crypto_pwhash_MEMLIMIT_MODERATE;
+		params.algorithm = crypto_pwhash_ALG_ARGON2ID13;
+		return params;
+	}
+
+	FLKKdfParams XChaCha20Poly1305KeySession::Calibrate(uint32_t in_targetMs, uint32_t& out_expectedMs) {
+		FLKKdfParams params;
+		params.algorithm = crypto_pwhash_ALG_ARGON2ID13;
+		params.opsLimit = crypto_pwhash_OPSLIMIT_MIN;
+		params.memLimit = crypto_pwhash_MEMLIMIT_MODERATE;
+		out_expectedMs = 0;
+
+		if (sodium_init() < 0) {
+			return GetDefaultParams();
+		}
+
+		const char probePassword[] = "flakpak-calibration";
+		unsigned char probeSalt[crypto_pwhash_SALTBYTES] = {};
+		unsigned char probeKey[FLK_KEY_SIZE];
+
+		auto timePass = [&](double& out_passMs) {
+			auto start = std::chrono::steady_clock::now();
+			if (crypto_pwhash(probeKey, sizeof(probeKey), probePassword, sizeof(probePassword) - 1, probeSalt,
+				params.opsLimit, static_cast<size_t>(params.memLimit), params.algorithm) != 0) {
+				return false;
+			}
+			out_passMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			return true;
+		};
+
+		// Time a single pass, halve the memory while one pass alone is too slow
+		double passMs = 0.0;
+		while (true) {
+			if (!timePass(passMs)) {
+				return GetDefaultParams();
+			}
+
+			if (passMs <= in_targetMs || params.memLimit / 2 < crypto_pwhash_MEMLIMIT_INTERACTIVE) {
+				break;
+			}
+			params.memLimit /= 2;
+		}
+
+		// Memory hardness is worth more than passes, so grow the memory toward
+		// the SENSITIVE limit first while a single pass still fits the target
+		while (passMs * 2.0 <= in_targetMs && params.memLimit * 2 <= FLK_KDF_MAX_MEMLIMIT) {
+			params.memLimit *= 2;
+			if (!timePass(passMs)) {
+				params.memLimit /= 2;
+				break;
+			}
+		}
+
+		// Argon2id time grows linearly with the number of passes
+		uint64_t passes = passMs > 0.0 ? static_cast<uint64_t>(in_targetMs / passMs + 0.5) : crypto_pwhash_OPSLIMIT_MODERATE;
+		params.opsLimit = std::clamp<uint64_t>(passes, crypto_pwhash_OPSLIMIT_MIN, FLK_KDF_MAX_OPSLIMIT);
+		out_expectedMs = static_cast<uint32_t>(passMs * static_cast<double>(params.opsLimit));
+
+		sodium_memzero(probeKey, sizeof(probeKey));
+		return params;
+	}
+
+	// Private methods
+	// ---------------------------------------------------------------------------
+	bool XChaCha20Poly1305KeySession::DeriveMasterKey(const std::string& in_password) {
+		m_valid = false;
+
+		int result = crypto_pwhash(
+			m_masterKey.data(),
+			m_masterKey.size(),
+			in_password.c_str(), in_password.size(),
+			m_salt.data(),
+			m_params.opsLimit,
+			static_cast<size_t>(m_params.memLimit),
+			static_cast<int>(m_params.algorithm)
+		);
+		if (result != 0) {
+			/// TODO
+			/// Handle error: key derivation failed (out of memory or invalid limits)
+			/// Output to console
+			std::cout << "Error: Key derivation failed.\n";
+			return false;
+		}
+
+		m_valid = true;
+		return true;
+	}
+
+} // namespace flakpak::encryption::xccp20
\ No newline at end of file
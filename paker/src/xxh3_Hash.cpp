@@ -0,0 +1,457 @@
+#include <flakpak/xxh3_Hash.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define FLK_XXH3_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define FLK_XXH3_AVX2 1
+#define FLK_XXH3_AVX2_TARGET
+#include <immintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+// Built for every x86 target, only used when the CPU reports AVX2
+#define FLK_XXH3_AVX2 1
+#define FLK_XXH3_AVX2_DISPATCH 1
+#define FLK_XXH3_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+
+namespace flakpak::checksum::xxh3 {
+	static constexpr uint32_t XXH_PRIME32_1 = 0x9E3779B1U;
+	static constexpr uint32_t XXH_PRIME32_2 = 0x85EBCA77U;
+	static constexpr uint32_t XXH_PRIME32_3 = 0xC2B2AE3DU;
+	static constexpr uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+	static constexpr uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+	static constexpr uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+	static constexpr uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+	static constexpr uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+	static constexpr uint64_t XXH_PRIME_MX1 = 0x165667919E3779F9ULL;
+	static constexpr uint64_t XXH_PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+	static constexpr size_t XXH_STRIPE_SIZE = 64;				// Input bytes per accumulation
+	static constexpr size_t XXH_SECRET_SIZE = 192;
+	static constexpr size_t XXH_SECRET_CONSUME_RATE = 8;		// Secret bytes skipped per stripe
+	static constexpr size_t XXH_SECRET_LIMIT = XXH_SECRET_SIZE - XXH_STRIPE_SIZE;
+	static constexpr size_t XXH_STRIPES_PER_BLOCK = XXH_SECRET_LIMIT / XXH_SECRET_CONSUME_RATE;
+	static constexpr size_t XXH_SECRET_LASTACC_START = 7;
+	static constexpr size_t XXH_SECRET_MERGEACCS_START = 11;
+	static constexpr size_t XXH_SECRET_SIZE_MIN = 136;
+	static constexpr size_t XXH_MIDSIZE_MAX = 240;
+	static constexpr size_t XXH_MIDSIZE_STARTOFFSET = 3;
+	static constexpr size_t XXH_MIDSIZE_LASTOFFSET = 17;
+	static constexpr size_t XXH_BUFFER_STRIPES = 256 / XXH_STRIPE_SIZE;
+
+	alignas(64) static constexpr uint8_t XXH_SECRET[XXH_SECRET_SIZE] = {
+		0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+		0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+		0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+		0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+		0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+		0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+		0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+		0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+		0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+		0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+		0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+		0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+	};
+
+	static constexpr std::array<uint64_t, 8> XXH_INIT_ACC = {
+		XXH_PRIME32_3, XXH_PRIME64_1, XXH_PRIME64_2, XXH_PRIME64_3,
+		XXH_PRIME64_4, XXH_PRIME32_2, XXH_PRIME64_5, XXH_PRIME32_1
+	};
+
+	static uint32_t Swap32(uint32_t in_value) {
+		return (in_value >> 24) | ((in_value >> 8) & 0xFF00) | ((in_value << 8) & 0xFF0000) | (in_value << 24);
+	}
+
+	static uint64_t Swap64(uint64_t in_value) {
+		return (static_cast<uint64_t>(Swap32(static_cast<uint32_t>(in_value))) << 32) | Swap32(static_cast<uint32_t>(in_value >> 32));
+	}
+
+	static uint32_t ReadLE32(const uint8_t* in_data) {
+		uint32_t value;
+		std::memcpy(&value, in_data, sizeof(value));
+		if constexpr (std::endian::native == std::endian::big) {
+			value = Swap32(value);
+		}
+		return value;
+	}
+
+	static uint64_t ReadLE64(const uint8_t* in_data) {
+		uint64_t value;
+		std::memcpy(&value, in_data, sizeof(value));
+		if constexpr (std::endian::native == std::endian::big) {
+			value = Swap64(value);
+		}
+		return value;
+	}
+
+	// 64x64 -> 128 multiplication, both halves folded with a xor
+	static uint64_t Mul128Fold64(uint64_t in_lhs, uint64_t in_rhs) {
+#if defined(__SIZEOF_INT128__)
+		__uint128_t product = static_cast<__uint128_t>(in_lhs) * in_rhs;
+		return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		uint64_t high = 0;
+		uint64_t low = _umul128(in_lhs, in_rhs, &high);
+		return low ^ high;
+#else
+		uint64_t loLo = (in_lhs & 0xFFFFFFFF) * (in_rhs & 0xFFFFFFFF);
+		uint64_t hiLo = (in_lhs >> 32) * (in_rhs & 0xFFFFFFFF);
+		uint64_t loHi = (in_lhs & 0xFFFFFFFF) * (in_rhs >> 32);
+		uint64_t hiHi = (in_lhs >> 32) * (in_rhs >> 32);
+		uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+		uint64_t high = (hiLo >> 32) + (cross >> 32) + hiHi;
+		uint64_t low = (cross << 32) | (loLo & 0xFFFFFFFF);
+		return low ^ high;
+#endif
+	}
+
+	static uint64_t Xxh64Avalanche(uint64_t in_hash) {
+		in_hash ^= in_hash >> 33;
+		in_hash *= XXH_PRIME64_2;
+		in_hash ^= in_hash >> 29;
+		in_hash *= XXH_PRIME64_3;
+		return in_hash ^ (in_hash >> 32);
+	}
+
+	static uint64_t Avalanche(uint64_t in_hash) {
+		in_hash ^= in_hash >> 37;
+		in_hash *= XXH_PRIME_MX1;
+		return in_hash ^ (in_hash >> 32);
+	}
+
+	static uint64_t Rrmxmx(uint64_t in_hash, uint64_t in_size) {
+		in_hash ^= std::rotl(in_hash, 49) ^ std::rotl(in_hash, 24);
+		in_hash *= XXH_PRIME_MX2;
+		in_hash ^= (in_hash >> 35) + in_size;
+		in_hash *= XXH_PRIME_MX2;
+		return in_hash ^ (in_hash >> 28);
+	}
+
+	static uint64_t Mix16(const uint8_t* in_data, const uint8_t* in_secret) {
+		return Mul128Fold64(ReadLE64(in_data) ^ ReadLE64(in_secret), ReadLE64(in_data + 8) ^ ReadLE64(in_secret + 8));
+	}
+
+	// Short inputs
+	// ---------------------------------------------------------------------------
+	static uint64_t Hash0To16(const uint8_t* in_data, size_t in_size) {
+		const uint8_t* secret = XXH_SECRET;
+
+		if (in_size > 8) {
+			uint64_t low = ReadLE64(in_data) ^ (ReadLE64(secret + 24) ^ ReadLE64(secret + 32));
+			uint64_t high = ReadLE64(in_data + in_size - 8) ^ (ReadLE64(secret + 40) ^ ReadLE64(secret + 48));
+			return Avalanche(in_size + Swap64(low) + high + Mul128Fold64(low, high));
+		}
+		if (in_size >= 4) {
+			uint64_t input = ReadLE32(in_data + in_size - 4) + (static_cast<uint64_t>(ReadLE32(in_data)) << 32);
+			return Rrmxmx(input ^ (ReadLE64(secret + 8) ^ ReadLE64(secret + 16)), in_size);
+		}
+		if (in_size > 0) {
+			uint32_t combined = (static_cast<uint32_t>(in_data[0]) << 16) | (static_cast<uint32_t>(in_data[in_size >> 1]) << 24) |
+				static_cast<uint32_t>(in_data[in_size - 1]) | (static_cast<uint32_t>(in_size) << 8);
+			return Xxh64Avalanche(combined ^ static_cast<uint64_t>(ReadLE32(secret) ^ ReadLE32(secret + 4)));
+		}
+		return Xxh64Avalanche(ReadLE64(secret + 56) ^ ReadLE64(secret + 64));
+	}
+
+	static uint64_t Hash17To128(const uint8_t* in_data, size_t in_size) {
+		const uint8_t* secret = XXH_SECRET;
+		uint64_t acc = in_size * XXH_PRIME64_1;
+
+		if (in_size > 32) {
+			if (in_size > 64) {
+				if (in_size > 96) {
+					acc += Mix16(in_data + 48, secret + 96);
+					acc += Mix16(in_data + in_size - 64, secret + 112);
+				}
+				acc += Mix16(in_data + 32, secret + 64);
+				acc += Mix16(in_data + in_size - 48, secret + 80);
+			}
+			acc += Mix16(in_data + 16, secret + 32);
+			acc += Mix16(in_data + in_size - 32, secret + 48);
+		}
+		acc += Mix16(in_data, secret);
+		acc += Mix16(in_data + in_size - 16, secret + 16);
+
+		return Avalanche(acc);
+	}
+
+	static uint64_t Hash129To240(const uint8_t* in_data, size_t in_size) {
+		const uint8_t* secret = XXH_SECRET;
+		uint64_t acc = in_size * XXH_PRIME64_1;
+		size_t rounds = in_size / 16;
+
+		for (size_t i = 0; i < 8; i++) {
+			acc += Mix16(in_data + 16 * i, secret + 16 * i);
+		}
+		acc = Avalanche(acc);
+
+		uint64_t accEnd = Mix16(in_data + in_size - 16, secret + XXH_SECRET_SIZE_MIN - XXH_MIDSIZE_LASTOFFSET);
+		for (size_t i = 8; i < rounds; i++) {
+			accEnd += Mix16(in_data + 16 * i, secret + 16 * (i - 8) + XXH_MIDSIZE_STARTOFFSET);
+		}
+
+		return Avalanche(acc + accEnd);
+	}
+
+	// Stripe loop, the secret moves by 8 bytes from one stripe to the next
+	// ---------------------------------------------------------------------------
+	using AccumulateFunction = void (*)(uint64_t* io_acc, const uint8_t* in_data, const uint8_t* in_secret, size_t in_stripes);
+	using ScrambleFunction = void (*)(uint64_t* io_acc, const uint8_t* in_secret);
+
+	[[maybe_unused]] static void AccumulateScalar(uint64_t* io_acc, const uint8_t* in_data, const uint8_t* in_secret, size_t in_stripes) {
+		for (size_t n = 0; n < in_stripes; n++) {
+			const uint8_t* data = in_data + n * XXH_STRIPE_SIZE;
+			const uint8_t* secret = in_secret + n * XXH_SECRET_CONSUME_RATE;
+
+			for (size_t lane = 0; lane < 8; lane++) {
+				uint64_t value = ReadLE64(data + lane * 8);
+				uint64_t key = value ^ ReadLE64(secret + lane * 8);
+				io_acc[lane ^ 1] += value;
+				io_acc[lane] += (key & 0xFFFFFFFF) * (key >> 32);
+			}
+		}
+	}
+
+	[[maybe_unused]] static void ScrambleScalar(uint64_t* io_acc, const uint8_t* in_secret) {
+		for (size_t lane = 0; lane < 8; lane++) {
+			uint64_t acc = io_acc[lane];
+			acc ^= acc >> 47;
+			acc ^= ReadLE64(in_secret + lane * 8);
+			io_acc[lane] = acc * XXH_PRIME32_1;
+		}
+	}
+
+#ifdef FLK_XXH3_SSE2
+	static void AccumulateSse2(uint64_t* io_acc, const uint8_t* in_data, const uint8_t* in_secret, size_t in_stripes) {
+		__m128i* acc = reinterpret_cast<__m128i*>(io_acc);
+
+		for (size_t n = 0; n < in_stripes; n++) {
+			const __m128i* data = reinterpret_cast<const __m128i*>(in_data + n * XXH_STRIPE_SIZE);
+			const __m128i* secret = reinterpret_cast<const __m128i*>(in_secret + n * XXH_SECRET_CONSUME_RATE);
+
+			for (size_t i = 0; i < XXH_STRIPE_SIZE / sizeof(__m128i); i++) {
+				__m128i value = _mm_loadu_si128(data + i);
+				__m128i key = _mm_xor_si128(value, _mm_loadu_si128(secret + i));
+				__m128i product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+				__m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+				acc[i] = _mm_add_epi64(product, _mm_add_epi64(acc[i], swapped));
+			}
+		}
+	}
+
+	static void ScrambleSse2(uint64_t* io_acc, const uint8_t* in_secret) {
+		__m128i* acc = reinterpret_cast<__m128i*>(io_acc);
+		const __m128i* secret = reinterpret_cast<const __m128i*>(in_secret);
+		const __m128i prime = _mm_set1_epi32(static_cast<int>(XXH_PRIME32_1));
+
+		for (size_t i = 0; i < XXH_STRIPE_SIZE / sizeof(__m128i); i++) {
+			__m128i value = _mm_xor_si128(_mm_xor_si128(acc[i], _mm_srli_epi64(acc[i], 47)), _mm_loadu_si128(secret + i));
+			__m128i low = _mm_mul_epu32(value, prime);
+			__m128i high = _mm_mul_epu32(_mm_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+			acc[i] = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+		}
+	}
+#endif
+
+#ifdef FLK_XXH3_AVX2
+	FLK_XXH3_AVX2_TARGET static void AccumulateAvx2(uint64_t* io_acc, const uint8_t* in_data, const uint8_t* in_secret, size_t in_stripes) {
+		__m256i* acc = reinterpret_cast<__m256i*>(io_acc);
+
+		for (size_t n = 0; n < in_stripes; n++) {
+			const __m256i* data = reinterpret_cast<const __m256i*>(in_data + n * XXH_STRIPE_SIZE);
+			const __m256i* secret = reinterpret_cast<const __m256i*>(in_secret + n * XXH_SECRET_CONSUME_RATE);
+
+			for (size_t i = 0; i < XXH_STRIPE_SIZE / sizeof(__m256i); i++) {
+				__m256i value = _mm256_loadu_si256(data + i);
+				__m256i key = _mm256_xor_si256(value, _mm256_loadu_si256(secret + i));
+				__m256i product = _mm256_mul_epu32(key, _mm256_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+				__m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+				acc[i] = _mm256_add_epi64(product, _mm256_add_epi64(acc[i], swapped));
+			}
+		}
+	}
+
+	FLK_XXH3_AVX2_TARGET static void ScrambleAvx2(uint64_t* io_acc, const uint8_t* in_secret) {
+		__m256i* acc = reinterpret_cast<__m256i*>(io_acc);
+		const __m256i* secret = reinterpret_cast<const __m256i*>(in_secret);
+		const __m256i prime = _mm256_set1_epi32(static_cast<int>(XXH_PRIME32_1));
+
+		for (size_t i = 0; i < XXH_STRIPE_SIZE / sizeof(__m256i); i++) {
+			__m256i value = _mm256_xor_si256(_mm256_xor_si256(acc[i], _mm256_srli_epi64(acc[i], 47)), _mm256_loadu_si256(secret + i));
+			__m256i low = _mm256_mul_epu32(value, prime);
+			__m256i high = _mm256_mul_epu32(_mm256_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+			acc[i] = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+		}
+	}
+#endif
+
+	struct StripeKernel {
+		AccumulateFunction accumulate;
+		ScrambleFunction scramble;
+		const char* name;
+	};
+
+	static StripeKernel SelectKernel() {
+#if defined(FLK_XXH3_AVX2_DISPATCH)
+		if (__builtin_cpu_supports("avx2")) {
+			return { AccumulateAvx2, ScrambleAvx2, "avx2" };
+		}
+#elif defined(FLK_XXH3_AVX2)
+		return { AccumulateAvx2, ScrambleAvx2, "avx2" };
+#endif
+#ifdef FLK_XXH3_SSE2
+		return { AccumulateSse2, ScrambleSse2, "sse2" };
+#else
+		return { AccumulateScalar, ScrambleScalar, "scalar" };
+#endif
+	}
+
+	static const StripeKernel& GetKernel() {
+		static const StripeKernel kernel = SelectKernel();
+		return kernel;
+	}
+
+	// Accumulates whole stripes, scrambling at every block boundary
+	//    @return const uint8_t* - End of the consumed input
+	static const uint8_t* ConsumeStripes(const StripeKernel& in_kernel, uint64_t* io_acc, size_t& io_stripesSoFar,
+		const uint8_t* in_data, size_t in_stripes) {
+		while (in_stripes > 0) {
+			size_t stripes = std::min(in_stripes, XXH_STRIPES_PER_BLOCK - io_stripesSoFar);
+			in_kernel.accumulate(io_acc, in_data, XXH_SECRET + io_stripesSoFar * XXH_SECRET_CONSUME_RATE, stripes);
+			in_data += stripes * XXH_STRIPE_SIZE;
+			in_stripes -= stripes;
+			io_stripesSoFar += stripes;
+
+			if (io_stripesSoFar == XXH_STRIPES_PER_BLOCK) {
+				in_kernel.scramble(io_acc, XXH_SECRET + XXH_SECRET_LIMIT);
+				io_stripesSoFar = 0;
+			}
+		}
+
+		return in_data;
+	}
+
+	static uint64_t MergeAccs(const uint64_t* in_acc, uint64_t in_start) {
+		const uint8_t* secret = XXH_SECRET + XXH_SECRET_MERGEACCS_START;
+		uint64_t result = in_start;
+		for (size_t i = 0; i < 4; i++) {
+			result += Mul128Fold64(in_acc[2 * i] ^ ReadLE64(secret + 16 * i), in_acc[2 * i + 1] ^ ReadLE64(secret + 16 * i + 8));
+		}
+		return Avalanche(result);
+	}
+
+	static uint64_t HashLong(const uint8_t* in_data, size_t in_size) {
+		const StripeKernel& kernel = GetKernel();
+		alignas(64) std::array<uint64_t, 8> acc = XXH_INIT_ACC;
+
+		// Every stripe but the last, the last one always ends the input
+		size_t stripesSoFar = 0;
+		ConsumeStripes(kernel, acc.data(), stripesSoFar, in_data, (in_size - 1) / XXH_STRIPE_SIZE);
+		kernel.accumulate(acc.data(), in_data + in_size - XXH_STRIPE_SIZE, XXH_SECRET + XXH_SECRET_LIMIT - XXH_SECRET_LASTACC_START, 1);
+
+		return MergeAccs(acc.data(), in_size * XXH_PRIME64_1);
+	}
+
+	Xxh3Hasher::Xxh3Hasher() {
+		Reset();
+	}
+
+	void Xxh3Hasher::Reset() {
+		m_acc = XXH_INIT_ACC;
+		m_bufferedSize = 0;
+		m_stripesSoFar = 0;
+		m_totalSize = 0;
+	}
+
+	void Xxh3Hasher::Update(const uint8_t* in_data, size_t in_size) {
+		m_totalSize += in_size;
+
+		if (in_size <= m_buffer.size() - m_bufferedSize) {
+			if (in_size > 0) {
+				std::memcpy(m_buffer.data() + m_bufferedSize, in_data, in_size);
+			}
+			m_bufferedSize += in_size;
+			return;
+		}
+
+		// The buffer is only consumed once more input follows, the digest
+		// needs the last stripe of the input
+		const StripeKernel& kernel = GetKernel();
+		const uint8_t* end = in_data + in_size;
+		if (m_bufferedSize > 0) {
+			size_t fill = m_buffer.size() - m_bufferedSize;
+			std::memcpy(m_buffer.data() + m_bufferedSize, in_data, fill);
+			in_data += fill;
+			ConsumeStripes(kernel, m_acc.data(), m_stripesSoFar, m_buffer.data(), XXH_BUFFER_STRIPES);
+			m_bufferedSize = 0;
+		}
+
+		if (static_cast<size_t>(end - in_data) > m_buffer.size()) {
+			size_t stripes = static_cast<size_t>(end - 1 - in_data) / XXH_STRIPE_SIZE;
+			in_data = ConsumeStripes(kernel, m_acc.data(), m_stripesSoFar, in_data, stripes);
+			// Keeps the last consumed stripe, the digest may need it
+			std::memcpy(m_buffer.data() + m_buffer.size() - XXH_STRIPE_SIZE, in_data - XXH_STRIPE_SIZE, XXH_STRIPE_SIZE);
+		}
+
+		m_bufferedSize = static_cast<size_t>(end - in_data);
+		std::memcpy(m_buffer.data(), in_data, m_bufferedSize);
+	}
+
+	uint64_t Xxh3Hasher::Digest() const {
+		if (m_totalSize <= XXH_MIDSIZE_MAX) {
+			return Hash(m_buffer.data(), static_cast<size_t>(m_totalSize));
+		}
+
+		const StripeKernel& kernel = GetKernel();
+		alignas(64) std::array<uint64_t, 8> acc = m_acc;
+		alignas(64) std::array<uint8_t, XXH_STRIPE_SIZE> lastStripe {};
+		const uint8_t* lastStripeData = nullptr;
+
+		if (m_bufferedSize >= XXH_STRIPE_SIZE) {
+			size_t stripesSoFar = m_stripesSoFar;
+			ConsumeStripes(kernel, acc.data(), stripesSoFar, m_buffer.data(), (m_bufferedSize - 1) / XXH_STRIPE_SIZE);
+			lastStripeData = m_buffer.data() + m_bufferedSize - XXH_STRIPE_SIZE;
+		}
+		else {
+			// The last stripe starts in the previously consumed bytes
+			size_t catchup = XXH_STRIPE_SIZE - m_bufferedSize;
+			std::memcpy(lastStripe.data(), m_buffer.data() + m_buffer.size() - catchup, catchup);
+			std::memcpy(lastStripe.data() + catchup, m_buffer.data(), m_bufferedSize);
+			lastStripeData = lastStripe.data();
+		}
+		kernel.accumulate(acc.data(), lastStripeData, XXH_SECRET + XXH_SECRET_LIMIT - XXH_SECRET_LASTACC_START, 1);
+
+		return MergeAccs(acc.data(), m_totalSize * XXH_PRIME64_1);
+	}
+
+	uint64_t Xxh3Hasher::Hash(const uint8_t* in_data, size_t in_size) {
+		if (in_size <= 16) {
+			return Hash0To16(in_data, in_size);
+		}
+		if (in_size <= 128) {
+			return Hash17To128(in_data, in_size);
+		}
+		if (in_size <= XXH_MIDSIZE_MAX) {
+			return Hash129To240(in_data, in_size);
+		}
+		return HashLong(in_data, in_size);
+	}
+
+	const char* Xxh3Hasher::GetImplementation() {
+		return GetKernel().name;
+	}
+
+} // namespace flakpak::checksum::xxh3
@@ -1,20 +1,119 @@
 #include <flakpak/zstd_Compressor.hpp>
+#include <flakpak/flak_MappedFile.hpp>
 
 #include <iostream>
-#include <fstream>
 #include <iomanip>
+#include <array>
 
 #include <zstd/zstd.h>
+#include <zstd/zdict.h>
 
 
 using namespace flakpak::data_types;
 
 namespace flakpak::compression::zstd {
+	struct ZstdParameterValue {
+		ZSTD_cParameter parameter;
+		int value;
+		const char* name;
+	};
+
+	// Strategy parameters of FLK_ZSTD_PARAMS, 0 values are left to zstd
+	static std::array<ZstdParameterValue, 7> GetStrategyParams(const FLK_ZSTD_PARAMS& in_params) {
+		return { {
+			{ ZSTD_c_windowLog, in_params.windowLog, "windowLog" },
+			{ ZSTD_c_chainLog, in_params.chainLog, "chainLog" },
+			{ ZSTD_c_hashLog, in_params.hashLog, "hashLog" },
+			{ ZSTD_c_searchLog, in_params.searchLog, "searchLog" },
+			{ ZSTD_c_minMatch, in_params.minMatch, "minMatch" },
+			{ ZSTD_c_targetLength, in_params.targetLength, "targetLength" },
+			{ ZSTD_c_strategy, in_params.strategy, "strategy" },
+		} };
+	}
+
+	static bool ApplyParams(ZSTD_CCtx* in_cctx, const FLK_ZSTD_PARAMS& in_params) {
+		for (const auto& param : GetStrategyParams(in_params)) {
+			if (param.value != 0 && ZSTD_isError(ZSTD_CCtx_setParameter(in_cctx, param.parameter, param.value))) {
+				return false;
+			}
+		}
+		if (in_params.longDistanceMatching && ZSTD_isError(ZSTD_CCtx_setParameter(in_cctx, ZSTD_c_enableLongDistanceMatching, 1))) {
+			return false;
+		}
+
+		// Fails when zstd was built without ZSTD_MULTITHREAD, the input is
+		// then compressed on the calling thread which gives a valid frame too
+		if (in_params.workerCount > 0 && !ZSTD_isError(ZSTD_CCtx_setParameter(in_cctx, ZSTD_c_nbWorkers, in_params.workerCount))) {
+			if (in_params.jobSize > 0 && ZSTD_isError(ZSTD_CCtx_setParameter(in_cctx, ZSTD_c_jobSize, in_params.jobSize))) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// ZstdDictionary
+	// ---------------------------------------------------------------------------
+	ZstdDictionary::~ZstdDictionary() {
+		ZSTD_freeCDict(m_cdict);
+		ZSTD_freeDDict(m_ddict);
+	}
+
+	bool ZstdDictionary::Train(const std::vector<uint8_t>& in_samples, const std::vector<size_t>& in_sampleSizes, size_t in_capacity) {
+		std::vector<uint8_t> dictionary(in_capacity);
+
+		size_t dictionarySize = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(),
+			in_samples.data(), in_sampleSizes.data(), static_cast<unsigned>(in_sampleSizes.size()));
+		if (ZDICT_isError(dictionarySize)) {
+			/// TODO
+			/// If debug flag enabled output to console the reason
+			/// (usually not enough samples)
+			return false;
+		}
+
+		dictionary.resize(dictionarySize);
+		Load(std::move(dictionary));
+		return true;
+	}
+
+	void ZstdDictionary::Load(std::vector<uint8_t> in_data) {
+		ZSTD_freeCDict(m_cdict);
+		ZSTD_freeDDict(m_ddict);
+		m_cdict = nullptr;
+		m_ddict = nullptr;
+
+		m_data = std::move(in_data);
+	}
+
+	bool ZstdDictionary::PrepareCompression(int in_compressionLevel) {
+		ZSTD_freeCDict(m_cdict);
+		m_cdict = ZSTD_createCDict(m_data.data(), m_data.size(), in_compressionLevel);
+		return m_cdict != nullptr;
+	}
+
+	bool ZstdDictionary::PrepareDecompression() {
+		ZSTD_freeDDict(m_ddict);
+		m_ddict = ZSTD_createDDict(m_data.data(), m_data.size());
+		return m_ddict != nullptr;
+	}
+
+	const std::vector<uint8_t>& ZstdDictionary::GetData() const {
+		return m_data;
+	}
+	const ZSTD_CDict_s* ZstdDictionary::GetCDict() const {
+		return m_cdict;
+	}
+	const ZSTD_DDict_s* ZstdDictionary::GetDDict() const {
+		return m_ddict;
+	}
+
+	// ZstdCompressor
+	// ---------------------------------------------------------------------------
 	FLK_COMPRESSION_RESULT ZstdCompressor::CompressData(const std::filesystem::path& in_path,
 		int in_compressionLevel) {
-		// Open the file to compress
-		std::ifstream file(in_path, std::ios::binary | std::ios::ate);
-		if (!file.is_open()) {
+		// Map the file so zstd reads it in place
+		io::MappedFile file;
+		if (!file.Open(in_path)) {
 			/// TODO
 			/// Failed to open file error 
 			/// Output to console
@@ -22,101 +121,52 @@ namespace flakpak::compression::zstd {
 			return {};
 		}
 
-		// Get original file size
-		size_t originalSize = file.tellg();
-		file.seekg(0, std::ios::beg);
-
-		const size_t chunkSize = ZSTD_CStreamInSize();
-		const size_t outChunkSize = ZSTD_CStreamOutSize();
-
-
-		// Initialize ZSTD compression context
-		ZSTD_CCtx* cctx = ZSTD_createCCtx();
-		size_t ret = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, in_compressionLevel);
-		if (ZSTD_isError(ret)) {
-			ZSTD_freeCCtx(cctx);
+		auto compressionResult = CompressData(file.GetData(), static_cast<size_t>(file.GetSize()), in_compressionLevel);
+		if (compressionResult.data.empty()) {
 			/// TODO
-			/// Handle error setting compression level
+			/// Handle compression error
 			/// Output to console
-			std::cout << "Error: Failed to set compression level.\n";
-			return {};
+			std::cout << "Error: Compression failed for file: " << in_path.filename().string() << "\n";
 		}
 
-		// Buffers for input and output
-		std::vector<uint8_t> compressed;
-		std::vector<char> inBuffer(chunkSize);
-		std::vector<char> outBuffer(outChunkSize);
+		return compressionResult;
+	}
 
-		ZSTD_inBuffer input = { nullptr, 0, 0 };
-		ZSTD_outBuffer output = { outBuffer.data(), outChunkSize, 0 };
-
-		size_t totalBytesRead = 0;
-		std::string filename = in_path.filename().string();
-
-		// Read and compress the file in chunks
-		while (file) {
-			file.read(inBuffer.data(), chunkSize);
-			size_t bytesRead = file.gcount();
-			if (bytesRead == 0) break;  // End of file
-
-			totalBytesRead += bytesRead;
-			input.src = inBuffer.data();
-			input.size = bytesRead;
-			input.pos = 0;
-			while (input.pos < input.size) {
-				output.pos = 0;
-				size_t ret = ZSTD_compressStream(cctx, &output, &input);
-				if (ZSTD_isError(ret)) {
-					ZSTD_freeCCtx(cctx);
-					/// TODO
-					/// Handle compression error
-					/// Output to console
-					std::cout << "Error: Compression failed for file: " << filename << "\n";
-					return {};
-				}
-				compressed.insert(compressed.end(), outBuffer.data(), outBuffer.data() + output.pos);
-				// Update progress display here if needed
-			}
-		}
+	FLK_COMPRESSION_RESULT ZstdCompressor::CompressData(const uint8_t* in_data, size_t in_size,
+		int in_compressionLevel) {
+		// One context per thread, reset for every call instead of recreated
+		thread_local ZstdStreamCompressor context;
 
-		// End the stream
-		output.pos = 0;
-		size_t ret2;
-		do {
-			ret2 = ZSTD_endStream(cctx, &output);
-			if (ZSTD_isError(ret2)) {
-				ZSTD_freeCCtx(cctx);
-				/// TODO
-				/// Handle end stream error
-				/// Output to console
-				std::cout << "Error: Failed to finalize compression for file: " << filename << "\n";
-				return {};
-			}
-			compressed.insert(compressed.end(), outBuffer.data(), outBuffer.data() + output.pos);
-			output.pos = 0;
-		} while (ret2 != 0);
+		std::vector<uint8_t> compressed;
+		auto storeOutput = [&compressed](const uint8_t* in_output, size_t in_outputSize) {
+			compressed.assign(in_output, in_output + in_outputSize);
+			return true;
+		};
 
-		ZSTD_freeCCtx(cctx);
-		file.close();
+		if (!context.Compress(in_data, in_size, in_compressionLevel, storeOutput)) {
+			/// TODO
+			/// Handle compression error
+			/// Output to console
+			std::cout << "Error: Compression failed.\n";
+			return {};
+		}
 
 		// Return the compressed data and sizes
 		FLK_COMPRESSION_RESULT compressionResult;
 		compressionResult.data = std::move(compressed);
-		compressionResult.originalSize = originalSize;
+		compressionResult.originalSize = in_size;
 		compressionResult.compressedSize = compressionResult.data.size();
 
 		return compressionResult;
 	}
 
 	std::vector<uint8_t> ZstdCompressor::DecompressData(const std::vector<uint8_t>& in_data,
-		size_t in_originalSize) {
+		size_t in_originalSize, const ZstdDictionary* in_dictionary) {
 		// Buffer to hold decompressed data
 		std::vector<uint8_t> decompressedData(in_originalSize);
 
-		size_t const dSize = ZSTD_decompress(decompressedData.data(), in_originalSize,
-			in_data.data(), in_data.size());
-
-		if (ZSTD_isError(dSize)) {
+		size_t dSize = 0;
+		if (!DecompressData(in_data, decompressedData, dSize, in_dictionary)) {
 			/// TODO
 			/// Handle decompression error
 			/// Output to console
@@ -128,4 +178,242 @@ namespace flakpak::compression::zstd {
 		return decompressedData;
 	}
 
+	bool ZstdCompressor::DecompressData(std::span<const uint8_t> in_data, std::span<uint8_t> out_data,
+		size_t& out_size, const ZstdDictionary* in_dictionary) {
+		// One context per thread, like the compression side
+		thread_local ZstdStreamDecompressor context;
+
+		return context.DecompressInto(in_data, out_data, out_size, in_dictionary);
+	}
+
+	// ZstdStreamCompressor
+	// ---------------------------------------------------------------------------
+	ZstdStreamCompressor::ZstdStreamCompressor()
+		: m_cctx(ZSTD_createCCtx()), m_outBuffer(ZSTD_CStreamOutSize()) {
+	}
+	ZstdStreamCompressor::~ZstdStreamCompressor() {
+		ZSTD_freeCCtx(m_cctx);
+	}
+
+	bool ZstdStreamCompressor::Begin(int in_compressionLevel, uint64_t in_pledgedSize, const ZstdDictionary* in_dictionary) {
+		if (!m_cctx) {
+			return false;
+		}
+
+		ZSTD_CCtx_reset(m_cctx, ZSTD_reset_session_and_parameters);
+		if (ZSTD_isError(ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_compressionLevel, in_compressionLevel))) {
+			return false;
+		}
+		// Lets zstd size its window for the input and records the size in the frame header
+		if (ZSTD_isError(ZSTD_CCtx_setPledgedSrcSize(m_cctx, in_pledgedSize))) {
+			return false;
+		}
+		if (m_hasLargeInputParams && in_pledgedSize >= m_largeInputParams.largeInputThreshold
+			&& !ApplyParams(m_cctx, m_largeInputParams)) {
+			return false;
+		}
+		// The CDict was prepared at the archive compression level
+		if (in_dictionary && ZSTD_isError(ZSTD_CCtx_refCDict(m_cctx, in_dictionary->GetCDict()))) {
+			return false;
+		}
+
+		return true;
+	}
+
+	bool ZstdStreamCompressor::Push(const uint8_t* in_data, size_t in_size, const FLKDataSink& in_sink) {
+		ZSTD_inBuffer input = { in_data, in_size, 0 };
+
+		while (input.pos < input.size) {
+			ZSTD_outBuffer output = { m_outBuffer.data(), m_outBuffer.size(), 0 };
+			size_t ret = ZSTD_compressStream2(m_cctx, &output, &input, ZSTD_e_continue);
+			if (ZSTD_isError(ret)) {
+				return false;
+			}
+			if (output.pos > 0 && !in_sink(m_outBuffer.data(), output.pos)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool ZstdStreamCompressor::End(const FLKDataSink& in_sink) {
+		ZSTD_inBuffer input = { nullptr, 0, 0 };
+
+		size_t remaining = 0;
+		do {
+			ZSTD_outBuffer output = { m_outBuffer.data(), m_outBuffer.size(), 0 };
+			remaining = ZSTD_compressStream2(m_cctx, &output, &input, ZSTD_e_end);
+			if (ZSTD_isError(remaining)) {
+				return false;
+			}
+			if (output.pos > 0 && !in_sink(m_outBuffer.data(), output.pos)) {
+				return false;
+			}
+		} while (remaining != 0);
+
+		return true;
+	}
+
+	bool ZstdStreamCompressor::Compress(const uint8_t* in_data, size_t in_size, int in_compressionLevel, const FLKDataSink& in_sink,
+		const ZstdDictionary* in_dictionary) {
+		if (!Begin(in_compressionLevel, in_size, in_dictionary)) {
+			return false;
+		}
+
+		size_t bound = ZSTD_compressBound(in_size);
+		if (m_frameBuffer.size() < bound) {
+			m_frameBuffer.resize(bound);
+		}
+
+		size_t written = ZSTD_compress2(m_cctx, m_frameBuffer.data(), bound, in_data, in_size);
+		if (ZSTD_isError(written)) {
+			return false;
+		}
+
+		return in_sink(m_frameBuffer.data(), written);
+	}
+
+	void ZstdStreamCompressor::SetLargeInputParams(const FLK_ZSTD_PARAMS& in_params) {
+		m_largeInputParams = in_params;
+		m_hasLargeInputParams = true;
+	}
+
+	bool ZstdStreamCompressor::ValidateParams(const FLK_ZSTD_PARAMS& in_params) {
+		for (const auto& param : GetStrategyParams(in_params)) {
+			if (param.value == 0) {
+				continue;
+			}
+
+			ZSTD_bounds bounds = ZSTD_cParam_getBounds(param.parameter);
+			if (ZSTD_isError(bounds.error) || param.value < bounds.lowerBound || param.value > bounds.upperBound) {
+				/// TODO
+				/// Handle error: zstd parameter out of range
+				/// Output to console
+				std::cout << "Error: zstd " << param.name << " must be between "
+					<< bounds.lowerBound << " and " << bounds.upperBound << ".\n";
+				return false;
+			}
+		}
+
+		if (in_params.workerCount < 0 || in_params.jobSize < 0) {
+			std::cout << "Error: Invalid zstd worker count or job size.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	// ZstdStreamDecompressor
+	// ---------------------------------------------------------------------------
+	ZstdStreamDecompressor::ZstdStreamDecompressor()
+		: m_dctx(ZSTD_createDCtx()), m_outBuffer(ZSTD_DStreamOutSize()) {
+		// Frames compressed with a large windowLog are refused by default,
+		// the limit survives the session resets done by Begin()
+		if (m_dctx) {
+			ZSTD_DCtx_setParameter(m_dctx, ZSTD_d_windowLogMax, ZSTD_dParam_getBounds(ZSTD_d_windowLogMax).upperBound);
+		}
+	}
+	ZstdStreamDecompressor::~ZstdStreamDecompressor() {
+		ZSTD_freeDCtx(m_dctx);
+	}
+
+	bool ZstdStreamDecompressor::Begin(const ZstdDictionary* in_dictionary) {
+		if (!m_dctx) {
+			return false;
+		}
+
+		ZSTD_DCtx_reset(m_dctx, ZSTD_reset_session_only);
+		// Referencing nullptr goes back to no-dictionary mode
+		if (ZSTD_isError(ZSTD_DCtx_refDDict(m_dctx, in_dictionary ? in_dictionary->GetDDict() : nullptr))) {
+			return false;
+		}
+		m_frameDone = false;
+		return true;
+	}
+
+	bool ZstdStreamDecompressor::Push(const uint8_t* in_data, size_t in_size, const FLKDataSink& in_sink) {
+		ZSTD_inBuffer input = { in_data, in_size, 0 };
+
+		// Keep going while there is input or zstd may still hold decoded data
+		while (input.pos < input.size || !m_frameDone) {
+			ZSTD_outBuffer output = { m_outBuffer.data(), m_outBuffer.size(), 0 };
+			size_t ret = ZSTD_decompressStream(m_dctx, &output, &input);
+			if (ZSTD_isError(ret)) {
+				/// TODO
+				/// Handle decompression error
+				/// Output to console
+				return false;
+			}
+			if (output.pos > 0 && !in_sink(m_outBuffer.data(), output.pos)) {
+				return false;
+			}
+
+			m_frameDone = (ret == 0);
+			if (m_frameDone && input.pos < input.size) {
+				// Trailing data after the frame
+				return false;
+			}
+			// Output buffer not full: zstd needs more input to make progress
+			if (output.pos < output.size && input.pos == input.size) {
+				break;
+			}
+		}
+
+		return true;
+	}
+
+	bool ZstdStreamDecompressor::End() {
+		return m_frameDone;
+	}
+
+	bool ZstdStreamDecompressor::Pull(std::span<const uint8_t>& io_input, std::span<uint8_t> out_data, size_t& out_size) {
+		ZSTD_inBuffer input = { io_input.data(), io_input.size(), 0 };
+		ZSTD_outBuffer output = { out_data.data(), out_data.size(), 0 };
+
+		while (!m_frameDone && output.pos < output.size) {
+			size_t inputBefore = input.pos;
+			size_t outputBefore = output.pos;
+			size_t ret = ZSTD_decompressStream(m_dctx, &output, &input);
+			if (ZSTD_isError(ret)) {
+				/// TODO
+				/// Handle decompression error
+				/// Output to console
+				return false;
+			}
+
+			m_frameDone = (ret == 0);
+			// No progress: zstd needs more input
+			if (input.pos == inputBefore && output.pos == outputBefore) {
+				break;
+			}
+		}
+
+		io_input = io_input.subspan(input.pos);
+		out_size = output.pos;
+		// Trailing data after the frame
+		return !m_frameDone || io_input.empty();
+	}
+
+	bool ZstdStreamDecompressor::DecompressInto(std::span<const uint8_t> in_data, std::span<uint8_t> out_data,
+		size_t& out_size, const ZstdDictionary* in_dictionary) {
+		out_size = 0;
+		if (!Begin(in_dictionary)) {
+			return false;
+		}
+
+		// The referenced dictionary and the window limit apply to one-shot decoding too
+		size_t ret = ZSTD_decompressDCtx(m_dctx, out_data.data(), out_data.size(), in_data.data(), in_data.size());
+		if (ZSTD_isError(ret)) {
+			/// TODO
+			/// Handle decompression error
+			/// Output to console
+			return false;
+		}
+
+		out_size = ret;
+		m_frameDone = true;
+		return true;
+	}
+
 } // namespace flakpak::compression::zstd
\ No newline at end of file
@@ -48,3 +48,5 @@ filter "configurations:Release"
 filter {}
 
 include "paker_pfile.lua"
+
+include "bench_pfile.lua"